@@ -0,0 +1,70 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/**
+ * Count, sum and maximum of recorded values, for metrics recorded on one
+ * thread and read on another. Each is a relaxed atomic, so a reader may see a
+ * count and its sum from slightly different moments.
+ */
+class AtomicStats
+{
+  public:
+    struct Snapshot
+    {
+        uint64_t count = 0;
+        uint64_t total = 0;
+        uint64_t max = 0;
+    };
+
+    void record(uint64_t value)
+    {
+        count.fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t seen = max.load(std::memory_order_relaxed);
+        while (value > seen &&
+               !max.compare_exchange_weak(seen, value,
+                                          std::memory_order_relaxed))
+        {}
+    }
+
+    Snapshot snapshot() const
+    {
+        return {count.load(std::memory_order_relaxed),
+                total.load(std::memory_order_relaxed),
+                max.load(std::memory_order_relaxed)};
+    }
+
+  private:
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> max{0};
+};
+
+} // namespace smbios
+
+} // namespace phosphor
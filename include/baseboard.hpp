@@ -19,6 +19,8 @@
 
 #include <phosphor-logging/lg2.hpp>
 
+#include <optional>
+
 namespace phosphor
 {
 
@@ -87,45 +89,19 @@ class Baseboard
         }
 
         raw = reinterpret_cast<struct BaseboardInfo*>(dataIn);
-        for (int i = 0; i < raw->numOfContainedObject; i++)
-        {
-            auto objectHanle = raw->containedObjectHandles[i];
-            uint8_t* objectData = smbiosHandlePtr(storage, objectHanle);
-            if (objectData == nullptr)
-            {
-                lg2::error("Failed to find handle. Handle={HANDLE}", "HANDLE",
-                           objectHanle);
-                continue;
-            }
-            containedObjects.push_back(
-                {objectHanle,
-                 reinterpret_cast<struct StructureHeader*>(objectData)});
-        }
     }
 
-    /** @brief find the index number of the same structure type inside this
-     *  board.
-     *  @param handle the handle of searched structure.
-     *  @return a pair of bool and int. bool is true if the handle is found,
-     *  false if the handle is not found, the int is the index number of the
-     *  same structure type inside this board.
+    /** @brief Handle of the board structure, the contained objects are
+     *  looked up through HandleGraph::container() with it.
      */
-    std::pair<bool, int> findIndexOfType(const uint16_t& handle)
+    std::optional<uint16_t> getHandle()
     {
-        std::map<int, int> typeCount;
-        for (const auto& [objHandle, objHeader] : containedObjects)
+        if (raw == nullptr)
         {
-            if (objHeader == nullptr)
-            {
-                continue;
-            }
-            if (handle == objHandle)
-            {
-                return {true, typeCount[objHeader->type]};
-            }
-            typeCount[objHeader->type]++;
+            return std::nullopt;
         }
-        return {false, 0};
+        uint16_t handle = raw->handle;
+        return handle;
     }
 
     void setName(const std::string& newName)
@@ -154,9 +130,7 @@ class Baseboard
 
     std::string name;
 
-    struct BaseboardInfo* raw;
-
-    std::vector<std::pair<uint16_t, struct StructureHeader*>> containedObjects;
+    struct BaseboardInfo* raw = nullptr;
 };
 
 } // namespace smbios
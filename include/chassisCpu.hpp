@@ -37,6 +37,8 @@ namespace phosphor
 namespace smbios
 {
 
+struct CpuRecord;
+
 using asset =
     sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset;
 using assetTagType =
@@ -63,77 +65,26 @@ class chassisCpu :
     chassisCpu& operator=(chassisCpu&&) = delete;
     ~chassisCpu() = default;
     chassisCpu(sdbusplus::bus_t& bus, const std::string& objPath,
-               const uint8_t& cpuId, uint8_t* smbiosTableStorage,
-               const std::string& motherboard, const std::string& assocPath) :
+               const CpuRecord& record, const std::string& motherboard,
+               const std::string& assocPath) :
         sdbusplus::server::object_t<asset, assetTagType, location, chassis,
                                     Item, association, operationalStatus>(
-            bus, objPath.c_str()),
-        cpuNum(cpuId), storage(smbiosTableStorage),
+            bus, objPath.c_str(), action::defer_emit),
         motherboardPath(motherboard), objPath(assocPath)
     {
-        infoUpdate(smbiosTableStorage, motherboard);
+        infoUpdate(record, motherboard);
 
         // the default value is unknown, set to Component when CPU exists
-        chassis::type(chassis::ChassisType::Component);
+        chassis::type(chassis::ChassisType::Component, true);
+        emit_object_added();
     }
 
-    void infoUpdate(uint8_t* smbiosTableStorage,
-                    const std::string& motherboard);
+    void infoUpdate(const CpuRecord& record, const std::string& motherboard);
 
   private:
-    uint8_t cpuNum;
-
-    uint8_t* storage;
-
     std::string motherboardPath;
 
     std::string objPath;
-
-    struct ProcessorInfo
-    {
-        uint8_t type;
-        uint8_t length;
-        uint16_t handle;
-        uint8_t socketDesignation;
-        uint8_t processorType;
-        uint8_t family;
-        uint8_t manufacturer;
-        uint64_t id;
-        uint8_t version;
-        uint8_t voltage;
-        uint16_t exClock;
-        uint16_t maxSpeed;
-        uint16_t currSpeed;
-        uint8_t status;
-        uint8_t upgrade;
-        uint16_t l1Handle;
-        uint16_t l2Handle;
-        uint16_t l3Handle;
-        uint8_t serialNum;
-        uint8_t assetTag;
-        uint8_t partNum;
-        uint8_t coreCount;
-        uint8_t coreEnable;
-        uint8_t threadCount;
-        uint16_t characteristics;
-        uint16_t family2;
-        uint16_t coreCount2;
-        uint16_t coreEnable2;
-        uint16_t threadCount2;
-    } __attribute__((packed));
-
-    void locationString(const uint8_t positionNum, const uint8_t structLen,
-                        uint8_t* dataIn);
-    void manufacturer(const uint8_t positionNum, const uint8_t structLen,
-                      uint8_t* dataIn);
-    void serialNumber(const uint8_t positionNum, const uint8_t structLen,
-                      uint8_t* dataIn);
-    void assetTagString(const uint8_t positionNum, const uint8_t structLen,
-                        uint8_t* dataIn);
-    void partNumber(const uint8_t positionNum, const uint8_t structLen,
-                    uint8_t* dataIn);
-    void model(const uint8_t positionNum, const uint8_t structLen,
-               uint8_t* dataIn);
 };
 
 } // namespace smbios
@@ -35,7 +35,10 @@
 #include <xyz/openbmc_project/Inventory/Item/server.hpp>
 #include <xyz/openbmc_project/State/Decorator/OperationalStatus/server.hpp>
 
+#include <optional>
 #include <regex>
+#include <string>
+#include <vector>
 
 namespace phosphor
 {
@@ -323,10 +326,50 @@ static const std::array<std::optional<processor::Capability>, 16>
                          std::nullopt,
                          std::nullopt};
 
-class Cpu :
+/** @brief Decoded SMBIOS type-4 record, as published by Cpu */
+struct CpuRecord
+{
+    uint16_t handle = 0;
+    std::string socket;
+    /** Socket and chip numbers parsed from the socket designation */
+    bool socketFound = false;
+    size_t socketNum = 0;
+    size_t chip = 0;
+    size_t instance = 0;
+    bool present = false;
+    bool functional = false;
+    // The fields below are only decoded for a populated socket
+    std::string family;
+    std::optional<uint16_t> effectiveFamily;
+    std::optional<uint16_t> effectiveModel;
+    std::optional<uint16_t> step;
+    std::string manufacturer;
+    uint64_t id = 0;
+    std::string version;
+    uint32_t maxSpeedInMhz = 0;
+    std::string serialNumber;
+    std::string assetTag;
+    std::string partNumber;
+    uint16_t coreCount = 0;
+    uint16_t threadCount = 0;
+    std::vector<processor::Capability> characteristics;
+
+    bool operator==(const CpuRecord&) const = default;
+};
+
+#if defined(CPU_DBUS_CHASSISIFACE) && !defined(PLATFORM_PREFIX)
+using CpuObject =
     sdbusplus::server::object_t<processor, asset, assetTagType, location,
                                 connector, rev, Item, association, instance,
-                                operationalStatus>
+                                operationalStatus, chassis>;
+#else
+using CpuObject =
+    sdbusplus::server::object_t<processor, asset, assetTagType, location,
+                                connector, rev, Item, association, instance,
+                                operationalStatus>;
+#endif
+
+class Cpu : CpuObject
 {
   public:
     Cpu() = delete;
@@ -336,38 +379,31 @@ class Cpu :
     Cpu& operator=(Cpu&&) = delete;
     ~Cpu() = default;
 
-    Cpu(sdbusplus::bus_t& bus, const std::string& path, const uint8_t& cpuId,
-        uint8_t* smbiosTableStorage, const std::string& motherboard,
+    Cpu(sdbusplus::bus_t& bus, const std::string& path,
+        const CpuRecord& record, const std::string& motherboard,
         std::string& assocPath) :
-        sdbusplus::server::object_t<processor, asset, assetTagType, location,
-                                    connector, rev, Item, association, instance,
-                                    operationalStatus>(bus, path.c_str()),
-        cpuNum(cpuId), storage(smbiosTableStorage),
+        CpuObject(bus, path.c_str(), action::defer_emit),
         motherboardPath(motherboard), objPath(assocPath)
     {
 #ifndef PLATFORM_PREFIX
 #ifdef CPU_DBUS_CHASSISIFACE
-        chassisIface = std::make_unique<chassis>(bus, path.c_str());
         // the default value is unknown, set to Component when CPU exists
-        chassisIface->type(chassis::ChassisType::Component);
-        chassisIface->emit_added();
+        chassis::type(chassis::ChassisType::Component, true);
 #endif
 #else
-        static std::vector<std::unique_ptr<chassisCpu>> chassisCpus;
-
-        if (!chassisCpus.empty() && (cpuId == 0))
-        {
-            chassisCpus.clear();
-        }
-
-        chassisCpus.emplace_back(std::make_unique<phosphor::smbios::chassisCpu>(
-            bus, assocPath, cpuId, smbiosTableStorage, motherboard, path));
+        chassisCpuObject = std::make_unique<phosphor::smbios::chassisCpu>(
+            bus, assocPath, record, motherboard, path);
 #endif
-        infoUpdate(smbiosTableStorage, motherboard);
+        infoUpdate(record, motherboard);
+        emit_object_added();
     }
 
-    void infoUpdate(uint8_t* smbiosTableStorage,
-                    const std::string& motherboard);
+    /** @brief Decode the cpuNum-th type-4 structure of a table.
+     *  Only reads the table, so it can run off the D-Bus thread.
+     */
+    static CpuRecord decode(uint8_t* smbiosTableStorage, uint8_t cpuNum);
+
+    void infoUpdate(const CpuRecord& record, const std::string& motherboard);
 
     static inline auto
         socketChipNumber([[maybe_unused]] const std::string socketDesignation)
@@ -396,34 +432,13 @@ class Cpu :
         return std::make_tuple(found, socket, chip);
     }
 
-    static inline auto socketChipNumber(uint8_t* dataIn)
-    {
-        bool found = false;
-        size_t socket = 0;
-        size_t chip = 0;
-
-        if (dataIn == nullptr)
-        {
-            return std::make_tuple(found, socket, chip);
-        }
-
-        auto cpuInfo = reinterpret_cast<struct Cpu::ProcessorInfo*>(dataIn);
-        std::string socketDesignation = positionToString(
-            cpuInfo->socketDesignation, cpuInfo->length, dataIn);
-        return socketChipNumber(socketDesignation);
-    }
-
   private:
-    uint8_t cpuNum;
-
-    uint8_t* storage;
-
     std::string motherboardPath;
 
     std::string objPath;
 
-#ifndef PLATFORM_PREFIX
-    std::unique_ptr<chassis> chassisIface = nullptr;
+#ifdef PLATFORM_PREFIX
+    std::unique_ptr<chassisCpu> chassisCpuObject;
 #endif
 
     struct ProcessorInfo
@@ -458,21 +473,6 @@ class Cpu :
         uint16_t coreEnable2;
         uint16_t threadCount2;
     } __attribute__((packed));
-
-    void socket(const uint8_t positionNum, const uint8_t structLen,
-                uint8_t* dataIn);
-    void family(const uint8_t family, const uint16_t family2);
-    void manufacturer(const uint8_t positionNum, const uint8_t structLen,
-                      uint8_t* dataIn);
-    void serialNumber(const uint8_t positionNum, const uint8_t structLen,
-                      uint8_t* dataIn);
-    void assetTagString(const uint8_t positionNum, const uint8_t structLen,
-                        uint8_t* dataIn);
-    void partNumber(const uint8_t positionNum, const uint8_t structLen,
-                    uint8_t* dataIn);
-    void version(const uint8_t positionNum, const uint8_t structLen,
-                 uint8_t* dataIn);
-    void characteristics(const uint16_t value);
 };
 
 } // namespace smbios
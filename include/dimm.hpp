@@ -26,12 +26,17 @@
 #include <xyz/openbmc_project/Inventory/Item/server.hpp>
 #include <xyz/openbmc_project/State/Decorator/OperationalStatus/server.hpp>
 
+#include <optional>
+#include <string>
+
 namespace phosphor
 {
 
 namespace smbios
 {
 
+class HandleGraph;
+
 using DeviceType =
     sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::DeviceType;
 
@@ -41,25 +46,46 @@ using EccType =
 using MemoryTechType =
     sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::MemoryTech;
 
-class Dimm :
-    sdbusplus::server::object_t<
-        sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm>,
-    sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                    inventory::item::dimm::MemoryLocation>,
-    sdbusplus::server::object_t<
-        sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset>,
+/** @brief Decoded SMBIOS type-17 record, as published by Dimm */
+struct DimmRecord
+{
+    uint16_t handle = 0;
+    uint16_t dataWidth = 0;
+    uint16_t totalWidth = 0;
+    size_t sizeInKB = 0;
+    bool present = false;
+    std::string deviceLocator;
+    std::optional<uint8_t> socket;
+    std::optional<uint8_t> slot;
+    DeviceType type = DeviceType::Unknown;
+    std::string typeDetail;
+    uint16_t maxSpeedInMhz = 0;
+    std::string manufacturer;
+    std::string serialNumber;
+    std::string partNumber;
+    size_t attributes = 0;
+    MemoryTechType media = MemoryTechType::Unknown;
+    uint16_t configuredSpeedInMhz = 0;
+    std::optional<EccType> ecc;
+
+    bool operator==(const DimmRecord&) const = default;
+};
+
+using DimmObject = sdbusplus::server::object_t<
+    sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm,
+    sdbusplus::server::xyz::openbmc_project::inventory::item::dimm::
+        MemoryLocation,
+    sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset,
 #ifdef DIMM_LOCATION_CODE
-    sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                    inventory::decorator::LocationCode>,
+    sdbusplus::server::xyz::openbmc_project::inventory::decorator::LocationCode,
 #endif
-    sdbusplus::server::object_t<
-        sdbusplus::server::xyz::openbmc_project::inventory::connector::Slot>,
-    sdbusplus::server::object_t<
-        sdbusplus::server::xyz::openbmc_project::inventory::Item>,
-    sdbusplus::server::object_t<
-        sdbusplus::server::xyz::openbmc_project::association::Definitions>,
-    sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::state::
-                                    decorator::OperationalStatus>
+    sdbusplus::server::xyz::openbmc_project::inventory::connector::Slot,
+    sdbusplus::server::xyz::openbmc_project::inventory::Item,
+    sdbusplus::server::xyz::openbmc_project::association::Definitions,
+    sdbusplus::server::xyz::openbmc_project::state::decorator::
+        OperationalStatus>;
+
+class Dimm : DimmObject
 {
   public:
     Dimm() = delete;
@@ -70,41 +96,20 @@ class Dimm :
     Dimm& operator=(Dimm&&) = default;
 
     Dimm(sdbusplus::bus_t& bus, const std::string& objPath,
-         const uint8_t& dimmId, uint8_t* smbiosTableStorage,
-         const std::string& motherboard) :
-
-        sdbusplus::server::object_t<
-            sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm>(
-            bus, objPath.c_str()),
-        sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                        inventory::item::dimm::MemoryLocation>(
-            bus, objPath.c_str()),
-        sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                        inventory::decorator::Asset>(
-            bus, objPath.c_str()),
-#ifdef DIMM_LOCATION_CODE
-        sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                        inventory::decorator::LocationCode>(
-            bus, objPath.c_str()),
-#endif
-        sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                        inventory::connector::Slot>(
-            bus, objPath.c_str()),
-        sdbusplus::server::object_t<
-            sdbusplus::server::xyz::openbmc_project::inventory::Item>(
-            bus, objPath.c_str()),
-        sdbusplus::server::object_t<
-            sdbusplus::server::xyz::openbmc_project::association::Definitions>(
-            bus, objPath.c_str()),
-        sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                        state::decorator::OperationalStatus>(
-            bus, objPath.c_str()),
-        dimmNum(dimmId)
+         const DimmRecord& record, const std::string& motherboard) :
+        DimmObject(bus, objPath.c_str(), action::defer_emit)
     {
-        memoryInfoUpdate(smbiosTableStorage, motherboard);
+        memoryInfoUpdate(record, motherboard);
+        emit_object_added();
     }
 
-    void memoryInfoUpdate(uint8_t* smbiosTableStorage,
+    /** @brief Decode the dimmNum-th type-17 structure of a table.
+     *  Only reads the table, so it can run off the D-Bus thread.
+     */
+    static DimmRecord decode(uint8_t* smbiosTableStorage,
+                             const HandleGraph& graph, uint8_t dimmNum);
+
+    void memoryInfoUpdate(const DimmRecord& record,
                           const std::string& motherboard);
 
     uint16_t memoryDataWidth(uint16_t value) override;
@@ -130,27 +135,7 @@ class Dimm :
     EccType ecc(EccType value) override;
 
   private:
-    uint8_t dimmNum;
-
-    uint8_t* storage;
-
     std::string motherboardPath;
-
-    void dimmSize(const uint16_t size);
-    void dimmSizeExt(const uint32_t size);
-    void dimmDeviceLocator(const uint8_t bankLocatorPositionNum,
-                           const uint8_t deviceLocatorPositionNum,
-                           const uint8_t structLen, uint8_t* dataIn);
-    void dimmType(const uint8_t type);
-    void dimmTypeDetail(const uint16_t detail);
-    void dimmManufacturer(const uint8_t positionNum, const uint8_t structLen,
-                          uint8_t* dataIn);
-    void dimmMedia(const uint8_t type);
-    void dimmSerialNum(const uint8_t positionNum, const uint8_t structLen,
-                       uint8_t* dataIn);
-    void dimmPartNum(const uint8_t positionNum, const uint8_t structLen,
-                     uint8_t* dataIn);
-    void updateEccType(uint16_t exPhyArrayHandle);
 };
 
 struct MemoryInfo
@@ -29,19 +29,40 @@ namespace phosphor
 namespace smbios
 {
 
-using associationIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::association::Definitions>;
-using assetIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset>;
-using itemIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::inventory::Item>;
+class HandleGraph;
+
+using associationIntf =
+    sdbusplus::server::xyz::openbmc_project::association::Definitions;
+using assetIntf =
+    sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset;
+using itemIntf = sdbusplus::server::xyz::openbmc_project::inventory::Item;
+
+/** @brief Decoded SMBIOS type-45 firmware inventory entry */
+struct FirmwareRecord
+{
+    /** Component name and the id used to build the object name */
+    std::string name;
+    std::string id;
+    std::string version;
+    std::string softwareId;
+    std::string releaseDate;
+    std::string manufacturer;
+
+    bool operator==(const FirmwareRecord&) const = default;
+};
+
 #ifdef EXPOSE_FW_INVENTORY
-using softwareversionIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::software::Version>;
-class Firmware : associationIntf, assetIntf, itemIntf, softwareversionIntf
+using softwareversionIntf =
+    sdbusplus::server::xyz::openbmc_project::software::Version;
+using FirmwareObject =
+    sdbusplus::server::object_t<associationIntf, assetIntf, itemIntf,
+                                softwareversionIntf>;
 #else
-class Firmware : associationIntf, assetIntf, itemIntf
+using FirmwareObject =
+    sdbusplus::server::object_t<associationIntf, assetIntf, itemIntf>;
 #endif
+
+class Firmware : FirmwareObject
 {
   public:
     Firmware() = delete;
@@ -52,31 +73,30 @@ class Firmware : associationIntf, assetIntf, itemIntf
     Firmware& operator=(Firmware&&) = default;
 
     Firmware(std::shared_ptr<sdbusplus::asio::connection> bus,
-             const std::string& objPath, int index,
-             uint8_t* smbiosTableStorage) :
-        associationIntf(*bus, objPath.c_str()),
-        assetIntf(*bus, objPath.c_str()), itemIntf(*bus, objPath.c_str()),
-#ifdef EXPOSE_FW_INVENTORY
-        softwareversionIntf(*bus, objPath.c_str()), path(objPath),
-#endif
-        storage(smbiosTableStorage), index(index)
+             const std::string& objPath, const FirmwareRecord& record) :
+        FirmwareObject(*bus, objPath.c_str(), action::defer_emit),
+        path(objPath)
     {
-        firmwareInfoUpdate();
+        firmwareInfoUpdate(record);
+        emit_object_added();
     }
 
     static std::tuple<std::string, std::string>
-        getFirmwareName(uint8_t* dataIn, int targetIndex = 0);
+        getFirmwareName(uint8_t* dataIn, const HandleGraph& graph,
+                        int targetIndex = 0);
+
+    /** @brief Decode the index-th firmware inventory entry of a table.
+     *  Only reads the table, so it can run off the D-Bus thread.
+     */
+    static FirmwareRecord decode(uint8_t* smbiosTableStorage,
+                                 const HandleGraph& graph, int index);
 
-    void firmwareInfoUpdate(void);
+    void firmwareInfoUpdate(const FirmwareRecord& record);
 
   private:
     /** @brief Path of the group instance */
     std::string path;
 
-    uint8_t* storage;
-
-    int index;
-
     struct FirmwareInfo
     {
         uint8_t type;
@@ -96,19 +116,6 @@ class Firmware : associationIntf, assetIntf, itemIntf
         uint8_t numOfAssociatedComponents;
         uint16_t associatedComponentHandles[1];
     } __attribute__((packed));
-
-    void firmwareComponentName(const uint8_t positionNum,
-                               const uint8_t structLen, uint8_t* dataIn);
-#ifdef EXPOSE_FW_INVENTORY
-    void firmwareVersion(const uint8_t positionNum, const uint8_t structLen,
-                         uint8_t* dataIn);
-    void firmwareId(const uint8_t positionNum, const uint8_t structLen,
-                    uint8_t* dataIn);
-#endif
-    void firmwareReleaseDate(const uint8_t positionNum, const uint8_t structLen,
-                             uint8_t* dataIn);
-    void firmwareManufacturer(const uint8_t positionNum,
-                              const uint8_t structLen, uint8_t* dataIn);
 };
 
 } // namespace smbios
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <sdbusplus/bus.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <map>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/**
+ * Caches the ObjectMapper lookups made on every inventory rebuild.
+ *
+ * Each result remembers the interfaces it was looked up by. An
+ * InterfacesAdded or InterfacesRemoved signal naming one of them drops the
+ * result, and a well-known name changing owner drops every result, so the
+ * next lookup asks the mapper again. The processor modules are also dropped
+ * when an InstanceNumber changes. Failed lookups are not cached.
+ */
+class MapperCache
+{
+  public:
+    /** Path of a ProcessorModule and its InstanceNumber, if it has one */
+    using Modules = std::vector<std::pair<std::string, std::optional<size_t>>>;
+
+    MapperCache(const MapperCache&) = delete;
+    MapperCache& operator=(const MapperCache&) = delete;
+
+    explicit MapperCache(sdbusplus::bus_t& bus);
+
+    /** @brief Find the inventory object the SMBIOS content is attached to.
+     *  @param ancestorPath Subtree to search for System objects.
+     *  @param exactPath If not empty, only this object is accepted as the
+     *                   anchor, as a System or a Board.
+     *  @return Empty if there is none.
+     */
+    std::string motherboard(const std::string& ancestorPath,
+                            const std::string& exactPath);
+
+    /** @brief ProcessorModule inventory objects and their instance numbers */
+    Modules processorModules();
+
+    /** @brief Paths of the software Version objects under a subtree */
+    std::vector<std::string> versionPaths(const std::string& root);
+
+    /** @brief Find the service implementing an interface on an object.
+     *  @return Empty if there is none.
+     */
+    std::string service(const std::string& path, const std::string& interface);
+
+  private:
+    template <typename Value>
+    struct Entry
+    {
+        /** Arguments the value was looked up with */
+        std::string key;
+        std::optional<Value> value;
+    };
+
+    void interfacesChanged(const std::string& path,
+                           const std::vector<std::string>& interfaces);
+    void clear();
+
+    sdbusplus::bus_t& bus;
+
+    Entry<std::string> motherboardEntry;
+    Entry<Modules> modulesEntry;
+    Entry<std::vector<std::string>> versionPathsEntry;
+    std::map<std::pair<std::string, std::string>, std::string> services;
+
+    sdbusplus::bus::match_t interfacesAddedMatch;
+    sdbusplus::bus::match_t interfacesRemovedMatch;
+    sdbusplus::bus::match_t nameOwnerChangedMatch;
+    sdbusplus::bus::match_t instanceChangedMatch;
+};
+
+} // namespace smbios
+
+} // namespace phosphor
@@ -19,9 +19,16 @@
 #include "cpu.hpp"
 #include "dimm.hpp"
 #include "firmware.hpp"
+#include "mapper_cache.hpp"
+#include "metrics.hpp"
 #include "pcieslot.hpp"
+#include "smbios_history.hpp"
+#include "smbios_index.hpp"
 #include "smbios_mdrv2.hpp"
+#include "smbios_persist.hpp"
 #include "system.hpp"
+#include "table_decoder.hpp"
+#include "table_watch.hpp"
 #include "tpm.hpp"
 
 #include <sys/stat.h>
@@ -41,6 +48,9 @@
 
 #include <filesystem>
 #include <memory>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
 
 namespace phosphor
 {
@@ -54,6 +64,8 @@ static constexpr const char* defaultObjectPath =
     "/xyz/openbmc_project/Smbios/MDR_V2";
 static constexpr const char* smbiosInterfaceName =
     "xyz.openbmc_project.Smbios.GetRecordType";
+static constexpr const char* metricsInterfaceName =
+    "xyz.openbmc_project.Smbios.Metrics";
 static constexpr const char* mapperBusName = "xyz.openbmc_project.ObjectMapper";
 static constexpr const char* mapperPath = "/xyz/openbmc_project/object_mapper";
 static constexpr const char* mapperInterface =
@@ -70,6 +82,39 @@ static constexpr const char* boardInterface =
     "xyz.openbmc_project.Inventory.Item.Board";
 constexpr const int limitEntryLen = 0xff;
 
+// Sequence, timestamp and content hash of a stored table generation
+using TableGeneration = std::tuple<uint32_t, uint32_t, uint64_t>;
+// Change ("Added", "Removed" or "Modified"), handle and type of a structure
+using TableChange = std::tuple<std::string, uint16_t, uint8_t>;
+// Name, count, total and longest time in microseconds of a timed phase
+using PhaseTime = std::tuple<std::string, uint64_t, uint64_t, uint64_t>;
+// Name and value of an event counter
+using CounterValue = std::tuple<std::string, uint64_t>;
+
+/** @brief A published inventory object and what it was built from */
+template <typename Object, typename Record>
+struct InventoryObject
+{
+    std::string path;
+    std::string parent;
+    Record record;
+    std::unique_ptr<Object> object;
+};
+
+inline std::string structureChangeName(StructureChange change)
+{
+    switch (change)
+    {
+        case StructureChange::added:
+            return "Added";
+        case StructureChange::removed:
+            return "Removed";
+        case StructureChange::modified:
+            return "Modified";
+    }
+    return "";
+}
+
 // Avoid putting multiple interfaces with same name on same object
 static std::string placeGetRecordType(const std::string& objectPath)
 {
@@ -106,6 +151,10 @@ class MDRV2 :
                 objServer->remove_interface(smbiosInterface);
             }
         }
+        if (metricsInterface && objServer)
+        {
+            objServer->remove_interface(metricsInterface);
+        }
     }
 
     MDRV2(std::shared_ptr<boost::asio::io_context> io,
@@ -116,12 +165,17 @@ class MDRV2 :
         sdbusplus::server::object_t<
             sdbusplus::server::xyz::openbmc_project::smbios::MDRV2>(
             *conn, objectPath.c_str()),
-        timer(*io), bus(conn), objServer(std::move(obj)),
+        timer(*io), bus(conn), objServer(std::move(obj)), mapperCache(*conn),
         smbiosInterface(objServer->add_interface(placeGetRecordType(objectPath),
                                                  smbiosInterfaceName)),
         smbiosFilePath(std::move(filePath)),
         smbiosObjectPath(std::move(objectPath)),
-        smbiosInventoryPath(std::move(inventoryPath))
+        smbiosInventoryPath(std::move(inventoryPath)),
+        tableHistory(smbiosFilePath + tableHistorySuffix, tableHistoryDepth),
+        tableDecoder(
+            *io,
+            [this](const DecodedTable& table) { applyDecodedTable(table); },
+            &metrics)
     {
         lg2::info("SMBIOS data file path: {F}", "F", smbiosFilePath);
         lg2::info("SMBIOS control object: {O}", "O", smbiosObjectPath);
@@ -169,13 +223,51 @@ class MDRV2 :
                   smbiosDir.dir[smbiosDirIndex].common.id.dataInfo);
 
         smbiosDir.dir[smbiosDirIndex].dataStorage = smbiosTableStorage;
+        updateIdIndexMap();
 
-        agentSynchronizeData();
+        for (uint8_t index = 0; index < maxDirEntries; index++)
+        {
+            entryTimers.emplace_back(*io);
+        }
+
+        if (!agentSynchronizeData() && restoreLastKnownGood(smbiosFilePath))
+        {
+            lg2::warning("Falling back to last-known-good SMBIOS table");
+            agentSynchronizeData();
+        }
 
         smbiosInterface->register_method("GetRecordType", [this](size_t type) {
             return getRecordType(type);
         });
+        smbiosInterface->register_method(
+            "GetDataSetRecordType",
+            [this](std::vector<uint8_t> dataInfo, size_t type) {
+            return getDataSetRecordType(std::move(dataInfo), type);
+        });
+        smbiosInterface->register_method(
+            "GetDataSetGeneration", [this](std::vector<uint8_t> dataInfo) {
+            return getDataSetGeneration(std::move(dataInfo));
+        });
+        smbiosInterface->register_method(
+            "GetTableGenerations", [this]() { return getTableGenerations(); });
+        smbiosInterface->register_method("DiffTableGenerations",
+                                         [this](uint32_t from, uint32_t to) {
+            return diffTableGenerations(from, to);
+        });
         smbiosInterface->initialize();
+
+        metricsInterface = objServer->add_interface(smbiosObjectPath,
+                                                    metricsInterfaceName);
+        metricsInterface->register_method(
+            "GetPhaseTimes", [this]() { return getPhaseTimes(); });
+        metricsInterface->register_method(
+            "GetCounters", [this]() { return getCounters(); });
+        metricsInterface->initialize();
+
+#ifdef SMBIOS_TABLE_WATCH
+        tableWatch = std::make_unique<TableWatch>(*io, smbiosFilePath,
+                                                  [this]() { reloadTable(); });
+#endif
     }
 
     std::vector<uint8_t> getDirectoryInformation(uint8_t dirIndex) override;
@@ -204,44 +296,87 @@ class MDRV2 :
     std::vector<boost::container::flat_map<std::string, RecordVariant>>
         getRecordType(size_t type);
 
+    /** @brief Like getRecordType, for the data set with the given id */
+    std::vector<boost::container::flat_map<std::string, RecordVariant>>
+        getDataSetRecordType(std::vector<uint8_t> dataInfo, size_t type);
+
+    /** @brief Number of times the data set with the given id was loaded */
+    uint32_t getDataSetGeneration(std::vector<uint8_t> dataInfo);
+
+    std::vector<TableGeneration> getTableGenerations(void);
+
+    std::vector<PhaseTime> getPhaseTimes(void) const;
+
+    std::vector<CounterValue> getCounters(void) const;
+
+    std::vector<TableChange> diffTableGenerations(uint32_t from, uint32_t to);
+
   private:
     boost::asio::steady_timer timer;
 
     std::shared_ptr<sdbusplus::asio::connection> bus;
     std::shared_ptr<sdbusplus::asio::object_server> objServer;
 
-    Mdr2DirStruct smbiosDir;
+    Mdr2DirStruct smbiosDir{};
 
-    bool readDataFromFlash(MDRSMBIOSHeader* mdrHdr, uint8_t* data);
+    bool readDataFromFlash(const std::string& filePath,
+                           MDRSMBIOSHeader* mdrHdr, uint8_t* data);
+    std::string entryFilePath(uint8_t index) const;
+    bool loadEntry(uint8_t index);
+    void updateIdIndexMap(void);
+    std::vector<boost::container::flat_map<std::string, RecordVariant>>
+        getEntryRecordType(uint8_t index, size_t type);
     bool checkSMBIOSVersion(uint8_t* dataIn);
+    bool recordLoadedTable(void);
+    void reloadTable(void);
 
     const std::array<uint8_t, 16> smbiosTableId{
         40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 0x42};
     uint8_t smbiosTableStorage[smbiosTableStorageSize] = {};
+    // Storage of the secondary data sets, allocated when first loaded
+    std::array<std::unique_ptr<uint8_t[]>, maxDirEntries> entryStorage;
+    // Structures of each loaded data set, for the record type lookups
+    std::array<StructureIndex, maxDirEntries> entryIndex;
+    std::vector<boost::asio::steady_timer> entryTimers;
+    std::unordered_map<std::string, uint8_t> idIndexMap;
 
     bool smbiosIsUpdating(uint8_t index);
     bool smbiosIsAvailForUpdate(uint8_t index);
     inline uint8_t smbiosValidFlag(uint8_t index);
     void systemInfoUpdate(void);
-
-    std::optional<size_t> getTotalCpuSlot(void);
-    std::optional<size_t> getTotalDimmSlot(void);
-    std::optional<size_t> getTotalPcieSlot(void);
-    std::optional<size_t> getTotalNum(uint8_t typeId, size_t minSize = 0);
-    std::vector<std::unique_ptr<Cpu>> cpus;
-    std::vector<std::unique_ptr<Dimm>> dimms;
-    std::vector<std::unique_ptr<Pcie>> pcies;
-    std::unique_ptr<System> system;
-    std::unique_ptr<Tpm> tpm;
-    std::vector<std::unique_ptr<Firmware>> firmwareCollection;
-    std::vector<std::unique_ptr<Baseboard>> baseboards;
+    void applyDecodedTable(const DecodedTable& table);
+    /** @brief Move a default inventory path under this instance's one */
+    std::string instancePath(std::string_view path) const;
+    std::string firmwareObjectName(const std::string& objName) const;
+
+    // Declared before the inventory objects, which may look services up
+    MapperCache mapperCache;
+    std::vector<InventoryObject<Cpu, CpuRecord>> cpus;
+    std::vector<InventoryObject<Dimm, DimmRecord>> dimms;
+    std::vector<InventoryObject<Pcie, PcieRecord>> pcies;
+    std::vector<InventoryObject<System, SystemRecord>> system;
+    std::vector<InventoryObject<Tpm, TpmRecord>> tpm;
+    std::vector<InventoryObject<Firmware, FirmwareRecord>> firmwareCollection;
     std::shared_ptr<sdbusplus::asio::dbus_interface> smbiosInterface;
+    std::shared_ptr<sdbusplus::asio::dbus_interface> metricsInterface;
     std::unique_ptr<sdbusplus::bus::match_t> interfaceAddedMatch;
 
     std::string smbiosFilePath;
     std::string smbiosObjectPath;
     std::string smbiosInventoryPath;
+    TableHistory tableHistory;
+    // Hash of the table currently loaded in storage
+    uint64_t loadedTableHash = 0;
+    // Hash of a loaded table to record once it has been published
+    uint64_t unrecordedTableHash = 0;
+#ifdef SMBIOS_TABLE_WATCH
+    std::unique_ptr<TableWatch> tableWatch;
+#endif
     std::unique_ptr<sdbusplus::bus::match_t> motherboardConfigMatch;
+    // Updated by the decoder thread as well
+    Metrics metrics;
+    // Last member, so the worker is stopped before anything it reports to
+    TableDecoder tableDecoder;
 };
 
 } // namespace smbios
@@ -0,0 +1,157 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "atomic_stats.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/** @brief Steps of loading and publishing a table that are timed */
+enum class Phase : size_t
+{
+    fileRead,
+    versionCheck,
+    indexing,
+    decodeCpu,
+    decodeDimm,
+    decodePcie,
+    decodeTpm,
+    decodeFirmware,
+    decodeSystem,
+    mapperQuery,
+    /** Destroying replaced objects, which sends their InterfacesRemoved */
+    objectRemoval,
+    /** Creating new objects, which sends their InterfacesAdded */
+    objectCreation,
+    count,
+};
+
+enum class Counter : size_t
+{
+    tablesLoaded,
+    rebuilds,
+    recordsDecoded,
+    /** InterfacesAdded and InterfacesRemoved signals */
+    signalsEmitted,
+    /** Reloads skipped and objects kept because nothing changed */
+    dedupHits,
+    count,
+};
+
+const char* phaseName(Phase phase);
+const char* counterName(Counter counter);
+
+/**
+ * Phase timings and event counters of one MDRV2 instance, updated from both
+ * the D-Bus thread and the decoder thread without a lock.
+ */
+class Metrics
+{
+  public:
+    struct PhaseStats
+    {
+        uint64_t count = 0;
+        std::chrono::nanoseconds total{0};
+        std::chrono::nanoseconds max{0};
+    };
+
+    /** Adds the time from its construction to its destruction to a phase.
+     *  Consecutive phases can share a timer through next(). Does nothing
+     *  without a Metrics instance.
+     */
+    class Timer
+    {
+      public:
+        Timer(Metrics* metrics, Phase phase) :
+            metrics(metrics), phase(phase),
+            start(metrics != nullptr ? std::chrono::steady_clock::now()
+                                     : std::chrono::steady_clock::time_point{})
+        {}
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        ~Timer()
+        {
+            stop();
+        }
+
+        /** @brief End the current phase and start timing another one */
+        void next(Phase nextPhase)
+        {
+            if (metrics != nullptr)
+            {
+                auto now = std::chrono::steady_clock::now();
+                metrics->record(phase, now - start);
+                start = now;
+            }
+            phase = nextPhase;
+        }
+
+        /** @brief End the current phase early */
+        void stop()
+        {
+            if (metrics != nullptr)
+            {
+                metrics->record(phase,
+                                std::chrono::steady_clock::now() - start);
+                metrics = nullptr;
+            }
+        }
+
+      private:
+        Metrics* metrics;
+        Phase phase;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void record(Phase phase, std::chrono::nanoseconds elapsed);
+
+    void add(Counter counter, uint64_t value = 1)
+    {
+        counters[static_cast<size_t>(counter)].fetch_add(
+            value, std::memory_order_relaxed);
+    }
+
+    PhaseStats stats(Phase phase) const;
+
+    uint64_t value(Counter counter) const
+    {
+        return counters[static_cast<size_t>(counter)].load(
+            std::memory_order_relaxed);
+    }
+
+  private:
+    /** Nanoseconds spent in each phase */
+    std::array<AtomicStats, static_cast<size_t>(Phase::count)> phases;
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::count)>
+        counters{};
+};
+
+} // namespace smbios
+
+} // namespace phosphor
@@ -31,6 +31,18 @@ using item = sdbusplus::server::xyz::openbmc_project::inventory::Item;
 using association =
     sdbusplus::server::xyz::openbmc_project::association::Definitions;
 
+/** @brief Decoded SMBIOS type-9 PCIe slot, as published by Pcie */
+struct PcieRecord
+{
+    PCIeGeneration generation = PCIeGeneration::Unknown;
+    PCIeType slotType = PCIeType::Unknown;
+    size_t lanes = 0;
+    bool hotPluggable = false;
+    std::string location;
+
+    bool operator==(const PcieRecord&) const = default;
+};
+
 class Pcie :
     sdbusplus::server::object_t<PCIeSlot, location, embedded, item, association>
 {
@@ -43,21 +55,24 @@ class Pcie :
     ~Pcie() = default;
 
     Pcie(sdbusplus::bus_t& bus, const std::string& objPath,
-         const uint8_t& pcieId, uint8_t* smbiosTableStorage,
-         const std::string& motherboard) :
+         const PcieRecord& record, const std::string& motherboard) :
         sdbusplus::server::object_t<PCIeSlot, location, embedded, item,
-                                    association>(bus, objPath.c_str()),
-        pcieNum(pcieId)
+                                    association>(bus, objPath.c_str(),
+                                                 action::defer_emit)
     {
-        pcieInfoUpdate(smbiosTableStorage, motherboard);
+        pcieInfoUpdate(record, motherboard);
+        emit_object_added();
     }
 
-    void pcieInfoUpdate(uint8_t* smbiosTableStorage,
+    /** @brief Decode the pcieNum-th PCIe system slot of a table.
+     *  Only reads the table, so it can run off the D-Bus thread.
+     */
+    static PcieRecord decode(uint8_t* smbiosTableStorage, uint8_t pcieNum);
+
+    void pcieInfoUpdate(const PcieRecord& record,
                         const std::string& motherboard);
 
   private:
-    uint8_t pcieNum;
-    uint8_t* storage;
     std::string motherboardPath;
 
     static constexpr uint8_t slotLengthShort = 0x03;
@@ -102,13 +117,10 @@ class Pcie :
         uint8_t slotHeight;
     } __attribute__((packed));
 
-    void pcieGeneration(const uint8_t type);
-    void pcieType(const uint8_t type, const uint8_t length,
-                  const uint8_t height);
-    void pcieLaneSize(const uint8_t width);
-    void pcieIsHotPluggable(const uint8_t characteristics);
-    void pcieLocation(const uint8_t slotDesignation, const uint8_t structLen,
-                      uint8_t* dataIn);
+    static PCIeGeneration pcieGeneration(const uint8_t type);
+    static PCIeType pcieType(const uint8_t type, const uint8_t length,
+                             const uint8_t height);
+    static size_t pcieLaneSize(const uint8_t width);
 };
 
 static const std::unordered_set<uint8_t> pcieSmbiosType = {
@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+/**
+ * Runs PECI work on worker threads, so a slow or busy CPU mailbox never holds
+ * up the D-Bus handling on the I/O thread.
+ *
+ * Each job belongs to a socket. Jobs of the same socket run one at a time in
+ * submission order, jobs of different sockets may run at the same time, e.g.
+ * one while another waits for its mailbox. When a job returns or throws, its
+ * completion is posted through an eventfd and always runs on the thread
+ * running the io_context, where D-Bus objects may be touched.
+ */
+class Engine
+{
+  public:
+    using Work = std::function<void()>;
+    /** Receives what the work threw, or null if it returned */
+    using Completion = std::function<void(std::exception_ptr)>;
+
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    /** Keeps the jobs of a socket from running, see lockSocket() */
+    class SocketLock
+    {
+      public:
+        SocketLock(const SocketLock&) = delete;
+        SocketLock& operator=(const SocketLock&) = delete;
+        ~SocketLock();
+
+        /** Whether the socket was free and is now held */
+        explicit operator bool() const
+        {
+            return owned;
+        }
+
+      private:
+        friend class Engine;
+        SocketLock(Engine& engine, uint8_t socket,
+                   std::chrono::milliseconds timeout);
+
+        Engine& engine;
+        uint8_t socket;
+        bool owned = false;
+    };
+
+    /** @brief Start the workers.
+     *  @param workers Number of jobs that may run at the same time.
+     */
+    Engine(boost::asio::io_context& io, unsigned int workers);
+
+    ~Engine();
+
+    /** @brief Queue work for the workers.
+     *  @param socket PECI address the work talks to.
+     *  @param work Runs on a worker, may block on PECI.
+     *  @param done Runs on the I/O thread after the work.
+     *  @param lengthy The work may take seconds, e.g. a discovery pass.
+     *                 lockSocket() doesn't wait for it.
+     */
+    void submit(uint8_t socket, Work work, Completion done,
+                bool lengthy = false);
+
+    /**
+     * Keep the workers from starting jobs of a socket while the caller sends
+     * PECI commands to it itself, e.g. for a write whose result the D-Bus
+     * reply reports. A short job of the socket already running is waited for,
+     * up to the timeout. If the socket is still in use after that, or its
+     * running job is lengthy, the returned lock doesn't hold it.
+     */
+    SocketLock lockSocket(uint8_t socket, std::chrono::milliseconds timeout);
+
+  private:
+    struct Job
+    {
+        uint8_t socket;
+        Work work;
+        Completion done;
+        bool lengthy;
+        std::exception_ptr error;
+    };
+
+    void run();
+    void readNotify();
+    /** Take the first pending job of a socket nobody is using, with the
+     *  mutex held. */
+    bool takeJob(Job& job);
+
+    boost::asio::posix::stream_descriptor notifyDescriptor;
+    uint64_t notifyValue = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    /** Signaled whenever a socket is no longer in use */
+    std::condition_variable released;
+    std::deque<Job> pending;
+    std::deque<Job> finished;
+    /** Sockets with a job running or a SocketLock taken */
+    std::set<uint8_t> busy;
+    /** Sockets running a lengthy job */
+    std::set<uint8_t> lengthy;
+    bool stopping = false;
+
+    std::vector<std::thread> workers;
+};
+
+} // namespace peci
+} // namespace cpu_info
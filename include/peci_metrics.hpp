@@ -0,0 +1,209 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "atomic_stats.hpp"
+#include "peci_transport.hpp"
+
+#include <peci.h>
+
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+static constexpr const char* metricsInterface =
+    "xyz.openbmc_project.CPUInfo.PECIMetrics";
+
+/** Upper bounds of the latency histogram buckets in microseconds. A last
+ *  bucket counts everything above. */
+static constexpr std::array<uint64_t, 14> latencyBucketsUs = {
+    10,   20,    50,    100,   200,   500,    1000,
+    2000, 5000, 10000, 20000, 50000, 100000, 1000000};
+
+const char* commandName(Command command);
+
+/**
+ * Latency distribution of one kind of operation, recorded by the PECI workers
+ * and read by the PECIMetrics getters. The bucket counts may be a few records
+ * ahead of or behind the count.
+ */
+class Histogram
+{
+  public:
+    struct Snapshot
+    {
+        uint64_t count = 0;
+        uint64_t totalUs = 0;
+        uint64_t maxUs = 0;
+        /** Count of each bucket of latencyBucketsUs, and of the last one */
+        std::vector<uint64_t> buckets;
+    };
+
+    void record(std::chrono::nanoseconds elapsed);
+
+    Snapshot snapshot() const;
+
+  private:
+    /** In microseconds */
+    phosphor::smbios::AtomicStats latency;
+    std::array<std::atomic<uint64_t>, latencyBucketsUs.size() + 1> buckets{};
+};
+
+/** How an OS Mailbox command ended */
+enum class MailboxOutcome
+{
+    success,
+    /** The mailbox returned an error status */
+    errorStatus,
+    /** RUN_BUSY stayed set past the command's deadline */
+    timeout,
+    /** A PECI command to the mailbox registers failed */
+    peciFailure,
+};
+
+/** Counters and latencies of the PECI traffic of cpuinfoapp, per socket */
+class Metrics
+{
+  public:
+    struct CommandStats
+    {
+        std::atomic<uint64_t> errors{0};
+        /** The driver timed out waiting for the CPU */
+        std::atomic<uint64_t> timeouts{0};
+        /** The CPU was in a low-power state, see Wake-on-PECI */
+        std::atomic<uint64_t> sleeping{0};
+        Histogram latency;
+    };
+
+    struct MailboxStats
+    {
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> timeouts{0};
+        std::atomic<uint64_t> peciFailures{0};
+        /** Polls of the interface register that found RUN_BUSY set */
+        std::atomic<uint64_t> busyPolls{0};
+        /** Times Wake-on-PECI was set */
+        std::atomic<uint64_t> wakes{0};
+        Histogram roundTrip;
+    };
+
+    static constexpr size_t sockets = MAX_CLIENT_ADDR - MIN_CLIENT_ADDR + 1;
+
+    /** @brief Record a PECI command, as returned by the transport. */
+    void recordCommand(uint8_t address, Command command, EPECIStatus status,
+                       uint8_t cc, std::chrono::nanoseconds elapsed);
+
+    /** @brief Record an OS Mailbox command, from the first poll of the
+     *         interface register to reading the data.
+     */
+    void recordMailbox(uint8_t address, MailboxOutcome outcome,
+                       unsigned int busyPolls,
+                       std::chrono::nanoseconds elapsed);
+
+    void recordWake(uint8_t address);
+
+    /** @brief Record one attempt to discover the SST levels of a socket. */
+    void recordDiscovery(uint8_t address, std::chrono::nanoseconds elapsed);
+
+    /** @brief Record the time from starting discovery to the last socket
+     *         being done.
+     */
+    void recordDiscoveryPass(std::chrono::nanoseconds elapsed);
+
+    /** Null for addresses that are not CPU sockets */
+    const CommandStats* command(uint8_t address, Command command) const;
+    const MailboxStats* mailbox(uint8_t address) const;
+    const Histogram* discovery(uint8_t address) const;
+
+    const Histogram& discoveryPass() const
+    {
+        return pass;
+    }
+
+  private:
+    struct Socket
+    {
+        std::array<CommandStats, static_cast<size_t>(Command::count)>
+            commands;
+        MailboxStats mailbox;
+        Histogram discovery;
+    };
+
+    Socket* socket(uint8_t address);
+    const Socket* socket(uint8_t address) const;
+
+    std::array<Socket, sockets> perSocket;
+    Histogram pass;
+};
+
+Metrics& getMetrics();
+
+/** Transport recording every command in the metrics, then passing it on */
+class MeteredTransport : public Transport
+{
+  public:
+    explicit MeteredTransport(std::unique_ptr<Transport> transport);
+
+    EPECIStatus getCPUID(uint8_t address, CPUModel* model, uint8_t* stepping,
+                         uint8_t* cc) override;
+    EPECIStatus rdPkgConfig(uint8_t address, uint8_t index, uint16_t param,
+                            uint8_t readLen, uint8_t* data,
+                            uint8_t* cc) override;
+    EPECIStatus wrPkgConfig(uint8_t address, uint8_t index, uint16_t param,
+                            uint32_t value, uint8_t writeLen,
+                            uint8_t* cc) override;
+    EPECIStatus rdIAMSR(uint8_t address, uint8_t thread, uint16_t msrAddress,
+                        uint64_t* value, uint8_t* cc) override;
+    EPECIStatus rdEndPointConfigPciLocal(uint8_t address, uint8_t segment,
+                                         uint8_t bus, uint8_t device,
+                                         uint8_t function, uint16_t reg,
+                                         uint8_t readLen, uint8_t* data,
+                                         uint8_t* cc) override;
+    EPECIStatus wrEndPointPCIConfigLocal(uint8_t address, uint8_t segment,
+                                         uint8_t bus, uint8_t device,
+                                         uint8_t function, uint16_t reg,
+                                         uint8_t dataLen, uint32_t data,
+                                         uint8_t* cc) override;
+
+  private:
+    template <typename Fn>
+    EPECIStatus metered(uint8_t address, Command command, uint8_t* cc,
+                        Fn&& fn);
+
+    std::unique_ptr<Transport> transport;
+};
+
+/**
+ * Add the PECIMetrics interface to the CPUInfo object.
+ *
+ * @param[in,out]   server  Object server of cpuinfoapp.
+ */
+void registerMetrics(sdbusplus::asio::object_server& server);
+
+} // namespace peci
+} // namespace cpu_info
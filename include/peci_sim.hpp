@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "peci_transport.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+/** One SST-PP configuration level of a simulated CPU. Ratios are in 100 MHz */
+struct SimLevel
+{
+    unsigned int tdp = 0;
+    unsigned int tdpRatio = 0;
+    uint64_t coreMask = 0;
+    /** Ratio limit of each turbo bucket, bucket 0 in the low byte */
+    uint64_t turboRatios = 0;
+    unsigned int p0 = 0;
+    unsigned int p1 = 0;
+    unsigned int pn = 0;
+    unsigned int pm = 0;
+    unsigned int tProchot = 0;
+    bool pbfSupport = false;
+    bool factSupport = false;
+    uint64_t bfHighPriorityMask = 0;
+    unsigned int p1Hi = 0;
+    unsigned int p1Lo = 0;
+};
+
+/** A simulated CPU package and the behavior of its PCode OS Mailbox */
+struct SimSocket
+{
+    CPUModel model = sapphireRapids;
+    uint8_t stepping = 0;
+    uint64_t ppin = 0;
+    uint32_t microcode = 0;
+
+    bool ppEnabled = true;
+    /** SST-PP locked by BIOS, set commands are rejected */
+    bool locked = false;
+    /** Indexed by level number, empty for numbers that are not supported */
+    std::vector<std::optional<SimLevel>> levels;
+    unsigned int currentLevel = 0;
+    bool bfEnabled = false;
+    bool tfEnabled = false;
+    /** Turbo Ratio Limit Cores MSR, core count of each bucket */
+    uint64_t trlCores = 0;
+
+    /** Reads of the interface register that still show RUN_BUSY after a
+     *  command is started. With the backoff between reads, about 30 make the
+     *  command run past its deadline. */
+    unsigned int busyCycles = 0;
+    /** Package is in a low-power state: endpoint accesses fail with an
+     *  unavailable resource completion code until Wake-on-PECI is set. */
+    bool sleeping = false;
+    /** Number of upcoming commands that time out in the driver */
+    unsigned int timeouts = 0;
+};
+
+struct SimConfig
+{
+    /** Time each kind of command occupies the bus */
+    std::array<std::chrono::microseconds, static_cast<size_t>(Command::count)>
+        latency{};
+    /** Commands to different sockets also wait for each other, as they do on
+     *  a single PECI wire. */
+    bool sharedBus = true;
+    /** Sockets by PECI address. Other addresses report no CPU present. */
+    std::map<uint8_t, SimSocket> sockets;
+};
+
+/** Return a CPU with levels 0, 3 and 4, SST-BF on level 0, and a PPIN
+ *  derived from the index. */
+SimSocket makeSimSocket(CPUModel model, unsigned int index);
+
+/**
+ * Parse a comma separated list of key=value settings into a simulation:
+ *  sockets=N   number of CPUs from MIN_CLIENT_ADDR on (default 2)
+ *  model=M     icx, icxd, spr or emr (default spr)
+ *  latency=US  time of every command in microseconds
+ *  busy=N      busy cycles of every mailbox command
+ *  sleeping=1  CPUs start in a low-power state
+ *  timeouts=N  first commands to each CPU that time out
+ *
+ * @return  Empty if the spec has an unknown key or bad value.
+ */
+std::optional<SimConfig> parseSimSpec(std::string_view spec);
+
+/**
+ * In-process model of the PECI bus and of the PCode OS Mailbox of each CPU,
+ * so that SST discovery and control can run without hardware.
+ */
+class SimulatedTransport : public Transport
+{
+  public:
+    explicit SimulatedTransport(SimConfig config);
+
+    EPECIStatus getCPUID(uint8_t address, CPUModel* model, uint8_t* stepping,
+                         uint8_t* cc) override;
+    EPECIStatus rdPkgConfig(uint8_t address, uint8_t index, uint16_t param,
+                            uint8_t readLen, uint8_t* data,
+                            uint8_t* cc) override;
+    EPECIStatus wrPkgConfig(uint8_t address, uint8_t index, uint16_t param,
+                            uint32_t value, uint8_t writeLen,
+                            uint8_t* cc) override;
+    EPECIStatus rdIAMSR(uint8_t address, uint8_t thread, uint16_t msrAddress,
+                        uint64_t* value, uint8_t* cc) override;
+    EPECIStatus rdEndPointConfigPciLocal(uint8_t address, uint8_t segment,
+                                         uint8_t bus, uint8_t device,
+                                         uint8_t function, uint16_t reg,
+                                         uint8_t readLen, uint8_t* data,
+                                         uint8_t* cc) override;
+    EPECIStatus wrEndPointPCIConfigLocal(uint8_t address, uint8_t segment,
+                                         uint8_t bus, uint8_t device,
+                                         uint8_t function, uint16_t reg,
+                                         uint8_t dataLen, uint32_t data,
+                                         uint8_t* cc) override;
+
+    /** Change a CPU, e.g. its level as in-band software would. */
+    void update(uint8_t address, const std::function<void(SimSocket&)>& fn);
+
+    /** Whether Wake-on-PECI is currently set on a CPU */
+    bool wakeOnPECI(uint8_t address) const;
+    /** Times Wake-on-PECI was set and cleared on a CPU */
+    std::pair<uint64_t, uint64_t> wakeTransitions(uint8_t address) const;
+
+    /** Commands of a kind sent to an address, including absent CPUs */
+    uint64_t transactions(uint8_t address, Command command) const;
+    /** All commands sent */
+    uint64_t transactions() const;
+
+  private:
+    struct Socket
+    {
+        SimSocket cpu;
+        uint32_t dataReg = 0;
+        uint32_t interfaceReg = 0;
+        bool pending = false;
+        unsigned int busyLeft = 0;
+        bool wakeOnPECI = false;
+        uint64_t wakeSets = 0;
+        uint64_t wakeClears = 0;
+    };
+
+    /** Hold the bus for the command's latency, then run it on the socket's
+     *  state. */
+    template <typename Fn>
+    EPECIStatus transact(uint8_t address, Command command, uint8_t* cc,
+                         Fn&& fn);
+
+    bool mailboxTarget(const Socket& socket, uint8_t segment, uint8_t bus,
+                       uint8_t device, uint8_t function, uint16_t reg,
+                       uint8_t len) const;
+    void runMailboxCommand(Socket& socket);
+
+    SimConfig config;
+    std::map<uint8_t, Socket> sockets;
+    std::map<uint8_t, std::array<uint64_t, static_cast<size_t>(
+                                               Command::count)>>
+        counts;
+    std::atomic<uint64_t> total{0};
+    mutable std::mutex stateMutex;
+    std::mutex busMutex;
+};
+
+} // namespace peci
+} // namespace cpu_info
@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <peci.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+/** Kinds of PECI command, as sent through a Transport */
+enum class Command : size_t
+{
+    getCPUID,
+    rdPkgConfig,
+    wrPkgConfig,
+    rdIAMSR,
+    rdPCIConfigLocal,
+    wrPCIConfigLocal,
+    count
+};
+
+/**
+ * The PECI commands used by cpuinfoapp. Each method has the signature and
+ * return codes of the libpeci function of the same name, so callers can
+ * switch between real hardware and a simulated CPU without other changes.
+ */
+class Transport
+{
+  public:
+    virtual ~Transport() = default;
+
+    virtual EPECIStatus getCPUID(uint8_t address, CPUModel* model,
+                                 uint8_t* stepping, uint8_t* cc) = 0;
+
+    virtual EPECIStatus rdPkgConfig(uint8_t address, uint8_t index,
+                                    uint16_t param, uint8_t readLen,
+                                    uint8_t* data, uint8_t* cc) = 0;
+
+    virtual EPECIStatus wrPkgConfig(uint8_t address, uint8_t index,
+                                    uint16_t param, uint32_t value,
+                                    uint8_t writeLen, uint8_t* cc) = 0;
+
+    virtual EPECIStatus rdIAMSR(uint8_t address, uint8_t thread,
+                                uint16_t msrAddress, uint64_t* value,
+                                uint8_t* cc) = 0;
+
+    virtual EPECIStatus rdEndPointConfigPciLocal(uint8_t address,
+                                                 uint8_t segment, uint8_t bus,
+                                                 uint8_t device,
+                                                 uint8_t function,
+                                                 uint16_t reg, uint8_t readLen,
+                                                 uint8_t* data,
+                                                 uint8_t* cc) = 0;
+
+    virtual EPECIStatus wrEndPointPCIConfigLocal(uint8_t address,
+                                                 uint8_t segment, uint8_t bus,
+                                                 uint8_t device,
+                                                 uint8_t function,
+                                                 uint16_t reg, uint8_t dataLen,
+                                                 uint32_t data,
+                                                 uint8_t* cc) = 0;
+};
+
+/** Transport talking to the CPUs through libpeci */
+class LibPECITransport : public Transport
+{
+  public:
+    EPECIStatus getCPUID(uint8_t address, CPUModel* model, uint8_t* stepping,
+                         uint8_t* cc) override;
+    EPECIStatus rdPkgConfig(uint8_t address, uint8_t index, uint16_t param,
+                            uint8_t readLen, uint8_t* data,
+                            uint8_t* cc) override;
+    EPECIStatus wrPkgConfig(uint8_t address, uint8_t index, uint16_t param,
+                            uint32_t value, uint8_t writeLen,
+                            uint8_t* cc) override;
+    EPECIStatus rdIAMSR(uint8_t address, uint8_t thread, uint16_t msrAddress,
+                        uint64_t* value, uint8_t* cc) override;
+    EPECIStatus rdEndPointConfigPciLocal(uint8_t address, uint8_t segment,
+                                         uint8_t bus, uint8_t device,
+                                         uint8_t function, uint16_t reg,
+                                         uint8_t readLen, uint8_t* data,
+                                         uint8_t* cc) override;
+    EPECIStatus wrEndPointPCIConfigLocal(uint8_t address, uint8_t segment,
+                                         uint8_t bus, uint8_t device,
+                                         uint8_t function, uint16_t reg,
+                                         uint8_t dataLen, uint32_t data,
+                                         uint8_t* cc) override;
+};
+
+/** Return the transport used for all PECI commands, libpeci by default.
+ *  Every command sent through it is recorded in the PECI metrics. */
+Transport& getTransport();
+
+/**
+ * Replace the transport used for all PECI commands. Must be called before any
+ * PECI command is sent, e.g. at the start of main().
+ */
+void setTransport(std::unique_ptr<Transport> transport);
+
+} // namespace peci
+} // namespace cpu_info
@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "smbios_index.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/** @brief Where a structure sits inside a baseboard (Type 2) */
+struct Containment
+{
+    /** Handle of the containing baseboard */
+    uint16_t board;
+    /** Index of the structure among the board's objects of the same type */
+    size_t indexOfType;
+};
+
+/**
+ * Relationships between the structures of one table, resolved once per load:
+ * Type 2 contained objects, Type 45 associated components and the Type 17 to
+ * Type 16 memory array links. Handles that do not resolve to a structure are
+ * left out, so every handle returned here can be passed to structure().
+ *
+ * The graph refers to the table it was built from, which must outlive it.
+ */
+class HandleGraph
+{
+  public:
+    HandleGraph() = default;
+
+    /**
+     * @brief Build the graph of a table.
+     * @param table Table content as stored in the MDR file, optionally
+     *              starting with an SMBIOS 3.0 entry point.
+     * @param resource Memory the graph is allocated from.
+     */
+    explicit HandleGraph(
+        std::span<uint8_t> table,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    const StructureIndex& index() const
+    {
+        return structures;
+    }
+
+    /** @return the structure with the given handle, or nullptr */
+    uint8_t* structure(uint16_t handle) const;
+
+    /** @return the first board containing the handle, or nullptr if no board
+     *  contains it.
+     */
+    const Containment* container(uint16_t handle) const;
+
+    /** @return the components associated with a firmware inventory entry */
+    std::span<const uint16_t> components(uint16_t firmwareHandle) const;
+
+    /** @return the physical memory array of a memory device */
+    std::optional<uint16_t> memoryArray(uint16_t deviceHandle) const;
+
+  private:
+    void addBoard(const StructureEntry& board);
+    void addFirmware(const StructureEntry& firmware);
+    void addMemoryDevice(const StructureEntry& device);
+
+    /** @brief Read a little endian handle from a structure's formatted area */
+    std::optional<uint16_t> handleAt(const StructureEntry& entry,
+                                     size_t offset) const;
+
+    std::span<uint8_t> table;
+    StructureIndex structures;
+    std::pmr::unordered_map<uint16_t, Containment> containers;
+    std::pmr::unordered_map<uint16_t, std::pmr::vector<uint16_t>>
+        firmwareComponents;
+    std::pmr::unordered_map<uint16_t, uint16_t> memoryArrays;
+};
+
+} // namespace smbios
+
+} // namespace phosphor
@@ -0,0 +1,88 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "smbios_mdrv2.hpp"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+static constexpr const char* tableHistorySuffix = ".history";
+static constexpr size_t tableHistoryDepth = 8;
+
+/** @brief FNV-1a hash of a table, used to identify a generation */
+uint64_t tableHash(std::span<const uint8_t> data);
+
+/**
+ * Bounded on-disk ring of the SMBIOS tables loaded by the daemon.
+ *
+ * Every generation is stored as an MDR table file named after its sequence
+ * number and content hash. A table that is already in the ring is not stored
+ * again, it only becomes the newest generation.
+ */
+class TableHistory
+{
+  public:
+    struct Generation
+    {
+        uint32_t sequence;
+        uint32_t timestamp;
+        uint64_t hash;
+    };
+
+    /**
+     * @param directory Directory holding the generations.
+     * @param depth Maximum number of generations kept.
+     */
+    TableHistory(std::string directory, size_t depth);
+
+    /**
+     * @brief Add a table as the newest generation, evicting the oldest ones
+     * beyond the ring depth.
+     * @return true on success.
+     */
+    bool record(const MDRSMBIOSHeader& header, std::span<const uint8_t> data);
+
+    /** @return the stored generations, oldest first */
+    const std::vector<Generation>& generations();
+
+    /**
+     * @brief Read the table content of a generation.
+     * @return false if the generation is unknown or cannot be read.
+     */
+    bool load(uint32_t sequence, std::vector<uint8_t>& data);
+
+  private:
+    void scan();
+    std::string generationPath(const Generation& generation) const;
+
+    std::string directory;
+    size_t depth;
+    bool scanned = false;
+    std::vector<Generation> ring;
+};
+
+} // namespace smbios
+
+} // namespace phosphor
@@ -0,0 +1,106 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/** @brief Location of one SMBIOS structure inside a table */
+struct StructureEntry
+{
+    uint16_t handle;
+    uint8_t type;
+    /** Offset of the structure header from the start of the table */
+    size_t offset;
+    /** Size of the formatted area plus the string-set, terminator included */
+    size_t size;
+};
+
+/**
+ * Index of the structures of one SMBIOS table, built with a single bounds
+ * checked walk so that structures can be looked up by handle or type without
+ * rescanning the table.
+ */
+class StructureIndex
+{
+  public:
+    StructureIndex() = default;
+
+    /**
+     * @brief Index a table.
+     * @param table Table content as stored in the MDR file, optionally
+     *              starting with an SMBIOS 3.0 entry point.
+     * @param resource Memory the index is allocated from.
+     */
+    explicit StructureIndex(
+        std::span<const uint8_t> table,
+        std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+
+    const std::pmr::vector<StructureEntry>& entries() const
+    {
+        return structures;
+    }
+
+    /** @return the structure with the given handle, or nullptr */
+    const StructureEntry* find(uint16_t handle) const;
+
+    /** @return the structures of the given type, in table order */
+    std::vector<const StructureEntry*> ofType(uint8_t type) const;
+
+  private:
+    std::pmr::vector<StructureEntry> structures;
+    std::pmr::unordered_map<uint16_t, size_t> handles;
+};
+
+enum class StructureChange
+{
+    added,
+    removed,
+    modified
+};
+
+struct StructureDiff
+{
+    StructureChange change;
+    uint16_t handle;
+    uint8_t type;
+};
+
+/**
+ * @brief Compare two tables structure by structure, matching by handle. A
+ * structure whose handle was reused for another type is reported as removed
+ * and added.
+ * @return The changes, ordered by handle.
+ */
+std::vector<StructureDiff> diffTables(std::span<const uint8_t> oldTable,
+                                      const StructureIndex& oldIndex,
+                                      std::span<const uint8_t> newTable,
+                                      const StructureIndex& newIndex);
+
+} // namespace smbios
+
+} // namespace phosphor
@@ -48,7 +48,7 @@ constexpr uint32_t smbiosTableVersion = 15;
 constexpr uint32_t smbiosTableTimestamp = 0x45464748;
 constexpr uint32_t smbiosSMMemoryOffset = 0;
 constexpr uint32_t smbiosSMMemorySize = 1024 * 1024;
-constexpr uint32_t smbiosTableStorageSize = 64 * 1024;
+constexpr uint32_t smbiosTableStorageSize = SMBIOS_TABLE_STORAGE_SIZE;
 constexpr uint32_t defaultTimeout = 2'000'000; // 2-seconds.
 
 static constexpr std::string_view anchorString21 = "_SM_";
@@ -105,6 +105,7 @@ typedef struct
     uint32_t xferSize;
     uint32_t maxDataSize;
     uint8_t* dataStorage;
+    uint32_t generation; // number of times the data set was loaded
 } Mdr2DirLocalStruct;
 
 typedef struct
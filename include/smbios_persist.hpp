@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include "smbios_mdrv2.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/**
+ * Crash-safe persistence of SMBIOS table files.
+ *
+ * Table files are never modified in place. New content is written to a
+ * temporary file in the same directory, flushed with fsync(), renamed over
+ * the live file and the directory is flushed, so after a power loss a reader
+ * sees either the complete old file or the complete new one.
+ */
+
+static constexpr const char* lastKnownGoodSuffix = ".lkg";
+
+/** @brief Path of the last-known-good copy of a table file */
+inline std::string lastKnownGoodPath(const std::string& path)
+{
+    return path + lastKnownGoodSuffix;
+}
+
+/**
+ * @brief Atomically replace a file with the concatenation of parts.
+ * @param path File to replace.
+ * @param parts Content of the new file.
+ * @return true on success. On failure the old file is left untouched.
+ */
+bool writeFileAtomic(const std::string& path,
+                     std::initializer_list<std::span<const uint8_t>> parts);
+
+/**
+ * @brief Atomically replace an MDR table file.
+ * @param path File to replace.
+ * @param header MDR header, its dataSize must match the size of data.
+ * @param data SMBIOS table content.
+ * @return true on success.
+ */
+bool writeTableFile(const std::string& path, const MDRSMBIOSHeader& header,
+                    std::span<const uint8_t> data);
+
+/**
+ * @brief Read a whole file.
+ * @return false if the file cannot be opened or read.
+ */
+bool readFile(const std::string& path, std::vector<uint8_t>& content);
+
+/**
+ * @brief Durably remove a table file, e.g. one found to be corrupted.
+ * The last-known-good copy is kept.
+ */
+bool removeTableFile(const std::string& path);
+
+/**
+ * @brief Record a successfully parsed table as the last-known-good generation
+ * of a table file. Nothing is written if the copy is already up to date.
+ */
+bool promoteLastKnownGood(const std::string& path,
+                          const MDRSMBIOSHeader& header,
+                          std::span<const uint8_t> data);
+
+/**
+ * @brief Replace a table file with its last-known-good generation.
+ * @return false if there is no last-known-good copy or it cannot be restored.
+ */
+bool restoreLastKnownGood(const std::string& path);
+
+} // namespace smbios
+
+} // namespace phosphor
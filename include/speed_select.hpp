@@ -17,6 +17,7 @@
 
 #include <boost/asio/io_context.hpp>
 #include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
 
 #include <bitset>
 #include <iostream>
@@ -32,8 +33,10 @@ namespace sst
  * This will schedule work to be done when the host is ready, in order to
  * retrieve all SST configuration info for all discoverable CPUs, and publish
  * the info on new D-Bus objects on the given bus connection.
+ *
+ * @param[in,out]   server  Object server to add the SpeedSelect interface to.
  */
-void init();
+void init(sdbusplus::asio::object_server& server);
 
 class PECIError : public std::runtime_error
 {
@@ -59,6 +62,37 @@ std::vector<uint32_t> convertMaskToList(std::bitset<64> mask);
 
 using TurboEntry = std::tuple<uint32_t, size_t>;
 
+/** Wake-on-PECI bookkeeping of one CPU */
+struct WakeStats
+{
+    /** Times the Wake-on-PECI bit was set or cleared */
+    uint64_t transitions = 0;
+    /** Sets and clears not needed because a wake hold was already taken */
+    uint64_t avoided = 0;
+};
+
+/**
+ * Policy for whether the SST interface should wake up an idle CPU to complete
+ * requested operations. Waking should be used sparingly to avoid excess CPU
+ * power draw, so the policy depends on the context.
+ */
+enum WakePolicy
+{
+    /**
+     * If CPU rejects the request due to being in a low-power state, enable
+     * wake-on-PECI on the CPU and retry. Wake-on-PECI is disabled for the CPU
+     * when the policy changes back to dontWake while no wake is held, or the
+     * SST interface is destroyed.
+     */
+    wakeAllowed,
+
+    /**
+     * If CPU rejects the request due to being in a low-power state, it results
+     * in a PECIError exception.
+     */
+    dontWake
+};
+
 /**
  * Abstract interface that must be implemented by backends, allowing discovery
  * and control of a single CPU package.
@@ -78,6 +112,35 @@ class SSTInterface
     /** Whether the processor supports the control ("set") functions. */
     virtual bool supportsControl() = 0;
 
+    /**
+     * Change whether the following operations may wake up the CPU. The
+     * interface is created with a policy and kept for as long as the CPU is
+     * known, so this lets one instance serve both reads and writes.
+     */
+    virtual void setWakePolicy(WakePolicy policy) = 0;
+
+    /**
+     * Allow the following operations to wake up the CPU until the matching
+     * releaseWake(), whatever the wake policy. Holds are counted, so a batch
+     * of operations sets Wake-on-PECI at most once, and it's cleared when the
+     * last hold is released.
+     */
+    virtual void holdWake() = 0;
+    /** Release a hold taken with holdWake(). */
+    virtual void releaseWake() = 0;
+    /** Return the Wake-on-PECI transitions made and avoided. */
+    virtual WakeStats wakeStats() const = 0;
+
+    /**
+     * Start or stop answering repeated reads from their earlier result, for
+     * a pass over many static values such as discovery. Any write, and
+     * stopping, drops the results.
+     */
+    virtual void setMemoize(bool enable) = 0;
+
+    /** Number of PECI commands that memoized reads did not have to send. */
+    virtual uint64_t transactionsSaved() const = 0;
+
     /** Whether SST-PP is enabled on the processor. */
     virtual bool ppEnabled() = 0;
     /** Return the current SST-PP configuration level */
@@ -138,27 +201,6 @@ class SSTInterface
     virtual void setCurrentLevel(unsigned int level) = 0;
 };
 
-/**
- * Policy for whether the SST interface should wake up an idle CPU to complete
- * requested operations. Waking should be used sparingly to avoid excess CPU
- * power draw, so the policy depends on the context.
- */
-enum WakePolicy
-{
-    /**
-     * If CPU rejects the request due to being in a low-power state, enable
-     * wake-on-PECI on the CPU and retry. Wake-on-PECI is disabled for the CPU
-     * when the SST interface is destroyed.
-     */
-    wakeAllowed,
-
-    /**
-     * If CPU rejects the request due to being in a low-power state, it results
-     * in a PECIError exception.
-     */
-    dontWake
-};
-
 /**
  * BackendProvider represents a function which may create an SSTInterface given
  * a CPU PECI address, and the CPU Model information. Usually the CPUModel is
@@ -187,5 +229,14 @@ using BackendProvider =
     } fn##Instance;
 void registerBackend(BackendProvider);
 
+/**
+ * Create the backend for a CPU, from the first registered provider that
+ * supports it.
+ *
+ * @return  nullptr if no backend supports the CPU.
+ */
+std::unique_ptr<SSTInterface> getInstance(uint8_t address, CPUModel model,
+                                          WakePolicy wakePolicy);
+
 } // namespace sst
 } // namespace cpu_info
@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "speed_select.hpp"
+
+#include <peci.h>
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace cpu_info
+{
+namespace sst
+{
+
+static constexpr const char* configCachePath =
+    "/var/lib/cpuinfo/sst-config.json";
+
+/**
+ * What identifies a CPU part well enough that its SST levels can't have
+ * changed. The PPIN tells parts of the same SKU apart, which matters because
+ * the enabled cores differ between them.
+ */
+struct SocketIdentity
+{
+    uint32_t model = 0;
+    uint8_t stepping = 0;
+    uint64_t ppin = 0;
+    uint32_t microcode = 0;
+
+    bool operator==(const SocketIdentity&) const = default;
+};
+
+/** Static properties of one SST-PP level, as published on OperatingConfig */
+struct LevelConfig
+{
+    unsigned int level = 0;
+    uint32_t powerLimit = 0;
+    size_t coreCount = 0;
+    uint32_t baseSpeed = 0;
+    uint32_t maxSpeed = 0;
+    uint32_t maxJunctionTemperature = 0;
+    std::vector<std::tuple<uint32_t, std::vector<uint32_t>>>
+        baseSpeedPrioritySettings;
+    std::vector<TurboEntry> turboProfile;
+
+    bool operator==(const LevelConfig&) const = default;
+};
+
+struct SocketConfig
+{
+    SocketIdentity identity;
+    std::vector<LevelConfig> levels;
+
+    bool operator==(const SocketConfig&) const = default;
+};
+
+/**
+ * Discovered SST levels of each CPU, kept in a file across restarts and host
+ * power cycles. An entry is only used while the CPU in the socket still has
+ * the same identity. Sockets are discovered in parallel, so all methods may be
+ * called from any thread.
+ */
+class ConfigCache
+{
+  public:
+    /** Load the cache, starting empty if the file is missing or invalid. */
+    explicit ConfigCache(std::string path);
+
+    /**
+     * Return the levels of the CPU at an index, if they were discovered on a
+     * CPU with the same identity.
+     */
+    std::optional<SocketConfig> find(unsigned int cpuIndex,
+                                     const SocketIdentity& identity) const;
+
+    /**
+     * Replace the entry of a socket with the result of its discovery, and
+     * write the file if anything changed.
+     *
+     * @param[in]   discovered  Empty to drop the entry, e.g. when the socket
+     *                          is empty or the part has no readable PPIN.
+     */
+    void update(unsigned int cpuIndex, std::optional<SocketConfig> discovered);
+
+  private:
+    void load();
+    bool save() const;
+
+    std::string path;
+    mutable std::mutex mutex;
+    std::map<unsigned int, SocketConfig> sockets;
+};
+
+} // namespace sst
+} // namespace cpu_info
@@ -0,0 +1,79 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "speed_select.hpp"
+#include "sst_cache.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+namespace cpu_info
+{
+namespace sst
+{
+
+/** What discovery found out about one CPU */
+struct DiscoveredCPU
+{
+    unsigned int index;
+    std::shared_ptr<SSTInterface> sst;
+    unsigned int currentLevel;
+    bool bfEnabled;
+    std::optional<SocketIdentity> identity;
+    /** Levels, empty if the published CPU is still in the socket */
+    SocketConfig config;
+    /** The published CPU is still in the socket, only the current level and
+     *  SST-BF state were read */
+    bool unchanged = false;
+};
+
+/** A CPU published by an earlier discovery */
+struct PublishedCPU
+{
+    std::shared_ptr<SSTInterface> sst;
+    SocketIdentity identity;
+};
+
+/**
+ * Retrieve all SST configuration info for the CPU at one PECI address. Runs on
+ * the PECI engine and touches no D-Bus objects.
+ *
+ * @param[in]   address     PECI address of the socket.
+ * @param[in]   published   The CPU published for the socket, if any and its
+ *                          identity is known. If the same part is still in
+ *                          the socket, only its current level and SST-BF
+ *                          state are read.
+ * @param[in]   configCache Levels found on earlier boots, updated with what
+ *                          is found now.
+ * @param[out]  found       The CPU to publish, if it has a usable SST-PP.
+ * @param[in]   memoize     Send each distinct mailbox read only once. Only
+ *                          turned off to compare against.
+ *
+ * @return  Whether discovery of the socket was successfully finished.
+ *
+ * @throw PECIError     A PECI command failed on a CPU which had previously
+ *                      responded to a command.
+ */
+bool discoverSocket(uint8_t address,
+                    const std::optional<PublishedCPU>& published,
+                    ConfigCache& configCache,
+                    std::optional<DiscoveredCPU>& found, bool memoize = true);
+
+} // namespace sst
+} // namespace cpu_info
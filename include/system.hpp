@@ -15,23 +15,39 @@
 */
 
 #pragma once
+#include "mapper_cache.hpp"
 #include "smbios_mdrv2.hpp"
 
 #include <sdbusplus/asio/connection.hpp>
 #include <xyz/openbmc_project/Common/UUID/server.hpp>
 #include <xyz/openbmc_project/Inventory/Decorator/Revision/server.hpp>
 
+#include <optional>
+#include <string>
+
 namespace phosphor
 {
 
 namespace smbios
 {
 
-class System :
-    sdbusplus::server::object_t<
-        sdbusplus::xyz::openbmc_project::Common::server::UUID>,
-    sdbusplus::server::object_t<
-        sdbusplus::xyz::openbmc_project::Inventory::Decorator::server::Revision>
+/** @brief Decoded SMBIOS system UUID and BIOS version */
+struct SystemRecord
+{
+    std::string uuid = "00000000-0000-0000-0000-000000000000";
+    /** Unset when the table has no BIOS information structure */
+    std::optional<std::string> biosVersion;
+    /** The BIOS version has non-printable characters, the table is broken */
+    bool biosVersionBroken = false;
+
+    bool operator==(const SystemRecord&) const = default;
+};
+
+using SystemObject = sdbusplus::server::object_t<
+    sdbusplus::xyz::openbmc_project::Common::server::UUID,
+    sdbusplus::xyz::openbmc_project::Inventory::Decorator::server::Revision>;
+
+class System : SystemObject
 {
   public:
     System() = delete;
@@ -42,33 +58,38 @@ class System :
     System& operator=(System&&) = default;
 
     System(std::shared_ptr<sdbusplus::asio::connection> bus,
-           std::string objPath, uint8_t* smbiosTableStorage,
-           std::string filePath) :
-        sdbusplus::server::object_t<
-            sdbusplus::server::xyz::openbmc_project::common::UUID>(
-            *bus, objPath.c_str()),
-        sdbusplus::server::object_t<sdbusplus::server::xyz::openbmc_project::
-                                        inventory::decorator::Revision>(
-            *bus, objPath.c_str()),
+           std::string objPath, const SystemRecord& record,
+           std::string filePath, MapperCache& mapper) :
+        SystemObject(*bus, objPath.c_str(), action::defer_emit),
         bus(std::move(bus)), path(std::move(objPath)),
-        storage(smbiosTableStorage), smbiosFilePath(std::move(filePath))
+        record(record), smbiosFilePath(std::move(filePath)), mapper(mapper)
     {
         std::string input = "0";
-        uuid(input);
-        version("0.00");
+        uuid(input, true);
+        version("0.00", true);
+        emit_object_added();
     }
 
     std::string uuid(std::string value) override;
 
+    std::string uuid(std::string value, bool skipSignal) override;
+
     std::string version(std::string value) override;
 
+    std::string version(std::string value, bool skipSignal) override;
+
+    /** @brief Decode the system and BIOS information of a table.
+     *  Only reads the table, so it can run off the D-Bus thread.
+     */
+    static SystemRecord decode(uint8_t* smbiosTableStorage);
+
     std::shared_ptr<sdbusplus::asio::connection> bus;
 
   private:
     /** @brief Path of the group instance */
     std::string path;
 
-    uint8_t* storage;
+    SystemRecord record;
 
     struct BIOSInfo
     {
@@ -114,6 +135,9 @@ class System :
     } __attribute__((packed));
 
     std::string smbiosFilePath;
+
+    /** Owned by the MDRV2 instance, which outlives its inventory objects */
+    MapperCache& mapper;
 };
 
 } // namespace smbios
@@ -0,0 +1,141 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "cpu.hpp"
+#include "dimm.hpp"
+#include "firmware.hpp"
+#include "metrics.hpp"
+#include "pcieslot.hpp"
+#include "system.hpp"
+#include "tpm.hpp"
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+/** @brief Everything the inventory objects are built from, decoded from one
+ *  table. Object names that only depend on the table are resolved here too.
+ *
+ *  The containers and the temporaries of the decode are allocated from an
+ *  arena owned by the table, which is released in one step when the table is
+ *  destroyed.
+ */
+struct DecodedTable
+{
+    DecodedTable();
+    DecodedTable(DecodedTable&&) = default;
+    DecodedTable& operator=(DecodedTable&&) = delete;
+
+    struct NamedDimm
+    {
+        std::string objName;
+        DimmRecord record;
+    };
+
+    struct NamedFirmware
+    {
+        std::string objName;
+        FirmwareRecord record;
+    };
+
+    /** Declared first so that it outlives everything allocated from it */
+    std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+
+    /** Hash of the decoded table, as given to TableDecoder::submit() */
+    uint64_t hash = 0;
+    std::pmr::vector<CpuRecord> cpus;
+    std::pmr::vector<NamedDimm> dimms;
+    std::pmr::vector<PcieRecord> pcies;
+    std::optional<TpmRecord> tpm;
+    std::pmr::vector<NamedFirmware> firmware;
+    SystemRecord system;
+};
+
+/** @brief Decode a table storage without touching D-Bus.
+ *  @param metrics Receives the decode timings, if given.
+ */
+DecodedTable decodeTable(std::span<uint8_t> storage,
+                         Metrics* metrics = nullptr);
+
+/**
+ * Decodes tables on a worker thread and hands the result back to the I/O
+ * thread.
+ *
+ * Each submit() copies the table storage, so the caller may reuse it right
+ * away. Submissions made while a decode is running are coalesced and only the
+ * latest one is decoded next. The result is posted through an eventfd, so the
+ * callback always runs on the thread running the io_context.
+ */
+class TableDecoder
+{
+  public:
+    using Callback = std::function<void(const DecodedTable&)>;
+
+    TableDecoder(const TableDecoder&) = delete;
+    TableDecoder& operator=(const TableDecoder&) = delete;
+
+    TableDecoder(boost::asio::io_context& io, Callback onDecoded,
+                 Metrics* metrics = nullptr);
+
+    ~TableDecoder();
+
+    /** @brief Queue a table for decoding, replacing any queued one.
+     *  @param storage The whole table storage, the decoders may walk past
+     *                 the end of a malformed table.
+     *  @param hash Identifies the table in the decoded result.
+     */
+    void submit(std::span<const uint8_t> storage, uint64_t hash);
+
+  private:
+    void run();
+    void readNotify();
+
+    boost::asio::posix::stream_descriptor notifyDescriptor;
+    Callback onDecoded;
+    Metrics* metrics;
+    uint64_t notifyValue = 0;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::unique_ptr<std::vector<uint8_t>> pending;
+    uint64_t pendingHash = 0;
+    std::unique_ptr<DecodedTable> decoded;
+    bool stopping = false;
+
+    std::thread worker;
+};
+
+} // namespace smbios
+
+} // namespace phosphor
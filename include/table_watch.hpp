@@ -0,0 +1,80 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+#include <array>
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace phosphor
+{
+
+namespace smbios
+{
+
+static constexpr std::chrono::milliseconds tableWatchDebounce{500};
+
+/**
+ * Watches a table file for writers that do not go through D-Bus.
+ *
+ * The parent directory is watched with inotify for IN_CLOSE_WRITE and
+ * IN_MOVED_TO on the file, which covers both in place writes and the atomic
+ * rename used by smbios_persist. Bursts of events are debounced into a single
+ * callback.
+ */
+class TableWatch
+{
+  public:
+    TableWatch(const TableWatch&) = delete;
+    TableWatch& operator=(const TableWatch&) = delete;
+
+    /**
+     * @param io I/O context to run the watch on.
+     * @param path Table file to watch.
+     * @param onChange Called once the file has been quiet for the debounce
+     *                 period after a change.
+     */
+    TableWatch(boost::asio::io_context& io, const std::string& path,
+               std::function<void()> onChange);
+
+    ~TableWatch();
+
+    /** @return false if the inotify watch could not be set up */
+    bool active() const
+    {
+        return watchDescriptor.is_open();
+    }
+
+  private:
+    void readEvents();
+    void handleEvents(size_t length);
+
+    boost::asio::posix::stream_descriptor watchDescriptor;
+    boost::asio::steady_timer debounceTimer;
+    std::string fileName;
+    std::function<void()> onChange;
+    alignas(8) std::array<char, 4096> eventBuffer;
+};
+
+} // namespace smbios
+
+} // namespace phosphor
@@ -23,21 +23,36 @@
 #include <xyz/openbmc_project/Inventory/Item/server.hpp>
 #include <xyz/openbmc_project/Software/Version/server.hpp>
 
+#include <optional>
+#include <string>
+
 namespace phosphor
 {
 
 namespace smbios
 {
 
-using tpmIntf = sdbusplus::server::object_t<
-    sdbusplus::xyz::openbmc_project::Inventory::Item::server::Tpm>;
-using assetIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset>;
-using itemIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::inventory::Item>;
-using softwareversionIntf = sdbusplus::server::object_t<
-    sdbusplus::server::xyz::openbmc_project::software::Version>;
-class Tpm : tpmIntf, assetIntf, itemIntf, softwareversionIntf
+using tpmIntf = sdbusplus::xyz::openbmc_project::Inventory::Item::server::Tpm;
+using assetIntf =
+    sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset;
+using itemIntf = sdbusplus::server::xyz::openbmc_project::inventory::Item;
+using softwareversionIntf =
+    sdbusplus::server::xyz::openbmc_project::software::Version;
+
+/** @brief Decoded SMBIOS type-43 TPM device, as published by Tpm */
+struct TpmRecord
+{
+    std::string manufacturer;
+    std::string version;
+    std::string prettyName;
+
+    bool operator==(const TpmRecord&) const = default;
+};
+
+using TpmObject = sdbusplus::server::object_t<tpmIntf, assetIntf, itemIntf,
+                                              softwareversionIntf>;
+
+class Tpm : TpmObject
 {
   public:
     Tpm() = delete;
@@ -48,22 +63,24 @@ class Tpm : tpmIntf, assetIntf, itemIntf, softwareversionIntf
     Tpm& operator=(Tpm&&) = default;
 
     Tpm(std::shared_ptr<sdbusplus::asio::connection> bus,
-        const std::string& objPath, uint8_t* smbiosTableStorage) :
-        tpmIntf(*bus, objPath.c_str()),
-        assetIntf(*bus, objPath.c_str()), itemIntf(*bus, objPath.c_str()),
-        softwareversionIntf(*bus, objPath.c_str()), path(objPath),
-        storage(smbiosTableStorage)
+        const std::string& objPath, const TpmRecord& record) :
+        TpmObject(*bus, objPath.c_str(), action::defer_emit), path(objPath)
     {
-        tpmInfoUpdate();
+        tpmInfoUpdate(record);
+        emit_object_added();
     }
 
-    void tpmInfoUpdate(void);
+    /** @brief Decode the TPM device of a table, if it has one.
+     *  Only reads the table, so it can run off the D-Bus thread.
+     */
+    static std::optional<TpmRecord> decode(uint8_t* smbiosTableStorage);
+
+    void tpmInfoUpdate(const TpmRecord& record);
 
   private:
     /** @brief Path of the group instance */
     std::string path;
 
-    uint8_t* storage;
     struct TPMInfo
     {
         uint8_t type;
@@ -93,10 +110,8 @@ class Tpm : tpmIntf, assetIntf, itemIntf, softwareversionIntf
         uint16_t revMajor;
     } __attribute__((packed));
 
-    void tpmVendor(const struct TPMInfo* tpmInfo);
-    void tpmFirmwareVersion(const struct TPMInfo* tpmInfo);
-    void tpmDescription(const uint8_t positionNum, const uint8_t structLen,
-                        uint8_t* dataIn);
+    static std::string tpmVendor(const struct TPMInfo* tpmInfo);
+    static std::string tpmFirmwareVersion(const struct TPMInfo* tpmInfo);
 };
 
 } // namespace smbios
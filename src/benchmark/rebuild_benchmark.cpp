@@ -0,0 +1,496 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Measures the publication of generated tables of several sizes, from
+ * AgentSynchronizeData to the inventory being on the bus.
+ *
+ * Everything runs on a private dbus-daemon, given as the only argument:
+ * - a mock service answers the ObjectMapper calls of MDRV2 and hosts the
+ *   inventory anchor and the bios_active version object. It also counts the
+ *   messages on the bus through a monitor connection.
+ * - each table size is measured in a fresh process, so that its peak RSS
+ *   is its own.
+ *
+ * For every size, the initial publication (every object is created) and a
+ * resynchronization of the same table (every object is kept) are reported.
+ * The fixed deferral of the rebuild after AgentSynchronizeData is not
+ * included in the wall time. Syscalls are the read and write calls counted
+ * in /proc/self/io.
+ */
+
+#include "mdrv2.hpp"
+
+#include "../test/private_bus.hpp"
+#include "../test/table_builder.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <systemd/sd-bus.h>
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace phosphor::smbios;
+using namespace phosphor::smbios::test;
+
+static constexpr const char* mockServiceName =
+    "xyz.openbmc_project.Benchmark.Inventory";
+static constexpr const char* monitorPath = "/xyz/openbmc_project/benchmark";
+static constexpr const char* monitorInterface =
+    "xyz.openbmc_project.Benchmark.Monitor";
+static constexpr const char* anchorPath =
+    "/xyz/openbmc_project/inventory/system/board/Benchmark_Board";
+static constexpr const char* biosActivePath =
+    "/xyz/openbmc_project/software/bios_active";
+
+struct TableShape
+{
+    size_t cpus;
+    size_t dimms;
+    size_t slots;
+    size_t firmware;
+};
+
+// The largest one is bounded by the 255 DIMMs the daemon publishes
+static const std::vector<TableShape> tableShapes = {
+    {2, 16, 8, 4},
+    {4, 64, 16, 16},
+    {8, 255, 32, 32},
+};
+
+static std::vector<uint8_t> generateTable(const TableShape& shape)
+{
+    TableBuilder builder;
+
+    std::vector<uint8_t> bios(0x18, 0);
+    bios[4] = 1; // vendor
+    bios[5] = 2; // version
+    builder.add(biosType, bios, {"Benchmark", "1.0.0"});
+
+    std::vector<uint8_t> system(0x1b, 0);
+    for (size_t index = 0; index < 16; index++)
+    {
+        system[8 + index] = static_cast<uint8_t>(index);
+    }
+    builder.add(systemType, system, {});
+
+    for (size_t index = 0; index < shape.cpus; index++)
+    {
+        std::vector<uint8_t> cpu(0x30, 0);
+        cpu[4] = 1;    // socket designation
+        cpu[5] = 3;    // central processor
+        cpu[6] = 0xb3; // Xeon
+        cpu[7] = 2;    // manufacturer
+        cpu[0x10] = 3; // version
+        cpu[0x18] = 0x41;
+        cpu[0x20] = 4; // serial number
+        cpu[0x23] = 56;
+        cpu[0x25] = 112;
+        builder.add(processorsType, cpu,
+                    {"CPU" + std::to_string(index), "Intel", "Xeon",
+                     "SN" + std::to_string(index)});
+    }
+
+    std::vector<uint8_t> array(0x17, 0);
+    array[6] = 6; // multi-bit ECC
+    uint16_t arrayHandle = builder.add(physicalMemoryArrayType, array, {});
+
+    for (size_t index = 0; index < shape.dimms; index++)
+    {
+        std::vector<uint8_t> dimm(0x28, 0);
+        std::memcpy(&dimm[4], &arrayHandle, sizeof(arrayHandle));
+        dimm[0x0d] = 0x40; // 16 GiB
+        dimm[0x10] = 1;    // device locator
+        dimm[0x11] = 2;    // bank locator
+        dimm[0x12] = 0x22; // DDR5
+        dimm[0x17] = 3;    // manufacturer
+        dimm[0x18] = 4;    // serial number
+        dimm[0x1a] = 5;    // part number
+        builder.add(memoryDeviceType, dimm,
+                    {"DIMM_" + std::to_string(index),
+                     "BANK " + std::to_string(index % 8), "Benchmark",
+                     "SN" + std::to_string(index), "PN-DIMM"});
+    }
+
+    for (size_t index = 0; index < shape.slots; index++)
+    {
+        std::vector<uint8_t> slot(0x1c, 0);
+        slot[4] = 1;    // designation
+        slot[5] = 0xa5; // PCI Express
+        builder.add(systemSlots, slot, {"SLOT" + std::to_string(index)});
+    }
+
+    for (size_t index = 0; index < shape.firmware; index++)
+    {
+        std::vector<uint8_t> firmware(0x18, 0);
+        firmware[4] = 1; // component name
+        firmware[5] = 2; // version
+        firmware[7] = 3; // id
+        builder.add(firmwareInventoryInformationType, firmware,
+                    {"Component" + std::to_string(index), "1.0",
+                     "fw" + std::to_string(index)});
+    }
+
+    std::vector<uint8_t> table = builder.finish();
+    if (table.size() > smbiosTableStorageSize)
+    {
+        throw std::length_error("Generated table does not fit the storage");
+    }
+    return table;
+}
+
+// Counts every message on the bus, on its own thread as a monitor connection
+// cannot be used for anything else.
+static void countMessages(std::atomic<uint64_t>& count)
+{
+    sd_bus* bus = nullptr;
+    const char* address = std::getenv("DBUS_SYSTEM_BUS_ADDRESS");
+    if (sd_bus_new(&bus) < 0 || sd_bus_set_address(bus, address) < 0 ||
+        sd_bus_set_bus_client(bus, 1) < 0 || sd_bus_set_monitor(bus, 1) < 0 ||
+        sd_bus_start(bus) < 0)
+    {
+        std::fprintf(stderr, "Failed to connect the bus monitor\n");
+        return;
+    }
+
+    sd_bus_error error = SD_BUS_ERROR_NULL;
+    if (sd_bus_call_method(bus, "org.freedesktop.DBus",
+                           "/org/freedesktop/DBus",
+                           "org.freedesktop.DBus.Monitoring", "BecomeMonitor",
+                           &error, nullptr, "asu", 0, 0U) < 0)
+    {
+        std::fprintf(stderr, "Failed to become a bus monitor: %s\n",
+                     error.message);
+        sd_bus_error_free(&error);
+        return;
+    }
+
+    while (true)
+    {
+        sd_bus_message* message = nullptr;
+        int r = sd_bus_process(bus, &message);
+        if (r < 0)
+        {
+            return;
+        }
+        if (message != nullptr)
+        {
+            count.fetch_add(1, std::memory_order_relaxed);
+            sd_bus_message_unref(message);
+            continue;
+        }
+        if (r == 0)
+        {
+            sd_bus_wait(bus, UINT64_MAX);
+        }
+    }
+}
+
+using SubTree =
+    std::map<std::string, std::map<std::string, std::vector<std::string>>>;
+
+// Stands in for the ObjectMapper and the inventory of a real system
+static int runMockServices()
+{
+    std::atomic<uint64_t> messages{0};
+    std::thread(countMessages, std::ref(messages)).detach();
+
+    boost::asio::io_context io;
+    auto connection = std::make_shared<sdbusplus::asio::connection>(io);
+    sdbusplus::asio::object_server server(connection);
+
+    auto mapper = server.add_interface(mapperPath, mapperInterface);
+    mapper->register_method("GetSubTree",
+                            [](const std::string& /* root */, int32_t,
+                               const std::vector<std::string>& interfaces) {
+        SubTree subtree;
+        for (const auto& interface : interfaces)
+        {
+            if (interface == systemInterface)
+            {
+                subtree[anchorPath][mockServiceName] = {systemInterface};
+            }
+        }
+        return subtree;
+    });
+    mapper->register_method("GetSubTreePaths",
+                            [](const std::string&, int32_t,
+                               const std::vector<std::string>&) {
+        return std::vector<std::string>{};
+    });
+    mapper->register_method("GetObject",
+                            [](const std::string& path,
+                               const std::vector<std::string>&) {
+        std::map<std::string, std::vector<std::string>> object;
+        if (path == biosActivePath)
+        {
+            object[mockServiceName] = {versionInterface};
+        }
+        return object;
+    });
+    mapper->initialize();
+
+    auto anchor = server.add_interface(anchorPath, systemInterface);
+    anchor->initialize();
+
+    auto biosActive = server.add_interface(biosActivePath, versionInterface);
+    biosActive->register_property(
+        "Version", std::string(),
+        sdbusplus::asio::PropertyPermission::readWrite);
+    biosActive->initialize();
+
+    auto monitor = server.add_interface(monitorPath, monitorInterface);
+    monitor->register_method("MessageCount", [&messages]() {
+        return messages.load(std::memory_order_relaxed);
+    });
+    monitor->initialize();
+
+    connection->request_name(mockServiceName);
+    connection->request_name(mapperBusName);
+
+    io.run();
+    return 0;
+}
+
+struct Sample
+{
+    std::chrono::steady_clock::time_point time;
+    uint64_t syscalls;
+    uint64_t messages;
+};
+
+static uint64_t ioSyscalls()
+{
+    std::ifstream io("/proc/self/io");
+    std::string key;
+    uint64_t value = 0;
+    uint64_t total = 0;
+    while (io >> key >> value)
+    {
+        if (key == "syscr:" || key == "syscw:")
+        {
+            total += value;
+        }
+    }
+    return total;
+}
+
+static uint64_t messageCount(sdbusplus::bus_t& bus)
+{
+    // Let the monitor catch up with the messages already sent
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    auto method = bus.new_method_call(mockServiceName, monitorPath,
+                                      monitorInterface, "MessageCount");
+    auto reply = bus.call(method);
+    uint64_t messages = 0;
+    reply.read(messages);
+    return messages;
+}
+
+// Before a run the messages are counted first, and after it last, so the
+// time and syscalls of the counting stay out of the run
+static Sample sampleBefore(sdbusplus::bus_t& bus)
+{
+    uint64_t messages = messageCount(bus);
+    return {std::chrono::steady_clock::now(), ioSyscalls(), messages};
+}
+
+static Sample sampleAfter(sdbusplus::bus_t& bus)
+{
+    Sample ret{std::chrono::steady_clock::now(), ioSyscalls(), 0};
+    ret.messages = messageCount(bus);
+    return ret;
+}
+
+static uint64_t rebuilds(const MDRV2& mdrv2)
+{
+    for (const auto& [name, value] : mdrv2.getCounters())
+    {
+        if (name == counterName(Counter::rebuilds))
+        {
+            return value;
+        }
+    }
+    return 0;
+}
+
+static bool waitForRebuild(boost::asio::io_context& io, const MDRV2& mdrv2,
+                           uint64_t count)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(60);
+    while (rebuilds(mdrv2) < count)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        io.run_one_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+static void report(const char* run, const TableShape& shape,
+                   size_t tableSize, const Sample& before,
+                   const Sample& after)
+{
+    // The sampling itself is a method call and its reply
+    constexpr uint64_t samplingMessages = 2;
+    auto wall = after.time - before.time -
+                std::chrono::microseconds(defaultTimeout);
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+
+    std::printf("%-8s %5zu %6zu %7zu %10.2f %9lu %9lu %10ld\n", run,
+                shape.cpus, shape.dimms, tableSize,
+                std::chrono::duration<double, std::milli>(wall).count(),
+                static_cast<unsigned long>(after.syscalls - before.syscalls),
+                static_cast<unsigned long>(after.messages - before.messages -
+                                           samplingMessages),
+                usage.ru_maxrss);
+    std::fflush(stdout);
+}
+
+static int runShape(const TableShape& shape, const std::filesystem::path& dir)
+{
+    std::vector<uint8_t> table = generateTable(shape);
+    std::filesystem::path tablePath = dir /
+                                      ("smbios2_" + std::to_string(shape.dimms));
+    if (!writeMdrFile(tablePath, table))
+    {
+        std::fprintf(stderr, "Failed to write %s\n", tablePath.c_str());
+        return 1;
+    }
+
+    auto io = std::make_shared<boost::asio::io_context>();
+    auto connection = std::make_shared<sdbusplus::asio::connection>(*io);
+    auto objServer =
+        std::make_shared<sdbusplus::asio::object_server>(connection);
+    sdbusplus::server::manager_t objManager(*connection,
+                                            "/xyz/openbmc_project/inventory");
+    connection->request_name("xyz.openbmc_project.Smbios.MDR_V2");
+
+    Sample before = sampleBefore(*connection);
+    auto mdrv2 = std::make_shared<MDRV2>(io, connection, objServer,
+                                         tablePath.string(), defaultObjectPath,
+                                         defaultInventoryPath);
+    if (!waitForRebuild(*io, *mdrv2, 1))
+    {
+        std::fprintf(stderr, "Table of %zu DIMMs was not published\n",
+                     shape.dimms);
+        return 1;
+    }
+    Sample after = sampleAfter(*connection);
+    report("initial", shape, table.size(), before, after);
+
+    before = sampleBefore(*connection);
+    mdrv2->agentSynchronizeData();
+    if (!waitForRebuild(*io, *mdrv2, 2))
+    {
+        std::fprintf(stderr, "Table of %zu DIMMs was not republished\n",
+                     shape.dimms);
+        return 1;
+    }
+    after = sampleAfter(*connection);
+    report("resync", shape, table.size(), before, after);
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "Usage: %s DBUS_DAEMON\n", argv[0]);
+        return 1;
+    }
+
+    char dirTemplate[] = "/tmp/smbios-benchmark-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr)
+    {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::filesystem::path dir(dirTemplate);
+
+    pid_t busPid = -1;
+    std::string address = startBus(argv[1], dir, busPid);
+    if (address.empty())
+    {
+        std::fprintf(stderr, "Failed to start %s\n", argv[1]);
+        std::filesystem::remove_all(dir);
+        return 1;
+    }
+    pid_t mockPid = fork();
+    if (mockPid == 0)
+    {
+        _exit(runMockServices());
+    }
+
+    int ret = 0;
+    if (mockPid < 0)
+    {
+        ret = 1;
+    }
+    else
+    {
+        std::printf("%-8s %5s %6s %7s %10s %9s %9s %10s\n", "run", "cpus",
+                    "dimms", "bytes", "wall_ms", "syscalls", "messages",
+                    "rss_kib");
+        std::fflush(stdout);
+
+        // Each size in its own process, so its peak RSS is its own
+        for (const auto& shape : tableShapes)
+        {
+            pid_t pid = fork();
+            if (pid == 0)
+            {
+                waitForName(mapperBusName);
+                _exit(runShape(shape, dir));
+            }
+            if (pid < 0 || waitChild(pid) != 0)
+            {
+                ret = 1;
+                break;
+            }
+        }
+        kill(mockPid, SIGTERM);
+        waitpid(mockPid, nullptr, 0);
+    }
+
+    kill(busPid, SIGTERM);
+    waitpid(busPid, nullptr, 0);
+    std::filesystem::remove_all(dir);
+    return ret;
+}
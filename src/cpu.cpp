@@ -18,40 +18,22 @@
 
 #include <bitset>
 #include <map>
+#include <tuple>
 
 namespace phosphor
 {
 namespace smbios
 {
 
-void Cpu::socket(const uint8_t positionNum, const uint8_t structLen,
-                 uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-
-    processor::socket(result);
-
-    location::locationCode(result);
-
-    auto [found, socket, chip] = Cpu::socketChipNumber(result);
-    if (found)
-    {
-        instance::instanceNumber(chip);
-    }
-    else
-    {
-        instance::instanceNumber(cpuNum);
-    }
-}
-
 static constexpr uint8_t processorFamily2Indicator = 0xfe;
-void Cpu::family(const uint8_t family, const uint16_t family2)
+static void decodeFamily(CpuRecord& record, const uint8_t family,
+                         const uint16_t family2)
 {
     std::map<uint8_t, const char*>::const_iterator it =
         familyTable.find(family);
     if (it == familyTable.end())
     {
-        processor::family("Unknown Processor Family");
+        record.family = "Unknown Processor Family";
     }
     else if (it->first == processorFamily2Indicator)
     {
@@ -59,70 +41,22 @@ void Cpu::family(const uint8_t family, const uint16_t family2)
             family2Table.find(family2);
         if (it2 == family2Table.end())
         {
-            processor::family("Unknown Processor Family");
+            record.family = "Unknown Processor Family";
         }
         else
         {
-            processor::family(it2->second);
-            processor::effectiveFamily(family2);
+            record.family = it2->second;
+            record.effectiveFamily = family2;
         }
     }
     else
     {
-        processor::family(it->second);
-        processor::effectiveFamily(family);
+        record.family = it->second;
+        record.effectiveFamily = family;
     }
 }
 
-void Cpu::manufacturer(const uint8_t positionNum, const uint8_t structLen,
-                       uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-
-    asset::manufacturer(result);
-}
-
-void Cpu::partNumber(const uint8_t positionNum, const uint8_t structLen,
-                     uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-
-    asset::partNumber(result);
-}
-
-void Cpu::serialNumber(const uint8_t positionNum, const uint8_t structLen,
-                       uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-
-    asset::serialNumber(result);
-}
-
-void Cpu::assetTagString(const uint8_t positionNum, const uint8_t structLen,
-                         uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-
-    assetTagType::assetTag(result);
-}
-
-void Cpu::version(const uint8_t positionNum, const uint8_t structLen,
-                  uint8_t* dataIn)
-{
-    std::string result;
-
-    result = positionToString(positionNum, structLen, dataIn);
-
-    rev::version(result);
-
-    if (IS_COPY_CPU_VERSION_TO_MODEL == true)
-    {
-        // populate the version to Model property for Redfish
-        asset::model(result);
-    }
-}
-
-void Cpu::characteristics(uint16_t value)
+static std::vector<processor::Capability> decodeCharacteristics(uint16_t value)
 {
     std::vector<processor::Capability> result;
     std::optional<processor::Capability> cap;
@@ -139,67 +73,50 @@ void Cpu::characteristics(uint16_t value)
         }
     }
 
-    processor::characteristics(result);
+    return result;
 }
 
 static constexpr uint8_t maxOldVersionCount = 0xff;
-void Cpu::infoUpdate(uint8_t* smbiosTableStorage,
-                     const std::string& motherboard)
+CpuRecord Cpu::decode(uint8_t* smbiosTableStorage, uint8_t cpuNum)
 {
-    storage = smbiosTableStorage;
-    motherboardPath = motherboard;
-
-    uint8_t* dataIn = storage;
+    CpuRecord record;
+    record.instance = cpuNum;
 
-    dataIn = getSMBIOSTypePtr(dataIn, processorsType);
+    uint8_t* dataIn = getSMBIOSTypeIndexPtr(smbiosTableStorage, processorsType,
+                                            cpuNum);
     if (dataIn == nullptr)
     {
-        return;
-    }
-
-    for (uint8_t index = 0; index < cpuNum; index++)
-    {
-        dataIn = smbiosNextPtr(dataIn);
-        if (dataIn == nullptr)
-        {
-            return;
-        }
-        dataIn = getSMBIOSTypePtr(dataIn, processorsType);
-        if (dataIn == nullptr)
-        {
-            return;
-        }
+        return record;
     }
 
     auto cpuInfo = reinterpret_cast<struct ProcessorInfo*>(dataIn);
+    record.handle = cpuInfo->handle;
 
-    socket(cpuInfo->socketDesignation, cpuInfo->length, dataIn); // offset 4h
+    record.socket = positionToString(cpuInfo->socketDesignation,
+                                     cpuInfo->length, dataIn); // offset 4h
+    std::tie(record.socketFound, record.socketNum, record.chip) =
+        Cpu::socketChipNumber(record.socket);
+    if (record.socketFound)
+    {
+        record.instance = record.chip;
+    }
 
     constexpr uint32_t socketPopulatedMask = 1 << 6;
     constexpr uint32_t statusMask = 0x07;
     if ((cpuInfo->status & socketPopulatedMask) == 0)
     {
         // Don't attempt to fill in any other details if the CPU is not present.
-        present(false);
-        functional(false);
-        return;
-    }
-    present(true);
-
-    if ((cpuInfo->status & statusMask) == 1)
-    {
-        functional(true);
-    }
-    else
-    {
-        functional(false);
+        return record;
     }
+    record.present = true;
+    record.functional = (cpuInfo->status & statusMask) == 1;
 
     // this class is for type CPU  //offset 5h
-    family(cpuInfo->family, cpuInfo->family2); // offset 6h and 28h
-    manufacturer(cpuInfo->manufacturer, cpuInfo->length,
-                 dataIn);                      // offset 7h
-    id(cpuInfo->id);                           // offset 8h
+    decodeFamily(record, cpuInfo->family,
+                 cpuInfo->family2);                 // offset 6h and 28h
+    record.manufacturer = positionToString(cpuInfo->manufacturer,
+                                           cpuInfo->length, dataIn); // offset 7h
+    record.id = cpuInfo->id;                                         // offset 8h
 
     // Step, EffectiveFamily, EffectiveModel computation for Intel processors.
     std::map<uint8_t, const char*>::const_iterator it =
@@ -225,53 +142,106 @@ void Cpu::infoUpdate(uint8_t* smbiosTableStorage,
             uint16_t cpuFamily = (cpuInfo->id & 0xf00) >> 8;
             uint16_t cpuXModel = (cpuInfo->id & 0xf0000) >> 16;
             uint16_t cpuXFamily = (cpuInfo->id & 0xff00000) >> 20;
-            step(cpuStep);
+            record.step = cpuStep;
             if (cpuFamily == 0xf)
             {
-                effectiveFamily(cpuXFamily + cpuFamily);
+                record.effectiveFamily = cpuXFamily + cpuFamily;
             }
             else
             {
-                effectiveFamily(cpuFamily);
+                record.effectiveFamily = cpuFamily;
             }
             if (cpuFamily == 0x6 || cpuFamily == 0xf)
             {
-                effectiveModel((cpuXModel << 4) | cpuModel);
+                record.effectiveModel = (cpuXModel << 4) | cpuModel;
             }
             else
             {
-                effectiveModel(cpuModel);
+                record.effectiveModel = cpuModel;
             }
         }
     }
 
-    version(cpuInfo->version, cpuInfo->length, dataIn); // offset 10h
-    maxSpeedInMhz(cpuInfo->maxSpeed);                   // offset 14h
-    serialNumber(cpuInfo->serialNum, cpuInfo->length,
-                 dataIn);                               // offset 20h
-    assetTagString(cpuInfo->assetTag, cpuInfo->length,
-                   dataIn);                             // offset 21h
-    partNumber(cpuInfo->partNum, cpuInfo->length,
-               dataIn);                                 // offset 22h
-    if (cpuInfo->coreCount < maxOldVersionCount)        // offset 23h or 2Ah
+    record.version = positionToString(cpuInfo->version, cpuInfo->length,
+                                      dataIn);           // offset 10h
+    record.maxSpeedInMhz = cpuInfo->maxSpeed;            // offset 14h
+    record.serialNumber = positionToString(cpuInfo->serialNum,
+                                           cpuInfo->length,
+                                           dataIn);      // offset 20h
+    record.assetTag = positionToString(cpuInfo->assetTag, cpuInfo->length,
+                                       dataIn);          // offset 21h
+    record.partNumber = positionToString(cpuInfo->partNum, cpuInfo->length,
+                                         dataIn);        // offset 22h
+    if (cpuInfo->coreCount < maxOldVersionCount)         // offset 23h or 2Ah
     {
-        coreCount(cpuInfo->coreCount);
+        record.coreCount = cpuInfo->coreCount;
     }
     else
     {
-        coreCount(cpuInfo->coreCount2);
+        record.coreCount = cpuInfo->coreCount2;
     }
 
     if (cpuInfo->threadCount < maxOldVersionCount) // offset 25h or 2Eh)
     {
-        threadCount(cpuInfo->threadCount);
+        record.threadCount = cpuInfo->threadCount;
     }
     else
     {
-        threadCount(cpuInfo->threadCount2);
+        record.threadCount = cpuInfo->threadCount2;
     }
 
-    characteristics(cpuInfo->characteristics); // offset 26h
+    record.characteristics =
+        decodeCharacteristics(cpuInfo->characteristics); // offset 26h
+
+    return record;
+}
+
+void Cpu::infoUpdate(const CpuRecord& record, const std::string& motherboard)
+{
+    motherboardPath = motherboard;
+
+    processor::socket(record.socket, true);
+    location::locationCode(record.socket, true);
+    instance::instanceNumber(record.instance, true);
+
+    if (!record.present)
+    {
+        present(false, true);
+        functional(false, true);
+        return;
+    }
+    present(true, true);
+    functional(record.functional, true);
+
+    processor::family(record.family, true);
+    if (record.effectiveFamily)
+    {
+        effectiveFamily(*record.effectiveFamily, true);
+    }
+    if (record.effectiveModel)
+    {
+        effectiveModel(*record.effectiveModel, true);
+    }
+    if (record.step)
+    {
+        step(*record.step, true);
+    }
+    asset::manufacturer(record.manufacturer, true);
+    id(record.id, true);
+
+    rev::version(record.version, true);
+    if (IS_COPY_CPU_VERSION_TO_MODEL == true)
+    {
+        // populate the version to Model property for Redfish
+        asset::model(record.version, true);
+    }
+    maxSpeedInMhz(record.maxSpeedInMhz, true);
+    asset::serialNumber(record.serialNumber, true);
+    assetTagType::assetTag(record.assetTag, true);
+    asset::partNumber(record.partNumber, true);
+    coreCount(record.coreCount, true);
+    threadCount(record.threadCount, true);
+    processor::characteristics(record.characteristics, true);
 
     if (!motherboardPath.empty())
     {
@@ -282,7 +252,7 @@ void Cpu::infoUpdate(uint8_t* smbiosTableStorage,
 #else
         assocs.emplace_back("parent_chassis", "all_processors", objPath);
 #endif
-        association::associations(assocs);
+        association::associations(assocs, true);
     }
 }
 
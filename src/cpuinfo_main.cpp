@@ -26,6 +26,7 @@
 #include <boost/asio/steady_timer.hpp>
 #include <boost/container/flat_map.hpp>
 
+#include <cstdlib>
 #include <iostream>
 #include <list>
 #include <optional>
@@ -39,11 +40,17 @@ extern "C"
 }
 
 #if PECI_ENABLED
+#include "peci_metrics.hpp"
+#include "peci_transport.hpp"
 #include "speed_select.hpp"
 
 #include <peci.h>
 #endif
 
+#if PECI_SIM
+#include "peci_sim.hpp"
+#endif
+
 #include <phosphor-logging/log.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
@@ -381,7 +388,8 @@ static void getPPIN(boost::asio::io_service& io,
     // Wait for POST to complete to ensure that BIOS has time to enable the
     // PPIN. Before BIOS enables it, we would get a 0x90 CC on PECI.
     if (hostState != HostState::postComplete ||
-        peci_GetCPUID(cpuAddr, &model, &stepping, &cc) != PECI_CC_SUCCESS)
+        peci::getTransport().getCPUID(cpuAddr, &model, &stepping, &cc) !=
+            PECI_CC_SUCCESS)
     {
         // Start the PECI check loop
         auto waitTimer = std::make_shared<boost::asio::steady_timer>(io);
@@ -425,9 +433,9 @@ static void getPPIN(boost::asio::io_service& io,
             uint64_t cpuPPIN = 0;
             uint32_t u32PkgValue = 0;
 
-            int ret = peci_RdPkgConfig(cpuAddr, u8PPINPkgIndex,
-                                       u16PPINPkgParamLow, u8Size,
-                                       (uint8_t*)&u32PkgValue, &cc);
+            int ret = peci::getTransport().rdPkgConfig(
+                cpuAddr, u8PPINPkgIndex, u16PPINPkgParamLow, u8Size,
+                (uint8_t*)&u32PkgValue, &cc);
             if (0 != ret)
             {
                 phosphor::logging::log<phosphor::logging::level::ERR>(
@@ -439,8 +447,9 @@ static void getPPIN(boost::asio::io_service& io,
             }
 
             cpuPPIN = u32PkgValue;
-            ret = peci_RdPkgConfig(cpuAddr, u8PPINPkgIndex, u16PPINPkgParamHigh,
-                                   u8Size, (uint8_t*)&u32PkgValue, &cc);
+            ret = peci::getTransport().rdPkgConfig(
+                cpuAddr, u8PPINPkgIndex, u16PPINPkgParamHigh, u8Size,
+                (uint8_t*)&u32PkgValue, &cc);
             if (0 != ret)
             {
                 phosphor::logging::log<phosphor::logging::level::ERR>(
@@ -649,6 +658,25 @@ static void getCpuConfiguration(
 
 int main()
 {
+#if PECI_SIM
+    // Talk to simulated CPUs instead of the PECI driver, for development and
+    // benchmarking on machines without Xeon CPUs.
+    if (const char* spec = std::getenv("CPUINFO_PECI_SIM"))
+    {
+        std::optional<cpu_info::peci::SimConfig> simConfig =
+            cpu_info::peci::parseSimSpec(spec);
+        if (!simConfig)
+        {
+            return 1;
+        }
+        std::cerr << "Using " << simConfig->sockets.size()
+                  << " simulated PECI CPUs\n";
+        cpu_info::peci::setTransport(
+            std::make_unique<cpu_info::peci::SimulatedTransport>(
+                std::move(*simConfig)));
+    }
+#endif
+
     // setup connection to dbus
     boost::asio::io_service& io = cpu_info::dbus::getIOContext();
     std::shared_ptr<sdbusplus::asio::connection> conn =
@@ -665,7 +693,8 @@ int main()
     cpu_info::hostStateSetup(conn);
 
 #if PECI_ENABLED
-    cpu_info::sst::init();
+    cpu_info::peci::registerMetrics(server);
+    cpu_info::sst::init(server);
 #endif
 
     // shared_ptr conn is global for the service
@@ -17,6 +17,7 @@
 #include "dimm.hpp"
 
 #include "mdrv2.hpp"
+#include "smbios_graph.hpp"
 
 #include <boost/algorithm/string.hpp>
 #include <phosphor-logging/elog-errors.hpp>
@@ -37,184 +38,59 @@ bool onlyDimmLocationCode = false;
 using DeviceType =
     sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::DeviceType;
 
+using DimmIntf = sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm;
+using MemoryLocationIntf =
+    sdbusplus::server::xyz::openbmc_project::inventory::item::dimm::
+        MemoryLocation;
+using AssetIntf =
+    sdbusplus::server::xyz::openbmc_project::inventory::decorator::Asset;
+using LocationCodeIntf =
+    sdbusplus::server::xyz::openbmc_project::inventory::decorator::LocationCode;
+using ItemIntf = sdbusplus::server::xyz::openbmc_project::inventory::Item;
+using StatusIntf = sdbusplus::server::xyz::openbmc_project::state::decorator::
+    OperationalStatus;
+
 using EccType =
     sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::Ecc;
 
 static constexpr uint16_t maxOldDimmSize = 0x7fff;
-void Dimm::memoryInfoUpdate(uint8_t* smbiosTableStorage,
-                            const std::string& motherboard)
-{
-    storage = smbiosTableStorage;
-    motherboardPath = motherboard;
-
-    uint8_t* dataIn = storage;
-
-    dataIn = getSMBIOSTypePtr(dataIn, memoryDeviceType);
-
-    if (dataIn == nullptr)
-    {
-        return;
-    }
-    for (uint8_t index = 0; index < dimmNum; index++)
-    {
-        dataIn = smbiosNextPtr(dataIn);
-        if (dataIn == nullptr)
-        {
-            return;
-        }
-        dataIn = getSMBIOSTypePtr(dataIn, memoryDeviceType);
-        if (dataIn == nullptr)
-        {
-            return;
-        }
-    }
-
-    auto memoryInfo = reinterpret_cast<struct MemoryInfo*>(dataIn);
-
-    memoryTotalWidth(memoryInfo->totalWidth);
-    memoryDataWidth(memoryInfo->dataWidth);
-    memoryTotalWidth(memoryInfo->totalWidth);
-
-    if (memoryInfo->size == maxOldDimmSize)
-    {
-        dimmSizeExt(memoryInfo->extendedSize);
-    }
-    else
-    {
-        dimmSize(memoryInfo->size);
-    }
-    // If the size is 0, no memory device is installed in the socket.
-    const auto isDimmPresent = memoryInfo->size > 0;
-    present(isDimmPresent);
-    functional(isDimmPresent);
-
-    dimmDeviceLocator(memoryInfo->bankLocator, memoryInfo->deviceLocator,
-                      memoryInfo->length, dataIn);
-    dimmType(memoryInfo->memoryType);
-    dimmTypeDetail(memoryInfo->typeDetail);
-    maxMemorySpeedInMhz(memoryInfo->speed);
-    dimmManufacturer(memoryInfo->manufacturer, memoryInfo->length, dataIn);
-    dimmSerialNum(memoryInfo->serialNum, memoryInfo->length, dataIn);
-    dimmPartNum(memoryInfo->partNum, memoryInfo->length, dataIn);
-    memoryAttributes(memoryInfo->attributes);
-    dimmMedia(memoryInfo->memoryTechnology);
-    memoryConfiguredSpeedInMhz(memoryInfo->confClockSpeed);
-
-    updateEccType(memoryInfo->phyArrayHandle);
-
-    if (!motherboardPath.empty())
-    {
-        std::vector<std::tuple<std::string, std::string, std::string>> assocs;
-        assocs.emplace_back("chassis", "memories", motherboardPath);
-        association::associations(assocs);
-    }
-
-    return;
-}
-
-void Dimm::updateEccType(uint16_t exPhyArrayHandle)
-{
-    uint8_t* dataIn = storage;
-
-    while (dataIn != nullptr)
-    {
-        dataIn = getSMBIOSTypePtr(dataIn, physicalMemoryArrayType);
-        if (dataIn == nullptr)
-        {
-            phosphor::logging::log<phosphor::logging::level::ERR>(
-                "Failed to get SMBIOS table type-16 data.");
-            return;
-        }
-
-        auto info = reinterpret_cast<struct PhysicalMemoryArrayInfo*>(dataIn);
-        if (info->handle == exPhyArrayHandle)
-        {
-            std::map<uint8_t, EccType>::const_iterator it =
-                dimmEccTypeMap.find(info->memoryErrorCorrection);
-            if (it == dimmEccTypeMap.end())
-            {
-                ecc(EccType::NoECC);
-            }
-            else
-            {
-                ecc(it->second);
-            }
-            return;
-        }
-
-        dataIn = smbiosNextPtr(dataIn);
-    }
-    phosphor::logging::log<phosphor::logging::level::ERR>(
-        "Failed find the corresponding SMBIOS table type-16 data for dimm:",
-        phosphor::logging::entry("DIMM:%d", dimmNum));
-}
-
-EccType Dimm::ecc(EccType value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::ecc(
-        value);
-}
-
-uint16_t Dimm::memoryTotalWidth(uint16_t value)
-{
-    return sdbusplus::xyz::openbmc_project::Inventory::Item::server::Dimm::
-        memoryTotalWidth(value);
-}
-
-uint16_t Dimm::memoryDataWidth(uint16_t value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        memoryDataWidth(value);
-}
-
 static constexpr uint16_t baseNewVersionDimmSize = 0x8000;
 static constexpr uint16_t dimmSizeUnit = 1024;
-void Dimm::dimmSize(const uint16_t size)
+
+static size_t dimmSize(const uint16_t size)
 {
     uint32_t result = size & maxOldDimmSize;
     if (0 == (size & baseNewVersionDimmSize))
     {
         result = result * dimmSizeUnit;
     }
-    memorySizeInKB(result);
+    return result;
 }
 
-void Dimm::dimmSizeExt(uint32_t size)
+static size_t dimmSizeExt(uint32_t size)
 {
-    size = size * dimmSizeUnit;
-    memorySizeInKB(size);
-}
-
-size_t Dimm::memorySizeInKB(size_t value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        memorySizeInKB(value);
+    return size * dimmSizeUnit;
 }
 
-void Dimm::dimmDeviceLocator(const uint8_t bankLocatorPositionNum,
-                             const uint8_t deviceLocatorPositionNum,
-                             const uint8_t structLen, uint8_t* dataIn)
+static void dimmDeviceLocator(DimmRecord& record,
+                              const uint8_t bankLocatorPositionNum,
+                              const uint8_t deviceLocatorPositionNum,
+                              const uint8_t structLen, uint8_t* dataIn)
 {
     std::string deviceLocator = positionToString(deviceLocatorPositionNum,
                                                  structLen, dataIn);
     std::string bankLocator = positionToString(bankLocatorPositionNum,
                                                structLen, dataIn);
 
-    std::string result;
     if (bankLocator.empty() || onlyDimmLocationCode)
     {
-        result = deviceLocator;
+        record.deviceLocator = deviceLocator;
     }
     else
     {
-        result = bankLocator + " " + deviceLocator;
+        record.deviceLocator = bankLocator + " " + deviceLocator;
     }
 
-    memoryDeviceLocator(result);
-
-#ifdef DIMM_LOCATION_CODE
-    locationCode(result);
-#endif
     const std::string substrCpu = "CPU";
     auto cpuPos = deviceLocator.find(substrCpu);
 
@@ -224,11 +100,9 @@ void Dimm::dimmDeviceLocator(const uint8_t bankLocatorPositionNum,
             deviceLocator.substr(cpuPos + substrCpu.length(), 1);
         try
         {
-            uint8_t socketNum =
-                static_cast<uint8_t>(std::stoi(socketString) + 1);
-            socket(socketNum);
+            record.socket = static_cast<uint8_t>(std::stoi(socketString) + 1);
         }
-        catch (const sdbusplus::exception_t& ex)
+        catch (const std::exception& ex)
         {
             phosphor::logging::log<phosphor::logging::level::ERR>(
                 "std::stoi operation failed ",
@@ -239,7 +113,8 @@ void Dimm::dimmDeviceLocator(const uint8_t bankLocatorPositionNum,
     const std::string substrDimm = "DIMM";
     auto dimmPos = deviceLocator.find(substrDimm);
 
-    if (dimmPos != std::string::npos)
+    if (dimmPos != std::string::npos &&
+        dimmPos + substrDimm.length() < deviceLocator.length())
     {
         std::string slotString =
             deviceLocator.substr(dimmPos + substrDimm.length() + 1);
@@ -249,57 +124,33 @@ void Dimm::dimmDeviceLocator(const uint8_t bankLocatorPositionNum,
         if ((std::regex_match(slotString, std::regex("^[A-Za-z]+$"))) &&
             (slotString.length() == 1))
         {
-            slot(static_cast<uint8_t>(toupper(slotString[0])));
+            record.slot = static_cast<uint8_t>(toupper(slotString[0]));
         }
     }
 }
 
-std::string Dimm::memoryDeviceLocator(std::string value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        memoryDeviceLocator(value);
-}
-
-void Dimm::dimmType(const uint8_t type)
+static DeviceType dimmType(const uint8_t type)
 {
     std::map<uint8_t, DeviceType>::const_iterator it = dimmTypeTable.find(type);
     if (it == dimmTypeTable.end())
     {
-        memoryType(DeviceType::Unknown);
-    }
-    else
-    {
-        memoryType(it->second);
+        return DeviceType::Unknown;
     }
+    return it->second;
 }
 
-DeviceType Dimm::memoryType(DeviceType value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        memoryType(value);
-}
-
-void Dimm::dimmMedia(const uint8_t type)
+static MemoryTechType dimmMedia(const uint8_t type)
 {
     std::map<uint8_t, MemoryTechType>::const_iterator it =
         dimmMemoryTechTypeMap.find(type);
     if (it == dimmMemoryTechTypeMap.end())
     {
-        memoryMedia(MemoryTechType::Unknown);
-    }
-    else
-    {
-        memoryMedia(it->second);
+        return MemoryTechType::Unknown;
     }
+    return it->second;
 }
 
-MemoryTechType Dimm::memoryMedia(MemoryTechType value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        memoryMedia(value);
-}
-
-void Dimm::dimmTypeDetail(uint16_t detail)
+static std::string dimmTypeDetail(uint16_t detail)
 {
     std::string result;
     for (uint8_t index = 0; index < (8 * sizeof(detail)); index++)
@@ -310,23 +161,11 @@ void Dimm::dimmTypeDetail(uint16_t detail)
         }
         detail >>= 1;
     }
-    memoryTypeDetail(result);
+    return result;
 }
 
-std::string Dimm::memoryTypeDetail(std::string value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        memoryTypeDetail(value);
-}
-
-uint16_t Dimm::maxMemorySpeedInMhz(uint16_t value)
-{
-    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
-        maxMemorySpeedInMhz(value);
-}
-
-void Dimm::dimmManufacturer(const uint8_t positionNum, const uint8_t structLen,
-                            uint8_t* dataIn)
+static std::string dimmManufacturer(const uint8_t positionNum,
+                                    const uint8_t structLen, uint8_t* dataIn)
 {
     std::string result = positionToString(positionNum, structLen, dataIn);
 
@@ -337,44 +176,210 @@ void Dimm::dimmManufacturer(const uint8_t positionNum, const uint8_t structLen,
         // present).
         result = "";
     }
-    manufacturer(result);
+    return result;
 }
 
-std::string Dimm::manufacturer(std::string value)
+static std::string dimmPartNum(const uint8_t positionNum,
+                               const uint8_t structLen, uint8_t* dataIn)
 {
-    return sdbusplus::server::xyz::openbmc_project::inventory::decorator::
-        Asset::manufacturer(value);
+    std::string result = positionToString(positionNum, structLen, dataIn);
+
+    // Part number could contain spaces at the end. Eg: "abcd123  ". Since its
+    // unnecessary, we should remove them.
+    boost::algorithm::trim_right(result);
+    return result;
 }
 
-bool Dimm::present(bool value)
+static std::optional<EccType> dimmEccType(const HandleGraph& graph,
+                                          uint16_t deviceHandle,
+                                          uint8_t dimmNum)
 {
-    return sdbusplus::server::xyz::openbmc_project::inventory::Item::present(
+    auto arrayHandle = graph.memoryArray(deviceHandle);
+    if (!arrayHandle)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Failed find the corresponding SMBIOS table type-16 data for dimm:",
+            phosphor::logging::entry("DIMM:%d", dimmNum));
+        return std::nullopt;
+    }
+
+    auto info = reinterpret_cast<struct PhysicalMemoryArrayInfo*>(
+        graph.structure(*arrayHandle));
+    std::map<uint8_t, EccType>::const_iterator it =
+        dimmEccTypeMap.find(info->memoryErrorCorrection);
+    if (it == dimmEccTypeMap.end())
+    {
+        return EccType::NoECC;
+    }
+    return it->second;
+}
+
+DimmRecord Dimm::decode(uint8_t* smbiosTableStorage,
+                        const HandleGraph& graph, uint8_t dimmNum)
+{
+    DimmRecord record;
+
+    uint8_t* dataIn = getSMBIOSTypeIndexPtr(smbiosTableStorage,
+                                            memoryDeviceType, dimmNum);
+    if (dataIn == nullptr)
+    {
+        return record;
+    }
+
+    auto memoryInfo = reinterpret_cast<struct MemoryInfo*>(dataIn);
+
+    record.handle = memoryInfo->handle;
+    record.totalWidth = memoryInfo->totalWidth;
+    record.dataWidth = memoryInfo->dataWidth;
+
+    if (memoryInfo->size == maxOldDimmSize)
+    {
+        record.sizeInKB = dimmSizeExt(memoryInfo->extendedSize);
+    }
+    else
+    {
+        record.sizeInKB = dimmSize(memoryInfo->size);
+    }
+    // If the size is 0, no memory device is installed in the socket.
+    record.present = memoryInfo->size > 0;
+
+    dimmDeviceLocator(record, memoryInfo->bankLocator,
+                      memoryInfo->deviceLocator, memoryInfo->length, dataIn);
+    record.type = dimmType(memoryInfo->memoryType);
+    record.typeDetail = dimmTypeDetail(memoryInfo->typeDetail);
+    record.maxSpeedInMhz = memoryInfo->speed;
+    record.manufacturer = dimmManufacturer(memoryInfo->manufacturer,
+                                           memoryInfo->length, dataIn);
+    record.serialNumber = positionToString(memoryInfo->serialNum,
+                                           memoryInfo->length, dataIn);
+    record.partNumber = dimmPartNum(memoryInfo->partNum, memoryInfo->length,
+                                    dataIn);
+    record.attributes = memoryInfo->attributes;
+    record.media = dimmMedia(memoryInfo->memoryTechnology);
+    record.configuredSpeedInMhz = memoryInfo->confClockSpeed;
+    record.ecc = dimmEccType(graph, memoryInfo->handle, dimmNum);
+
+    return record;
+}
+
+void Dimm::memoryInfoUpdate(const DimmRecord& record,
+                            const std::string& motherboard)
+{
+    motherboardPath = motherboard;
+
+    // Set before the object is announced, the values go out with
+    // InterfacesAdded rather than as PropertiesChanged signals.
+    DimmIntf::memoryTotalWidth(record.totalWidth, true);
+    DimmIntf::memoryDataWidth(record.dataWidth, true);
+    DimmIntf::memorySizeInKB(record.sizeInKB, true);
+    ItemIntf::present(record.present, true);
+    StatusIntf::functional(record.present, true);
+
+    DimmIntf::memoryDeviceLocator(record.deviceLocator, true);
+#ifdef DIMM_LOCATION_CODE
+    LocationCodeIntf::locationCode(record.deviceLocator, true);
+#endif
+    if (record.socket)
+    {
+        MemoryLocationIntf::socket(*record.socket, true);
+    }
+    if (record.slot)
+    {
+        MemoryLocationIntf::slot(*record.slot, true);
+    }
+
+    DimmIntf::memoryType(record.type, true);
+    DimmIntf::maxMemorySpeedInMhz(record.maxSpeedInMhz, true);
+    DimmIntf::memoryTypeDetail(record.typeDetail, true);
+    AssetIntf::manufacturer(record.manufacturer, true);
+    AssetIntf::serialNumber(record.serialNumber, true);
+    AssetIntf::partNumber(record.partNumber, true);
+    DimmIntf::memoryAttributes(record.attributes, true);
+    DimmIntf::memoryMedia(record.media, true);
+    DimmIntf::memoryConfiguredSpeedInMhz(record.configuredSpeedInMhz, true);
+    if (record.ecc)
+    {
+        DimmIntf::ecc(*record.ecc, true);
+    }
+
+    if (!motherboardPath.empty())
+    {
+        std::vector<std::tuple<std::string, std::string, std::string>> assocs;
+        assocs.emplace_back("chassis", "memories", motherboardPath);
+        association::associations(assocs, true);
+    }
+}
+
+EccType Dimm::ecc(EccType value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::ecc(
         value);
 }
 
-void Dimm::dimmSerialNum(const uint8_t positionNum, const uint8_t structLen,
-                         uint8_t* dataIn)
+uint16_t Dimm::memoryTotalWidth(uint16_t value)
 {
-    std::string result = positionToString(positionNum, structLen, dataIn);
+    return sdbusplus::xyz::openbmc_project::Inventory::Item::server::Dimm::
+        memoryTotalWidth(value);
+}
 
-    serialNumber(result);
+uint16_t Dimm::memoryDataWidth(uint16_t value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        memoryDataWidth(value);
 }
 
-std::string Dimm::serialNumber(std::string value)
+size_t Dimm::memorySizeInKB(size_t value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        memorySizeInKB(value);
+}
+
+std::string Dimm::memoryDeviceLocator(std::string value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        memoryDeviceLocator(value);
+}
+
+DeviceType Dimm::memoryType(DeviceType value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        memoryType(value);
+}
+
+MemoryTechType Dimm::memoryMedia(MemoryTechType value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        memoryMedia(value);
+}
+
+std::string Dimm::memoryTypeDetail(std::string value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        memoryTypeDetail(value);
+}
+
+uint16_t Dimm::maxMemorySpeedInMhz(uint16_t value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::item::Dimm::
+        maxMemorySpeedInMhz(value);
+}
+
+std::string Dimm::manufacturer(std::string value)
 {
     return sdbusplus::server::xyz::openbmc_project::inventory::decorator::
-        Asset::serialNumber(value);
+        Asset::manufacturer(value);
 }
 
-void Dimm::dimmPartNum(const uint8_t positionNum, const uint8_t structLen,
-                       uint8_t* dataIn)
+bool Dimm::present(bool value)
 {
-    std::string result = positionToString(positionNum, structLen, dataIn);
+    return sdbusplus::server::xyz::openbmc_project::inventory::Item::present(
+        value);
+}
 
-    // Part number could contain spaces at the end. Eg: "abcd123  ". Since its
-    // unnecessary, we should remove them.
-    boost::algorithm::trim_right(result);
-    partNumber(result);
+std::string Dimm::serialNumber(std::string value)
+{
+    return sdbusplus::server::xyz::openbmc_project::inventory::decorator::
+        Asset::serialNumber(value);
 }
 
 std::string Dimm::partNumber(std::string value)
@@ -17,6 +17,7 @@
 #include "firmware.hpp"
 
 #include "mdrv2.hpp"
+#include "smbios_graph.hpp"
 
 #include <fstream>
 #include <iomanip>
@@ -27,40 +28,55 @@ namespace phosphor
 namespace smbios
 {
 
-void Firmware::firmwareInfoUpdate(void)
+FirmwareRecord Firmware::decode(uint8_t* smbiosTableStorage,
+                                const HandleGraph& graph, int index)
 {
-    uint8_t* dataIn = storage;
-    dataIn = getSMBIOSTypeIndexPtr(dataIn, firmwareInventoryInformationType,
-                                   index);
+    FirmwareRecord record;
+    std::tie(record.name, record.id) = getFirmwareName(smbiosTableStorage,
+                                                       graph, index);
+
+    uint8_t* dataIn = getSMBIOSTypeIndexPtr(
+        smbiosTableStorage, firmwareInventoryInformationType, index);
     if (dataIn == nullptr)
     {
-        return;
+        return record;
     }
 
     auto firmwareInfo = reinterpret_cast<struct FirmwareInfo*>(dataIn);
 
-    firmwareComponentName(firmwareInfo->componentName, firmwareInfo->length,
-                          dataIn);
+    record.version = positionToString(firmwareInfo->Version,
+                                      firmwareInfo->length, dataIn);
+    record.softwareId = positionToString(firmwareInfo->Id,
+                                         firmwareInfo->length, dataIn);
+    record.releaseDate = positionToString(firmwareInfo->releaseDate,
+                                          firmwareInfo->length, dataIn);
+    record.manufacturer = positionToString(firmwareInfo->manufacturer,
+                                           firmwareInfo->length, dataIn);
+    return record;
+}
+
+void Firmware::firmwareInfoUpdate(const FirmwareRecord& record)
+{
+    prettyName(record.name, true);
 #ifdef EXPOSE_FW_INVENTORY
-    firmwareVersion(firmwareInfo->Version, firmwareInfo->length, dataIn);
-    firmwareId(firmwareInfo->Id, firmwareInfo->length, dataIn);
+    version(record.version, true);
+    softwareId(record.softwareId, true);
 #endif
-    firmwareReleaseDate(firmwareInfo->releaseDate, firmwareInfo->length,
-                        dataIn);
-    firmwareManufacturer(firmwareInfo->manufacturer, firmwareInfo->length,
-                         dataIn);
+    buildDate(record.releaseDate, true);
+    manufacturer(record.manufacturer, true);
 
-    present(true);
+    present(true, true);
 #ifdef EXPOSE_FW_INVENTORY
-    purpose(softwareversionIntf::VersionPurpose::Other);
+    purpose(softwareversionIntf::VersionPurpose::Other, true);
 #endif
     std::vector<std::tuple<std::string, std::string, std::string>> association =
         {{"software_version", "functional", "/xyz/openbmc_project/software"}};
-    associationIntf::associations(association);
+    associationIntf::associations(association, true);
 }
 
-std::tuple<std::string, std::string> Firmware::getFirmwareName(uint8_t* dataIn,
-                                                               int targetIndex)
+std::tuple<std::string, std::string>
+    Firmware::getFirmwareName(uint8_t* dataIn, const HandleGraph& graph,
+                              int targetIndex)
 {
     std::tuple<std::string, std::string> ret;
     auto& name = std::get<0>(ret);
@@ -78,86 +94,41 @@ std::tuple<std::string, std::string> Firmware::getFirmwareName(uint8_t* dataIn,
     id = positionToString(firmwareInfo->Id, firmwareInfo->length, firmwarePtr);
 
     // append designation or location to the id
-    if (firmwareInfo->numOfAssociatedComponents > 0)
+    for (uint16_t componentHandle : graph.components(firmwareInfo->handle))
     {
-        for (int i = 0; i < firmwareInfo->numOfAssociatedComponents; i++)
+        auto component = graph.structure(componentHandle);
+        auto header = reinterpret_cast<struct StructureHeader*>(component);
+        switch (header->type)
         {
-            auto component = smbiosHandlePtr(
-                dataIn, firmwareInfo->associatedComponentHandles[i]);
-            if (component == nullptr)
-            {
-                continue;
-            }
-
-            auto header = reinterpret_cast<struct StructureHeader*>(component);
-            switch (header->type)
+            case processorsType:
+            case systemSlots:
+            case onboardDevicesExtended:
             {
-                case processorsType:
-                case systemSlots:
-                case onboardDevicesExtended:
+                auto designation = positionToString(component[4],
+                                                    header->length, component);
+                if (!designation.empty())
                 {
-                    auto designation = positionToString(
-                        component[4], header->length, component);
-                    if (!designation.empty())
-                    {
-                        id.append("_").append(designation);
-                    }
-                    break;
+                    id.append("_").append(designation);
                 }
-                case systemPowerSupply:
+                break;
+            }
+            case systemPowerSupply:
+            {
+                auto location = positionToString(component[5], header->length,
+                                                 component);
+                if (!location.empty())
                 {
-                    auto location = positionToString(component[5],
-                                                     header->length, component);
-                    if (!location.empty())
-                    {
-                        id.append("_").append(location);
-                    }
-                    break;
+                    id.append("_").append(location);
                 }
-                default:
-                    break;
+                break;
             }
+            default:
+                break;
         }
     }
 
     return ret;
 }
 
-void Firmware::firmwareComponentName(const uint8_t positionNum,
-                                     const uint8_t structLen, uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-    prettyName(result);
-}
-#ifdef EXPOSE_FW_INVENTORY
-void Firmware::firmwareVersion(const uint8_t positionNum,
-                               const uint8_t structLen, uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-    version(result);
-}
-
-void Firmware::firmwareId(const uint8_t positionNum, const uint8_t structLen,
-                          uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-    softwareId(result);
-}
-#endif
-
-void Firmware::firmwareReleaseDate(const uint8_t positionNum,
-                                   const uint8_t structLen, uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-    buildDate(result);
-}
-
-void Firmware::firmwareManufacturer(const uint8_t positionNum,
-                                    const uint8_t structLen, uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-    manufacturer(result);
-}
-
 } // namespace smbios
 } // namespace phosphor
@@ -0,0 +1,386 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "mapper_cache.hpp"
+
+#include "mdrv2.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <set>
+#include <string_view>
+#include <variant>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+static constexpr const char* processorModuleInterface =
+    "xyz.openbmc_project.Inventory.Item.ProcessorModule";
+static constexpr const char* instanceInterface =
+    "xyz.openbmc_project.Inventory.Decorator.Instance";
+static constexpr const char* resourceNotFoundError =
+    "xyz.openbmc_project.Common.Error.ResourceNotFound";
+
+MapperCache::MapperCache(sdbusplus::bus_t& bus) :
+    bus(bus),
+    interfacesAddedMatch(
+        bus, sdbusplus::bus::match::rules::interfacesAdded(),
+        [this](sdbusplus::message_t& m) {
+    // Only the interface names matter, values of other types are skipped
+    sdbusplus::message::object_path path;
+    std::map<std::string, std::map<std::string, std::variant<std::string>>>
+        interfaces;
+    try
+    {
+        m.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        clear();
+        return;
+    }
+    std::vector<std::string> names;
+    for (const auto& [name, properties] : interfaces)
+    {
+        names.push_back(name);
+    }
+    interfacesChanged(path, names);
+}),
+    interfacesRemovedMatch(
+        bus, sdbusplus::bus::match::rules::interfacesRemoved(),
+        [this](sdbusplus::message_t& m) {
+    sdbusplus::message::object_path path;
+    std::vector<std::string> interfaces;
+    try
+    {
+        m.read(path, interfaces);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        clear();
+        return;
+    }
+    interfacesChanged(path, interfaces);
+}),
+    nameOwnerChangedMatch(
+        bus, sdbusplus::bus::match::rules::nameOwnerChanged(),
+        [this](sdbusplus::message_t& m) {
+    std::string name;
+    try
+    {
+        m.read(name);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        clear();
+        return;
+    }
+    // Unique names come and go with every client, objects are owned by
+    // services with well-known names.
+    if (!name.starts_with(':'))
+    {
+        clear();
+    }
+}),
+    // The modules carry their instance numbers, which may be set after the
+    // interface was added
+    instanceChangedMatch(
+        bus,
+        sdbusplus::bus::match::rules::type::signal() +
+            sdbusplus::bus::match::rules::interface(
+                "org.freedesktop.DBus.Properties") +
+            sdbusplus::bus::match::rules::member("PropertiesChanged") +
+            sdbusplus::bus::match::rules::argN(0, instanceInterface),
+        [this](sdbusplus::message_t&) { modulesEntry.value.reset(); })
+{}
+
+void MapperCache::interfacesChanged(const std::string& path,
+                                    const std::vector<std::string>& interfaces)
+{
+    auto named = [&interfaces](const char* interface) {
+        return std::find(interfaces.begin(), interfaces.end(), interface) !=
+               interfaces.end();
+    };
+
+    if (named(systemInterface) || named(boardInterface) ||
+        named(chassisInterface))
+    {
+        motherboardEntry.value.reset();
+    }
+    if (named(processorModuleInterface) || named(instanceInterface))
+    {
+        modulesEntry.value.reset();
+    }
+    if (named(versionInterface))
+    {
+        versionPathsEntry.value.reset();
+    }
+    std::erase_if(services, [&](const auto& service) {
+        return service.first.first == path &&
+               named(service.first.second.c_str());
+    });
+}
+
+void MapperCache::clear()
+{
+    motherboardEntry.value.reset();
+    modulesEntry.value.reset();
+    versionPathsEntry.value.reset();
+    services.clear();
+}
+
+std::string MapperCache::motherboard(const std::string& ancestorPath,
+                                     const std::string& exactPath)
+{
+    std::string key = ancestorPath + "+" + exactPath;
+    if (motherboardEntry.value && motherboardEntry.key == key)
+    {
+        return *motherboardEntry.value;
+    }
+
+    std::string motherboardPath;
+    auto method = bus.new_method_call(mapperBusName, mapperPath,
+                                      mapperInterface, "GetSubTree");
+    method.append(ancestorPath);
+    method.append(0);
+
+    // If customized, also accept Board as anchor, not just System
+    std::vector<std::string> desiredInterfaces{systemInterface};
+    if (!exactPath.empty())
+    {
+        desiredInterfaces.emplace_back(boardInterface);
+    }
+    method.append(desiredInterfaces);
+
+    try
+    {
+        std::map<std::string, std::map<std::string, std::set<std::string>>>
+            subtree;
+        sdbusplus::message_t reply = bus.call(method);
+        reply.read(subtree);
+        if (subtree.size() < 1)
+        {
+            phosphor::logging::log<phosphor::logging::level::ERR>(
+                "Failed to get system motherboard dbus path.");
+        }
+
+        // Other instances may have their anchors in the same subtree
+        if (!exactPath.empty())
+        {
+            if (subtree.contains(exactPath))
+            {
+                motherboardPath = exactPath;
+            }
+        }
+        // If we found more than 1 system, select one with chassis intf
+        else if (subtree.size() > 1)
+        {
+            for (const auto& [path, services] : subtree)
+            {
+                for (const auto& [service, interfaces] : services)
+                {
+                    if (interfaces.contains(chassisInterface))
+                    {
+                        motherboardPath = path;
+                        break;
+                    }
+                }
+                if (!motherboardPath.empty())
+                {
+                    break;
+                }
+            }
+        }
+        if (motherboardPath.empty() && exactPath.empty() &&
+            subtree.size() != 0)
+        {
+            motherboardPath = subtree.begin()->first;
+        }
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error(
+            "Exception while trying to find Inventory anchor object under {P}: {E}",
+            "P", ancestorPath, "E", e.what());
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Failed to query system motherboard",
+            phosphor::logging::entry("ERROR=%s", e.what()));
+        return motherboardPath;
+    }
+
+    motherboardEntry.key = std::move(key);
+    motherboardEntry.value = motherboardPath;
+    return motherboardPath;
+}
+
+MapperCache::Modules MapperCache::processorModules()
+{
+    if (modulesEntry.value)
+    {
+        return *modulesEntry.value;
+    }
+
+    Modules modules;
+    std::vector<std::pair<
+        std::string,
+        std::vector<std::pair<std::string, std::vector<std::string>>>>>
+        response;
+    sdbusplus::message_t findProcModuleMethod = bus.new_method_call(
+        mapperBusName, mapperPath, mapperInterface, "GetSubTree");
+    findProcModuleMethod.append("/xyz/openbmc_project/inventory", 0,
+                                std::array<const char*, 1>{
+                                    processorModuleInterface});
+    try
+    {
+        sdbusplus::message_t reply = bus.call(findProcModuleMethod);
+        reply.read(response);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Failed to query ProcessorModule",
+            phosphor::logging::entry("ERROR=%s", e.what()));
+        return modules;
+    }
+
+    bool complete = true;
+    for (auto& [path, services] : response)
+    {
+        // instert the path with a empty instance number first
+        modules.push_back({path, {}});
+        for (auto& [service, interfaces] : services)
+        {
+            for (auto& interface : interfaces)
+            {
+                if (interface == instanceInterface)
+                {
+                    std::variant<uint64_t> instanceNumber;
+                    sdbusplus::message_t getInstanceMethod =
+                        bus.new_method_call(service.c_str(), path.c_str(),
+                                            "org.freedesktop.DBus.Properties",
+                                            "Get");
+                    getInstanceMethod.append(interface, "InstanceNumber");
+                    try
+                    {
+                        sdbusplus::message_t reply =
+                            bus.call(getInstanceMethod);
+                        reply.read(instanceNumber);
+                        // Update the instance number
+                        modules.back().second =
+                            std::get<uint64_t>(instanceNumber);
+                    }
+                    catch (const sdbusplus::exception_t& e)
+                    {
+                        phosphor::logging::log<phosphor::logging::level::ERR>(
+                            "Failed to query instanceNumber",
+                            phosphor::logging::entry("ERROR=%s", e.what()));
+                        complete = false;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (complete)
+    {
+        modulesEntry.value = modules;
+    }
+    return modules;
+}
+
+std::vector<std::string> MapperCache::versionPaths(const std::string& root)
+{
+    if (versionPathsEntry.value && versionPathsEntry.key == root)
+    {
+        return *versionPathsEntry.value;
+    }
+
+    std::vector<std::string> paths;
+    auto getVersionPaths = bus.new_method_call(
+        mapperBusName, mapperPath, mapperInterface, "GetSubTreePaths");
+    getVersionPaths.append(root);
+    getVersionPaths.append(0);
+    getVersionPaths.append(std::array<std::string, 1>({versionInterface}));
+    try
+    {
+        sdbusplus::message_t reply = bus.call(getVersionPaths);
+        reply.read(paths);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Failed to query version objects. ERROR={ERROR}", "ERROR",
+                   e.what());
+        return {};
+    }
+
+    versionPathsEntry.key = root;
+    versionPathsEntry.value = paths;
+    return paths;
+}
+
+std::string MapperCache::service(const std::string& path,
+                                 const std::string& interface)
+{
+    auto key = std::make_pair(path, interface);
+    auto cached = services.find(key);
+    if (cached != services.end())
+    {
+        return cached->second;
+    }
+
+    auto method = bus.new_method_call(mapperBusName, mapperPath,
+                                      mapperInterface, "GetObject");
+    method.append(path);
+    method.append(std::vector<std::string>({interface}));
+
+    std::vector<std::pair<std::string, std::vector<std::string>>> response;
+    try
+    {
+        auto reply = bus.call(method);
+        reply.read(response);
+    }
+    catch (const sdbusplus::exception_t& e)
+    {
+        lg2::error("Error in mapper method call - {ERROR}, PATH - {PATH}, "
+                   "INTERFACE - {INTERFACE}",
+                   "ERROR", e.what(), "PATH", path.c_str(), "INTERFACE",
+                   interface.c_str());
+
+        // A missing object is remembered until it shows up
+        const char* name = e.name();
+        if (name != nullptr && std::string_view(name) == resourceNotFoundError)
+        {
+            services.emplace(std::move(key), std::string{});
+        }
+        return std::string{};
+    }
+
+    std::string service;
+    if (!response.empty())
+    {
+        service = response[0].first;
+    }
+    services.emplace(std::move(key), service);
+    return service;
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -25,6 +25,7 @@
 #include <xyz/openbmc_project/Smbios/MDR_V2/error.hpp>
 
 #include <fstream>
+#include <span>
 
 namespace phosphor
 {
@@ -202,7 +203,8 @@ std::vector<uint8_t> MDRV2::getDataInformation(uint8_t idIndex)
     return responseInfo;
 }
 
-bool MDRV2::readDataFromFlash(MDRSMBIOSHeader* mdrHdr, uint8_t* data)
+bool MDRV2::readDataFromFlash(const std::string& filePath,
+                              MDRSMBIOSHeader* mdrHdr, uint8_t* data)
 {
     if (mdrHdr == nullptr)
     {
@@ -216,7 +218,7 @@ bool MDRV2::readDataFromFlash(MDRSMBIOSHeader* mdrHdr, uint8_t* data)
             "Read data from flash error - Invalid data point");
         return false;
     }
-    std::ifstream smbiosFile(smbiosFilePath, std::ios_base::binary);
+    std::ifstream smbiosFile(filePath, std::ios_base::binary);
     if (!smbiosFile.good())
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
@@ -260,7 +262,8 @@ bool MDRV2::sendDirectoryInformation(uint8_t dirVersion, uint8_t dirIndex,
                                      std::vector<uint8_t> dirEntry)
 {
     bool terminate = false;
-    if ((dirIndex >= maxDirEntries) || (returnedEntries < 1))
+    if ((dirIndex >= maxDirEntries) || (returnedEntries < 1) ||
+        (returnedEntries > maxDirEntries - dirIndex))
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "Send Dir info failed - input parameter invalid");
@@ -305,6 +308,7 @@ bool MDRV2::sendDirectoryInformation(uint8_t dirVersion, uint8_t dirIndex,
                       smbiosDir.dir[idIndex + index].common.id.dataInfo);
             pData += sizeof(DataIdStruct);
         }
+        updateIdIndexMap();
     }
     return terminate;
 }
@@ -352,29 +356,31 @@ int MDRV2::findIdIndex(std::vector<uint8_t> dataInfo)
         throw sdbusplus::xyz::openbmc_project::Smbios::MDR_V2::Error::
             InvalidId();
     }
-    std::array<uint8_t, 16> arrayDataInfo;
-
-    std::copy(dataInfo.begin(), dataInfo.end(), arrayDataInfo.begin());
 
-    for (size_t index = 0; index < smbiosDir.dirEntries; index++)
+    auto it = idIndexMap.find(
+        std::string(reinterpret_cast<const char*>(dataInfo.data()),
+                    dataInfo.size()));
+    if (it != idIndexMap.end())
     {
-        size_t info = 0;
-        for (; info < arrayDataInfo.size(); info++)
-        {
-            if (arrayDataInfo[info] !=
-                smbiosDir.dir[index].common.id.dataInfo[info])
-            {
-                break;
-            }
-        }
-        if (info == arrayDataInfo.size())
-        {
-            return index;
-        }
+        return it->second;
     }
     throw sdbusplus::xyz::openbmc_project::Smbios::MDR_V2::Error::InvalidId();
 }
 
+void MDRV2::updateIdIndexMap()
+{
+    idIndexMap.clear();
+    for (uint8_t index = 0; index < smbiosDir.dirEntries; index++)
+    {
+        // Like the linear search this replaces, the first entry wins
+        idIndexMap.emplace(
+            std::string(reinterpret_cast<const char*>(
+                            smbiosDir.dir[index].common.id.dataInfo),
+                        sizeof(DataIdStruct)),
+            index);
+    }
+}
+
 uint8_t MDRV2::directoryEntries(uint8_t value)
 {
     std::ifstream smbiosFile(smbiosFilePath, std::ios_base::binary);
@@ -394,208 +400,176 @@ uint8_t MDRV2::directoryEntries(uint8_t value)
 
 void MDRV2::systemInfoUpdate()
 {
-    // By default, look for System interface on any system/board/* object
-    std::string mapperAncestorPath = smbiosInventoryPath;
-    std::string matchParentPath = smbiosInventoryPath + "/board/";
-    bool requireExactMatch = false;
-
-    // If customized, look for System on only that custom object
-    if (smbiosInventoryPath != defaultInventoryPath)
-    {
-        std::filesystem::path path(smbiosInventoryPath);
-
-        // Search under parent to find exact match for self
-        mapperAncestorPath = path.parent_path().string();
-        matchParentPath = mapperAncestorPath;
-        requireExactMatch = true;
-    }
+    // Decoding runs on the worker thread, the inventory objects are built
+    // from its result in applyDecodedTable().
+    tableDecoder.submit(
+        std::span<const uint8_t>(smbiosDir.dir[smbiosDirIndex].dataStorage,
+                                 smbiosTableStorageSize),
+        loadedTableHash);
+}
 
-    std::string motherboardPath;
-    auto method = bus->new_method_call(mapperBusName, mapperPath,
-                                       mapperInterface, "GetSubTree");
-    method.append(mapperAncestorPath);
-    method.append(0);
+// InterfacesAdded/InterfacesRemoved signals sent while applying a table
+struct SignalTally
+{
+    size_t added = 0;
+    size_t removed = 0;
+    size_t kept = 0;
+};
+
+// Each inventory object announces its D-Bus objects with one signal apiece
+template <typename Object>
+constexpr size_t dbusObjectsOf = 1;
+#ifdef PLATFORM_PREFIX
+// A CPU also owns its chassis object
+template <>
+constexpr size_t dbusObjectsOf<Cpu> = 2;
+#endif
 
-    // If customized, also accept Board as anchor, not just System
-    std::vector<std::string> desiredInterfaces{systemInterface};
-    if (requireExactMatch)
+// Objects whose path, parent and record are unchanged are kept and emit
+// nothing. All others are destroyed before any is created, so a path that
+// moved to another index is never registered twice. An object that cannot be
+// registered, e.g. because another service or instance owns its path, is
+// skipped rather than taking down the daemon.
+template <typename Object, typename Record, typename Create>
+static void applyInventory(std::vector<InventoryObject<Object, Record>>& current,
+                           std::vector<InventoryObject<Object, Record>> next,
+                           SignalTally& tally, Metrics& metrics, Create create)
+{
+    std::unordered_map<std::string, size_t> nextIndex;
+    for (size_t index = 0; index < next.size(); index++)
     {
-        desiredInterfaces.emplace_back(boardInterface);
+        nextIndex.emplace(next[index].path, index);
     }
-    method.append(desiredInterfaces);
-
-    try
+    for (auto& object : current)
     {
-        std::map<std::string, std::map<std::string, std::set<std::string>>>
-            subtree;
-        sdbusplus::message_t reply = bus->call(method);
-        reply.read(subtree);
-        if (subtree.size() < 1)
-        {
-            phosphor::logging::log<phosphor::logging::level::ERR>(
-                "Failed to get system motherboard dbus path.");
-        }
-
-        // If we found more than 1 system, select one with chassis intf
-        if (subtree.size() > 1)
+        auto it = nextIndex.find(object.path);
+        if (it == nextIndex.end())
         {
-            for (const auto& [path, services] : subtree)
-            {
-                for (const auto& [service, interfaces] : services)
-                {
-                    if (interfaces.contains(chassisInterface))
-                    {
-                        motherboardPath = path;
-                        break;
-                    }
-                }
-                if (!motherboardPath.empty())
-                {
-                    break;
-                }
-            }
+            continue;
         }
-        if (motherboardPath.empty() && subtree.size() != 0)
+        auto& wanted = next[it->second];
+        if (wanted.object == nullptr && wanted.parent == object.parent &&
+            wanted.record == object.record)
         {
-            motherboardPath = subtree.begin()->first;
+            wanted.object = std::move(object.object);
+            tally.kept += dbusObjectsOf<Object>;
         }
     }
-    catch (const sdbusplus::exception_t& e)
+    for (const auto& object : current)
     {
-        lg2::error(
-            "Exception while trying to find Inventory anchor object for SMBIOS content {I}: {E}",
-            "I", smbiosInventoryPath, "E", e.what());
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Failed to query system motherboard",
-            phosphor::logging::entry("ERROR=%s", e.what()));
+        if (object.object != nullptr)
+        {
+            tally.removed += dbusObjectsOf<Object>;
+        }
     }
+    Metrics::Timer timer(&metrics, Phase::objectRemoval);
+    current.clear();
 
-    // Get ProcessorModule inventories
-    std::vector<std::pair<std::string, std::optional<size_t>>> modules;
-    std::vector<std::pair<
-        std::string,
-        std::vector<std::pair<std::string, std::vector<std::string>>>>>
-        response;
-    sdbusplus::message_t findProcModuleMethod =
-        bus->new_method_call("xyz.openbmc_project.ObjectMapper",
-                             "/xyz/openbmc_project/object_mapper",
-                             "xyz.openbmc_project.ObjectMapper", "GetSubTree");
-    findProcModuleMethod.append(
-        "/xyz/openbmc_project/inventory", 0,
-        std::array<const char*, 1>{
-            "xyz.openbmc_project.Inventory.Item.ProcessorModule"});
-    try
-    {
-        sdbusplus::message_t reply = bus->call(findProcModuleMethod);
-        reply.read(response);
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Failed to query ProcessorModule",
-            phosphor::logging::entry("ERROR=%s", e.what()));
-    }
-    for (auto& [path, services] : response)
+    timer.next(Phase::objectCreation);
+    for (auto& wanted : next)
     {
-        // instert the path with a empty instance number first
-        modules.push_back({path, {}});
-        for (auto& [service, interfaces] : services)
+        if (wanted.object == nullptr)
         {
-            for (auto& interface : interfaces)
+            try
             {
-                if (interface ==
-                    "xyz.openbmc_project.Inventory.Decorator.Instance")
-                {
-                    std::variant<uint64_t> instanceNumber;
-                    sdbusplus::message_t getInstanceMethod =
-                        bus->new_method_call(service.c_str(), path.c_str(),
-                                             "org.freedesktop.DBus.Properties",
-                                             "Get");
-                    getInstanceMethod.append(interface, "InstanceNumber");
-                    try
-                    {
-                        sdbusplus::message_t reply =
-                            bus->call(getInstanceMethod);
-                        reply.read(instanceNumber);
-                        // Update the instance number
-                        modules.back().second =
-                            std::get<uint64_t>(instanceNumber);
-                    }
-                    catch (const sdbusplus::exception_t& e)
-                    {
-                        phosphor::logging::log<phosphor::logging::level::ERR>(
-                            "Failed to query instanceNumber",
-                            phosphor::logging::entry("ERROR=%s", e.what()));
-                    }
-                    break;
-                }
+                wanted.object = create(wanted);
+            }
+            catch (const sdbusplus::exception_t& e)
+            {
+                lg2::error("Failed to create inventory object {PATH}: {ERR}",
+                           "PATH", wanted.path, "ERR", e.what());
+            }
+            if (wanted.object != nullptr)
+            {
+                tally.added += dbusObjectsOf<Object>;
             }
         }
     }
+    std::erase_if(next, [](const auto& wanted) {
+        return wanted.object == nullptr;
+    });
+    current = std::move(next);
+}
 
-    std::optional<size_t> num;
-
-#ifdef PROCMOD_DBUS
-    int processorModuleIndex = 0;
-    baseboards.clear();
-    num = getTotalNum(baseboardType);
-    if (!num)
+std::string MDRV2::instancePath(std::string_view path) const
+{
+    std::string_view root = defaultInventoryPath;
+    if (!path.starts_with(root))
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "get total num failed");
-        return;
+        return std::string(path);
     }
-    for (size_t index = 0; index < *num; index++)
+    return smbiosInventoryPath + std::string(path.substr(root.size()));
+}
+
+std::string MDRV2::firmwareObjectName(const std::string& objName) const
+{
+    if (smbiosInventoryPath == defaultInventoryPath)
     {
-        using enum phosphor::smbios::Baseboard::BoardType;
-        baseboards.emplace_back(std::make_unique<phosphor::smbios::Baseboard>(
-            index, smbiosDir.dir[smbiosDirIndex].dataStorage));
-        auto& baseboard = baseboards.back();
-        switch (baseboard->getType())
-        {
-            case ProcessorModule:
-            case ProcesssorMemoryModule:
-            case ProcessorIoModule:
-                baseboard->setName("ProcessorModule_" +
-                                   std::to_string(processorModuleIndex++));
-                break;
-            default:
-                break;
-        }
+        return objName;
     }
-#endif
+    // Software objects are not under the inventory path, keep the ones of
+    // each instance apart by its inventory name
+    return std::filesystem::path(smbiosInventoryPath).filename().string() +
+           "_" + objName;
+}
 
-#ifdef CPU_DBUS
-    cpus.clear();
-    num = getTotalCpuSlot();
-    if (!num)
+void MDRV2::applyDecodedTable(const DecodedTable& table)
+{
+    // By default, look for System interface on any system/board/* object
+    std::string mapperAncestorPath = smbiosInventoryPath;
+    std::string exactPath;
+
+    // If customized, look for System on only that custom object
+    if (smbiosInventoryPath != defaultInventoryPath)
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "get cpu total slot failed");
-        return;
+        std::filesystem::path path(smbiosInventoryPath);
+
+        // Search under parent to find exact match for self
+        mapperAncestorPath = path.parent_path().string();
+        exactPath = smbiosInventoryPath;
     }
 
-    // In case the new size is smaller than old, trim the vector
-    if (*num < cpus.size())
+    metrics.add(Counter::rebuilds);
+    Metrics::Timer mapperTimer(&metrics, Phase::mapperQuery);
+    std::string motherboardPath = mapperCache.motherboard(mapperAncestorPath,
+                                                          exactPath);
+
+    // Get ProcessorModule inventories
+    MapperCache::Modules modules = mapperCache.processorModules();
+    mapperTimer.stop();
+
+    // Every instance publishes under its own inventory path. The modules of
+    // another host must not take this host's CPUs, so a customized instance
+    // only uses the modules under its own inventory objects.
+    if (smbiosInventoryPath != defaultInventoryPath)
     {
-        cpus.resize(*num);
+        std::erase_if(modules, [&](const auto& module) {
+            const std::string& modulePath = module.first;
+            return !modulePath.starts_with(smbiosInventoryPath + "/") &&
+                   (motherboardPath.empty() ||
+                    !modulePath.starts_with(motherboardPath + "/"));
+        });
     }
+    std::string boardPath = instancePath(defaultMotherboardPath);
 
-    for (unsigned int index = 0; index < *num; index++)
+    SignalTally tally;
+
+#ifdef CPU_DBUS
+    std::vector<InventoryObject<Cpu, CpuRecord>> nextCpus;
+    for (size_t index = 0; index < table.cpus.size(); index++)
     {
-        std::string path = cpuPath + std::to_string(index);
+        const CpuRecord& record = table.cpus[index];
+        std::string path = instancePath(cpuPath) + std::to_string(index);
         std::string cpuContainerPath = motherboardPath;
 
         // customize path if we know the socket number
-        auto dataPtr = getSMBIOSTypeIndexPtr(
-            smbiosDir.dir[smbiosDirIndex].dataStorage, processorsType, index);
-        auto [found, socket, chip] = Cpu::socketChipNumber(dataPtr);
-        if (found && modules.size())
+        if (record.socketFound && modules.size())
         {
             for (auto& [modulePath, moduleIntanceOpt] : modules)
             {
                 if (modules.size() == 1 || (moduleIntanceOpt.has_value() &&
-                                            *moduleIntanceOpt == socket))
+                                            *moduleIntanceOpt ==
+                                                record.socketNum))
                 {
                     // make the cpu under socket path
                     std::filesystem::path filePath(path);
@@ -608,189 +582,89 @@ void MDRV2::systemInfoUpdate()
             }
         }
 
-        std::string decoratePath = decorateName(path);
-        cpus.emplace_back(std::make_unique<phosphor::smbios::Cpu>(
-            *bus, path, index, smbiosDir.dir[smbiosDirIndex].dataStorage,
-            cpuContainerPath, decoratePath));
+        nextCpus.push_back({path, cpuContainerPath, record, nullptr});
     }
+    applyInventory(cpus, std::move(nextCpus), tally, metrics,
+                   [this](auto& cpu) {
+        std::string decoratePath = decorateName(cpu.path);
+        return std::make_unique<phosphor::smbios::Cpu>(
+            *bus, cpu.path, cpu.record, cpu.parent, decoratePath);
+    });
 #endif
 
 #ifdef DIMM_DBUS
-    dimms.clear();
-    num = getTotalDimmSlot();
-    if (!num)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "get dimm total slot failed");
-        return;
-    }
-
-    // In case the new size is smaller than old, trim the vector
-    if (*num < dimms.size())
+    std::vector<InventoryObject<Dimm, DimmRecord>> nextDimms;
+    for (const auto& dimm : table.dimms)
     {
-        dimms.resize(*num);
-    }
-
-    for (unsigned int index = 0; index < *num; index++)
-    {
-        std::string objName = "Memory_" + std::to_string(index);
-
-        // Rename the object if it's contaned by a board
-        uint8_t* dataIn = smbiosDir.dir[smbiosDirIndex].dataStorage;
-        dataIn = getSMBIOSTypeIndexPtr(dataIn, memoryDeviceType, index);
-        auto memoryHeader = reinterpret_cast<struct StructureHeader*>(dataIn);
-        for (const auto& baseboard : baseboards)
-        {
-            auto [found, indexOfType] =
-                baseboard->findIndexOfType(memoryHeader->handle);
-            if (found == true)
-            {
-                objName = baseboard->getName() + "_" + "Memory_" +
-                          std::to_string(indexOfType);
-                break;
-            }
-        }
-
-        std::string path(defaultMotherboardPath);
-        path += "/" + objName;
-        dimms.emplace_back(std::make_unique<phosphor::smbios::Dimm>(
-            *bus, path, index, smbiosDir.dir[smbiosDirIndex].dataStorage,
-            motherboardPath));
+        std::string path = boardPath + "/" + dimm.objName;
+        nextDimms.push_back({path, motherboardPath, dimm.record, nullptr});
     }
-
+    applyInventory(dimms, std::move(nextDimms), tally, metrics,
+                   [this](auto& dimm) {
+        return std::make_unique<phosphor::smbios::Dimm>(*bus, dimm.path,
+                                                        dimm.record,
+                                                        dimm.parent);
+    });
 #endif
 
-    num = getTotalPcieSlot();
-    if (!num)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "get pcie total slot failed");
-        return;
-    }
-
-    // In case the new size is smaller than old, trim the vector
-    if (*num < pcies.size())
-    {
-        pcies.resize(*num);
-    }
-
-    for (unsigned int index = 0; index < *num; index++)
+    std::vector<InventoryObject<Pcie, PcieRecord>> nextPcies;
+    for (size_t index = 0; index < table.pcies.size(); index++)
     {
         std::string path = smbiosInventoryPath + pcieSuffix +
                            std::to_string(index);
         // PCIeSlots need to start with same inventory path as the system path
-        if (!motherboardPath.empty() &&
-            path.starts_with(defaultMotherboardPath))
-        {
-            path.replace(0, strlen(defaultMotherboardPath), motherboardPath);
-        }
-
-        if (index + 1 > pcies.size())
+        if (!motherboardPath.empty() && path.starts_with(boardPath))
         {
-            pcies.emplace_back(std::make_unique<phosphor::smbios::Pcie>(
-                *bus, path, index, smbiosDir.dir[smbiosDirIndex].dataStorage,
-                motherboardPath));
+            path.replace(0, boardPath.size(), motherboardPath);
         }
-        else
-        {
-            pcies[index]->pcieInfoUpdate(
-                smbiosDir.dir[smbiosDirIndex].dataStorage, motherboardPath);
-        }
-    }
+        nextPcies.push_back({path, motherboardPath, table.pcies[index],
+                             nullptr});
+    }
+    applyInventory(pcies, std::move(nextPcies), tally, metrics,
+                   [this](auto& pcie) {
+        return std::make_unique<phosphor::smbios::Pcie>(*bus, pcie.path,
+                                                        pcie.record,
+                                                        pcie.parent);
+    });
 
-    tpm.reset();
-    if (getTotalNum(tpmDeviceType) == 1)
+    std::vector<InventoryObject<Tpm, TpmRecord>> nextTpm;
+    if (table.tpm)
     {
-        std::string path = tpmPath;
-        if (!motherboardPath.empty() &&
-            path.starts_with(defaultMotherboardPath))
+        std::string path = instancePath(tpmPath);
+        if (!motherboardPath.empty() && path.starts_with(boardPath))
         {
-            path.replace(0, strlen(defaultMotherboardPath), motherboardPath);
+            path.replace(0, boardPath.size(), motherboardPath);
         }
-        tpm = std::make_unique<Tpm>(bus, path,
-                                    smbiosDir.dir[smbiosDirIndex].dataStorage);
+        nextTpm.push_back({path, motherboardPath, *table.tpm, nullptr});
     }
+    applyInventory(tpm, std::move(nextTpm), tally, metrics,
+                   [this](auto& device) {
+        return std::make_unique<Tpm>(bus, device.path, device.record);
+    });
 
-    firmwareCollection.clear();
     std::vector<std::string> existedVersionPaths;
-    auto getVersionPaths = bus->new_method_call(
-        mapperBusName, mapperPath, mapperInterface, "GetSubTreePaths");
-    getVersionPaths.append(firmwarePath);
-    getVersionPaths.append(0);
-    getVersionPaths.append(std::array<std::string, 1>({versionInterface}));
-    try
-    {
-        sdbusplus::message_t reply = bus->call(getVersionPaths);
-        reply.read(existedVersionPaths);
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        lg2::error("Failed to query version objects. ERROR={ERROR}", "ERROR",
-                   e.what());
-        existedVersionPaths.clear();
-    }
-
-    num = getTotalNum(firmwareInventoryInformationType);
-    if (!num)
     {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "get firmware failed");
-        return;
-    }
+        Metrics::Timer timer(&metrics, Phase::mapperQuery);
+        existedVersionPaths = mapperCache.versionPaths(firmwarePath);
+    }
+    // Our own firmware objects are on the mapper too, they must not hide the
+    // records they were published from
+    std::erase_if(existedVersionPaths, [this](const std::string& path) {
+        return std::any_of(firmwareCollection.begin(),
+                           firmwareCollection.end(),
+                           [&path](const auto& firmware) {
+            return firmware.path == path;
+        });
+    });
 
-    for (size_t index = 0; index < *num; index++)
+    std::vector<InventoryObject<Firmware, FirmwareRecord>> nextFirmware;
+    for (const auto& firmware : table.firmware)
     {
-        std::string path = firmwarePath;
-        auto [firmwareName, objName] = Firmware::getFirmwareName(
-            smbiosDir.dir[smbiosDirIndex].dataStorage, index);
-#ifdef FIRMWARE_COMPONENT_NAME_BMC
-        std::string bmcComponentName(FIRMWARE_COMPONENT_NAME_BMC);
-        if (bmcComponentName == firmwareName)
-        {
-            continue;
-        }
-#endif
-#ifdef FIRMWARE_COMPONENT_NAME_BIOS
-        std::string biosComponentName(FIRMWARE_COMPONENT_NAME_BIOS);
-        if (biosComponentName == firmwareName)
-        {
-            continue;
-        }
-#endif
-#ifdef FIRMWARE_COMPONENT_NAME_CX7
-        std::string cx7ComponentName(FIRMWARE_COMPONENT_NAME_CX7);
-        if (firmwareName.rfind(cx7ComponentName) != std::string::npos)
-        {
-            continue;
-        }
-#endif
-#ifdef FIRMWARE_COMPONENT_NAME_FPGA
-        std::string fpgaComponentName(FIRMWARE_COMPONENT_NAME_FPGA);
-        if (firmwareName.rfind(fpgaComponentName) != std::string::npos)
-        {
-            continue;
-        }
-#endif
-#ifdef FIRMWARE_COMPONENT_NAME_TPM
-        std::string tpmComponentName(FIRMWARE_COMPONENT_NAME_TPM);
-        if (tpmComponentName == firmwareName)
-        {
-            continue;
-        }
-#endif
-
-        if (objName.empty())
-        {
-            objName = "firmware" + std::to_string(index);
-        }
-        objName = std::regex_replace(objName, std::regex("[^a-zA-Z0-9_/]+"),
-                                     "_");
-
         // Skip if we have the same object name on DBUS, BIOS probably fetchs it
         // from BMC.
-        auto eqObjName = [objName](std::string s) {
+        auto eqObjName = [&firmware](std::string s) {
             std::filesystem::path p(s);
-            return p.filename().compare(objName) == 0;
+            return p.filename().compare(firmware.objName) == 0;
         };
         if (std::find_if(existedVersionPaths.begin(), existedVersionPaths.end(),
                          std::move(eqObjName)) != existedVersionPaths.end())
@@ -798,175 +672,43 @@ void MDRV2::systemInfoUpdate()
             continue;
         }
 
-        path.append("/").append(objName);
-        try
-        {
-            std::string cp = path;
-            std::transform(cp.begin(), cp.end(), cp.begin(), ::tolower);
-
-            if (cp.find("psu") != std::string::npos)
-                continue;
-
-            firmwareCollection.emplace_back(
-                std::make_unique<phosphor::smbios::Firmware>(
-                    bus, path, index,
-                    smbiosDir.dir[smbiosDirIndex].dataStorage));
-        }
-        catch (const sdbusplus::exception_t& e)
-        {
-            phosphor::logging::log<phosphor::logging::level::ERR>(
-                "Failed to create firmware object",
-                phosphor::logging::entry("ERROR=%s", e.what()));
-        }
-    }
-
-    system.reset();
-    system = std::make_unique<System>(bus, smbiosInventoryPath + systemSuffix,
-                                      smbiosDir.dir[smbiosDirIndex].dataStorage,
-                                      smbiosFilePath);
-}
-
-std::optional<size_t> MDRV2::getTotalCpuSlot()
-{
-    uint8_t* dataIn = smbiosDir.dir[smbiosDirIndex].dataStorage;
-    size_t num = 0;
-
-    if (dataIn == nullptr)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "get cpu total slot failed - no storage data");
-        return std::nullopt;
-    }
-
-    while (1)
-    {
-        dataIn = getSMBIOSTypePtr(dataIn, processorsType);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-        num++;
-        dataIn = smbiosNextPtr(dataIn);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-        if (num >= limitEntryLen)
-        {
-            break;
-        }
-    }
-
-    return num;
-}
-
-std::optional<size_t> MDRV2::getTotalDimmSlot()
-{
-    uint8_t* dataIn = smbiosDir.dir[smbiosDirIndex].dataStorage;
-    size_t num = 0;
-
-    if (dataIn == nullptr)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Fail to get dimm total slot - no storage data");
-        return std::nullopt;
-    }
-
-    while (1)
-    {
-        dataIn = getSMBIOSTypePtr(dataIn, memoryDeviceType);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-        num++;
-        dataIn = smbiosNextPtr(dataIn);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-        if (num >= limitEntryLen)
-        {
-            break;
-        }
-    }
-
-    return num;
-}
-
-std::optional<size_t> MDRV2::getTotalPcieSlot()
-{
-    uint8_t* dataIn = smbiosDir.dir[smbiosDirIndex].dataStorage;
-    size_t num = 0;
-
-    if (dataIn == nullptr)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Fail to get total system slot - no storage data");
-        return std::nullopt;
-    }
-
-    while (1)
-    {
-        dataIn = getSMBIOSTypePtr(dataIn, systemSlots);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-
-        /* System slot type offset. Check if the slot is a PCIE slots. All
-         * PCIE slot type are hardcoded in a table.
-         */
-        if (pcieSmbiosType.find(*(dataIn + 5)) != pcieSmbiosType.end())
-        {
-            num++;
-        }
-        dataIn = smbiosNextPtr(dataIn);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-        if (num >= limitEntryLen)
-        {
-            break;
-        }
+        std::string path = firmwarePath;
+        path.append("/").append(firmwareObjectName(firmware.objName));
+        nextFirmware.push_back({path, "", firmware.record, nullptr});
     }
+    applyInventory(firmwareCollection, std::move(nextFirmware), tally,
+                   metrics, [this](auto& firmware) {
+        return std::make_unique<phosphor::smbios::Firmware>(bus, firmware.path,
+                                                            firmware.record);
+    });
 
-    return num;
-}
-
-std::optional<size_t> MDRV2::getTotalNum(uint8_t typeId, size_t minSize)
-{
-    uint8_t* dataIn = smbiosDir.dir[smbiosDirIndex].dataStorage;
-    size_t num = 0;
+    std::vector<InventoryObject<System, SystemRecord>> nextSystem;
+    nextSystem.push_back(
+        {smbiosInventoryPath + systemSuffix, "", table.system, nullptr});
+    applyInventory(system, std::move(nextSystem), tally, metrics,
+                   [this](auto& info) {
+        return std::make_unique<System>(bus, info.path, info.record,
+                                        smbiosFilePath, mapperCache);
+    });
 
-    if (dataIn == nullptr)
-    {
-        phosphor::logging::log<phosphor::logging::level::ERR>(
-            "no storage data");
-        return std::nullopt;
-    }
+    lg2::info("Published SMBIOS inventory: {ADDED} InterfacesAdded, "
+              "{REMOVED} InterfacesRemoved, {KEPT} unchanged",
+              "ADDED", tally.added, "REMOVED", tally.removed, "KEPT",
+              tally.kept);
+    metrics.add(Counter::signalsEmitted, tally.added + tally.removed);
+    metrics.add(Counter::dedupHits, tally.kept);
 
-    while (1)
+    // A table that was published without being rejected (e.g. by the BIOS
+    // version check) becomes the fallback for the next start and the newest
+    // generation of the history.
+    if (table.hash == unrecordedTableHash)
     {
-        dataIn = getSMBIOSTypePtr(dataIn, typeId, minSize);
-        if (dataIn == nullptr)
+        unrecordedTableHash = 0;
+        if (std::filesystem::exists(smbiosFilePath))
         {
-            break;
-        }
-        num++;
-        dataIn = smbiosNextPtr(dataIn);
-        if (dataIn == nullptr)
-        {
-            break;
-        }
-        if (num >= limitEntryLen)
-        {
-            break;
+            recordLoadedTable();
         }
     }
-
-    return num;
 }
 
 bool MDRV2::checkSMBIOSVersion(uint8_t* dataIn)
@@ -1042,13 +784,31 @@ bool MDRV2::checkSMBIOSVersion(uint8_t* dataIn)
     return true;
 }
 
-bool MDRV2::agentSynchronizeData()
+std::string MDRV2::entryFilePath(uint8_t index) const
 {
+    if (index == smbiosDirIndex)
+    {
+        return smbiosFilePath;
+    }
+    return smbiosFilePath + "." + std::to_string(index);
+}
+
+bool MDRV2::loadEntry(uint8_t index)
+{
+    Mdr2DirLocalStruct& entry = smbiosDir.dir[index];
+    if (entry.dataStorage == nullptr)
+    {
+        entryStorage[index] = std::make_unique<uint8_t[]>(
+            smbiosTableStorageSize);
+        entry.dataStorage = entryStorage[index].get();
+    }
+
     struct MDRSMBIOSHeader mdr2SMBIOS;
-    std::fill_n(smbiosDir.dir[smbiosDirIndex].dataStorage,
-                smbiosTableStorageSize, 0);
-    bool status = readDataFromFlash(&mdr2SMBIOS,
-                                    smbiosDir.dir[smbiosDirIndex].dataStorage);
+    std::fill_n(entry.dataStorage, smbiosTableStorageSize, 0);
+    entryIndex[index] = StructureIndex();
+    Metrics::Timer timer(&metrics, Phase::fileRead);
+    bool status = readDataFromFlash(entryFilePath(index), &mdr2SMBIOS,
+                                    entry.dataStorage);
     if (!status)
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
@@ -1056,13 +816,47 @@ bool MDRV2::agentSynchronizeData()
         return false;
     }
 
-    if (!checkSMBIOSVersion(smbiosDir.dir[smbiosDirIndex].dataStorage))
+    timer.next(Phase::versionCheck);
+    if (!checkSMBIOSVersion(entry.dataStorage))
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
             "Unsupported SMBIOS table version");
         return false;
     }
 
+    entry.common.dataVersion = mdr2SMBIOS.dirVer;
+    entry.common.timestamp = mdr2SMBIOS.timestamp;
+    entry.common.size = mdr2SMBIOS.dataSize;
+    entry.stage = MDR2SMBIOSStatusEnum::mdr2Loaded;
+    entry.lock = MDR2DirLockEnum::mdr2DirUnlock;
+    entry.generation++;
+
+    timer.next(Phase::indexing);
+    entryIndex[index] = StructureIndex(
+        std::span<const uint8_t>(entry.dataStorage, entry.common.size));
+
+    return true;
+}
+
+bool MDRV2::agentSynchronizeData()
+{
+    // Secondary data sets are loaded alongside the primary table but only
+    // the primary one is published to the inventory.
+    for (uint8_t index = 0; index < smbiosDir.dirEntries; index++)
+    {
+        if (index != smbiosDirIndex &&
+            std::filesystem::exists(entryFilePath(index)))
+        {
+            loadEntry(index);
+        }
+    }
+
+    if (!loadEntry(smbiosDirIndex))
+    {
+        return false;
+    }
+    metrics.add(Counter::tablesLoaded);
+
     // Defer systemInfoUpdate() to speed up reply
     std::chrono::microseconds usec(defaultTimeout);
     timer.expires_after(usec);
@@ -1073,21 +867,138 @@ bool MDRV2::agentSynchronizeData()
                 "Timer Error!");
             return;
         }
+        unrecordedTableHash = loadedTableHash;
         systemInfoUpdate();
     });
 
-    smbiosDir.dir[smbiosDirIndex].common.dataVersion = mdr2SMBIOS.dirVer;
-    smbiosDir.dir[smbiosDirIndex].common.timestamp = mdr2SMBIOS.timestamp;
-    smbiosDir.dir[smbiosDirIndex].common.size = mdr2SMBIOS.dataSize;
-    smbiosDir.dir[smbiosDirIndex].stage = MDR2SMBIOSStatusEnum::mdr2Loaded;
-    smbiosDir.dir[smbiosDirIndex].lock = MDR2DirLockEnum::mdr2DirUnlock;
+    loadedTableHash = tableHash(
+        std::span<const uint8_t>(smbiosDir.dir[smbiosDirIndex].dataStorage,
+                                 smbiosDir.dir[smbiosDirIndex].common.size));
 
     return true;
 }
 
+bool MDRV2::recordLoadedTable()
+{
+    const auto& entry = smbiosDir.dir[smbiosDirIndex];
+    if (entry.common.size > smbiosTableStorageSize)
+    {
+        return false;
+    }
+
+    MDRSMBIOSHeader mdrHdr;
+    mdrHdr.dirVer = entry.common.dataVersion;
+    mdrHdr.mdrType = mdrTypeII;
+    mdrHdr.timestamp = entry.common.timestamp;
+    mdrHdr.dataSize = entry.common.size;
+
+    std::span<const uint8_t> data(entry.dataStorage, entry.common.size);
+    bool lkg = phosphor::smbios::promoteLastKnownGood(smbiosFilePath, mdrHdr,
+                                                      data);
+    bool history = tableHistory.record(mdrHdr, data);
+    return lkg && history;
+}
+
+void MDRV2::reloadTable()
+{
+    if (smbiosDir.dir[smbiosDirIndex].stage ==
+        MDR2SMBIOSStatusEnum::mdr2Updating)
+    {
+        // The MDR transfer in progress ends with its own synchronization
+        return;
+    }
+
+    std::vector<uint8_t> content;
+    if (!readFile(smbiosFilePath, content) ||
+        content.size() < sizeof(MDRSMBIOSHeader))
+    {
+        return;
+    }
+
+    std::span<const uint8_t> data(content);
+    if (tableHash(data.subspan(sizeof(MDRSMBIOSHeader))) == loadedTableHash)
+    {
+        // Already loaded, e.g. through AgentSynchronizeData
+        metrics.add(Counter::dedupHits);
+        return;
+    }
+
+    lg2::info("SMBIOS table {F} changed on disk, reloading", "F",
+              smbiosFilePath);
+    agentSynchronizeData();
+}
+
+std::vector<TableGeneration> MDRV2::getTableGenerations()
+{
+    std::vector<TableGeneration> ret;
+    for (const auto& generation : tableHistory.generations())
+    {
+        ret.emplace_back(generation.sequence, generation.timestamp,
+                         generation.hash);
+    }
+    return ret;
+}
+
+std::vector<PhaseTime> MDRV2::getPhaseTimes() const
+{
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+
+    std::vector<PhaseTime> ret;
+    for (size_t index = 0; index < static_cast<size_t>(Phase::count); index++)
+    {
+        auto phase = static_cast<Phase>(index);
+        Metrics::PhaseStats stats = metrics.stats(phase);
+        ret.emplace_back(phaseName(phase), stats.count,
+                         duration_cast<microseconds>(stats.total).count(),
+                         duration_cast<microseconds>(stats.max).count());
+    }
+    return ret;
+}
+
+std::vector<CounterValue> MDRV2::getCounters() const
+{
+    std::vector<CounterValue> ret;
+    for (size_t index = 0; index < static_cast<size_t>(Counter::count);
+         index++)
+    {
+        auto counter = static_cast<Counter>(index);
+        ret.emplace_back(counterName(counter), metrics.value(counter));
+    }
+    return ret;
+}
+
+std::vector<TableChange> MDRV2::diffTableGenerations(uint32_t from,
+                                                     uint32_t to)
+{
+    std::vector<uint8_t> oldTable;
+    std::vector<uint8_t> newTable;
+    if (!tableHistory.load(from, oldTable) || !tableHistory.load(to, newTable))
+    {
+        throw std::invalid_argument("Invalid table generation");
+    }
+
+    StructureIndex oldIndex(oldTable);
+    StructureIndex newIndex(newTable);
+
+    std::vector<TableChange> ret;
+    for (const auto& diff : diffTables(oldTable, oldIndex, newTable, newIndex))
+    {
+        ret.emplace_back(structureChangeName(diff.change), diff.handle,
+                         diff.type);
+    }
+    return ret;
+}
+
 std::vector<uint32_t> MDRV2::synchronizeDirectoryCommonData(uint8_t idIndex,
                                                             uint32_t size)
 {
+    if (idIndex >= maxDirEntries)
+    {
+        throw sdbusplus::xyz::openbmc_project::Smbios::MDR_V2::Error::
+            InvalidParameter();
+    }
+
     std::chrono::microseconds usec(
         defaultTimeout); // default lock time out is 2s
     std::vector<uint32_t> result;
@@ -1096,40 +1007,70 @@ std::vector<uint32_t> MDRV2::synchronizeDirectoryCommonData(uint8_t idIndex,
     result.push_back(smbiosDir.dir[idIndex].common.dataVersion);
     result.push_back(smbiosDir.dir[idIndex].common.timestamp);
 
-    timer.expires_after(usec);
-    timer.async_wait([this](boost::system::error_code ec) {
+    // Each entry has its own lock timer so that updating one data set does
+    // not delay or cancel the synchronization of another.
+    entryTimers[idIndex].expires_after(usec);
+    entryTimers[idIndex].async_wait(
+        [this, idIndex](boost::system::error_code ec) {
         if (ec)
         {
             phosphor::logging::log<phosphor::logging::level::ERR>(
                 "Timer Error!");
             return;
         }
-        agentSynchronizeData();
+        if (idIndex == smbiosDirIndex)
+        {
+            agentSynchronizeData();
+        }
+        else
+        {
+            loadEntry(idIndex);
+        }
     });
     return result;
 }
 
 std::vector<boost::container::flat_map<std::string, RecordVariant>>
     MDRV2::getRecordType(size_t type)
+{
+    return getEntryRecordType(smbiosDirIndex, type);
+}
+
+std::vector<boost::container::flat_map<std::string, RecordVariant>>
+    MDRV2::getDataSetRecordType(std::vector<uint8_t> dataInfo, size_t type)
+{
+    int idIndex = findIdIndex(std::move(dataInfo));
+    return getEntryRecordType(static_cast<uint8_t>(idIndex), type);
+}
+
+uint32_t MDRV2::getDataSetGeneration(std::vector<uint8_t> dataInfo)
+{
+    int idIndex = findIdIndex(std::move(dataInfo));
+    return smbiosDir.dir[idIndex].generation;
+}
+
+std::vector<boost::container::flat_map<std::string, RecordVariant>>
+    MDRV2::getEntryRecordType(uint8_t index, size_t type)
 {
     std::vector<boost::container::flat_map<std::string, RecordVariant>> ret;
     if (type == memoryDeviceType)
     {
-        uint8_t* dataIn = smbiosDir.dir[smbiosDirIndex].dataStorage;
-
-        if (dataIn == nullptr)
+        const Mdr2DirLocalStruct& entry = smbiosDir.dir[index];
+        if (entry.dataStorage == nullptr)
         {
             throw std::runtime_error("Data not populated");
         }
 
-        do
+        for (const StructureEntry* structure :
+             entryIndex[index].ofType(memoryDeviceType))
         {
-            dataIn = getSMBIOSTypePtr(dataIn, memoryDeviceType,
-                                      sizeof(MemoryInfo));
-            if (dataIn == nullptr)
+            if (structure->size < sizeof(MemoryInfo))
             {
-                break;
+                phosphor::logging::log<phosphor::logging::level::ERR>(
+                    "Data length is less than expected structure size");
+                continue;
             }
+            uint8_t* dataIn = entry.dataStorage + structure->offset;
             boost::container::flat_map<std::string, RecordVariant>& record =
                 ret.emplace_back();
 
@@ -1185,7 +1126,7 @@ std::vector<boost::container::flat_map<std::string, RecordVariant>>
             record["Volatile Size"] = uint64_t(memoryInfo->volatileSize);
             record["Cache Size"] = uint64_t(memoryInfo->cacheSize);
             record["Logical Size"] = uint64_t(memoryInfo->logicalSize);
-        } while ((dataIn = smbiosNextPtr(dataIn)) != nullptr);
+        }
 
         return ret;
     }
@@ -17,13 +17,164 @@
 #include "mdrv2.hpp"
 
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/signal_set.hpp>
+#include <nlohmann/json.hpp>
 #include <phosphor-logging/elog-errors.hpp>
 #include <phosphor-logging/elog.hpp>
 #include <sdbusplus/asio/connection.hpp>
 #include <sdbusplus/asio/object_server.hpp>
 
-int main()
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+static constexpr const char* defaultConfigFile =
+    "/usr/share/smbios-mdr/instances.json";
+#ifdef SMBIOS_METRICS_DUMP
+static constexpr const char* metricsDumpFile = "/run/smbios-mdr-metrics.json";
+#endif
+
+struct InstanceConfig
+{
+    std::string filePath;
+    std::string objectPath;
+    std::string inventoryPath;
+};
+
+/**
+ * Read the MDRV2 instances from a JSON config of the form
+ *   {"Instances": [{"FilePath": ..., "ObjectPath": ...,
+ *                   "InventoryPath": ...}, ...]}
+ * Missing keys take the single-instance defaults. Without a config file a
+ * single default instance is hosted.
+ */
+static std::vector<InstanceConfig> loadInstances(const std::string& configFile)
+{
+    InstanceConfig defaults{mdrDefaultFile, phosphor::smbios::defaultObjectPath,
+                            phosphor::smbios::defaultInventoryPath};
+
+    std::ifstream file(configFile);
+    if (!file.good())
+    {
+        return {defaults};
+    }
+
+    std::vector<InstanceConfig> instances;
+    try
+    {
+        auto config = nlohmann::json::parse(file);
+        for (const auto& instance : config.at("Instances"))
+        {
+            instances.emplace_back(
+                instance.value("FilePath", defaults.filePath),
+                instance.value("ObjectPath", defaults.objectPath),
+                instance.value("InventoryPath", defaults.inventoryPath));
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        lg2::error("Invalid SMBIOS MDR config {FILE}: {ERR}", "FILE",
+                   configFile, "ERR", e.what());
+        return {defaults};
+    }
+
+    // Instances cannot share a table file, a control object or an inventory
+    // path, which their inventory objects are published under
+    std::set<std::string> files;
+    std::set<std::string> objects;
+    std::set<std::string> inventories;
+    std::erase_if(instances, [&](const InstanceConfig& instance) {
+        if (!files.insert(instance.filePath).second ||
+            !objects.insert(instance.objectPath).second ||
+            !inventories.insert(instance.inventoryPath).second)
+        {
+            lg2::error("Ignoring duplicate SMBIOS MDR instance {O}", "O",
+                       instance.objectPath);
+            return true;
+        }
+        return false;
+    });
+
+    if (instances.empty())
+    {
+        return {defaults};
+    }
+    return instances;
+}
+
+#ifdef SMBIOS_METRICS_DUMP
+/**
+ * Write the metrics of every instance to the dump file, in the form
+ *   {"Instances": [{"ObjectPath": ..., "Phases": {name: {"Count": ...,
+ *                   "TotalUsec": ..., "MaxUsec": ...}, ...},
+ *                   "Counters": {name: value, ...}}, ...]}
+ */
+static void dumpMetrics(
+    const std::vector<InstanceConfig>& configs,
+    const std::vector<std::shared_ptr<phosphor::smbios::MDRV2>>& instances)
+{
+    nlohmann::json dump;
+    dump["Instances"] = nlohmann::json::array();
+    for (size_t index = 0; index < instances.size(); index++)
+    {
+        nlohmann::json instance;
+        instance["ObjectPath"] = configs[index].objectPath;
+        for (const auto& [name, count, total, max] :
+             instances[index]->getPhaseTimes())
+        {
+            instance["Phases"][name] = {
+                {"Count", count}, {"TotalUsec", total}, {"MaxUsec", max}};
+        }
+        for (const auto& [name, value] : instances[index]->getCounters())
+        {
+            instance["Counters"][name] = value;
+        }
+        dump["Instances"].push_back(std::move(instance));
+    }
+
+    // Readers never see a partially written file
+    std::string tempFile = std::string(metricsDumpFile) + ".tmp";
+    {
+        std::ofstream file(tempFile, std::ios::trunc);
+        file << dump.dump(2) << "\n";
+        if (!file.good())
+        {
+            lg2::error("Failed to write SMBIOS metrics to {FILE}", "FILE",
+                       tempFile);
+            return;
+        }
+    }
+    if (std::rename(tempFile.c_str(), metricsDumpFile) != 0)
+    {
+        lg2::error("Failed to write SMBIOS metrics to {FILE}", "FILE",
+                   metricsDumpFile);
+        return;
+    }
+    lg2::info("SMBIOS metrics written to {FILE}", "FILE", metricsDumpFile);
+}
+
+static void waitDumpSignal(
+    boost::asio::signal_set& signals, const std::vector<InstanceConfig>& configs,
+    const std::vector<std::shared_ptr<phosphor::smbios::MDRV2>>& instances)
 {
+    signals.async_wait([&](const boost::system::error_code& ec, int) {
+        if (ec)
+        {
+            return;
+        }
+        dumpMetrics(configs, instances);
+        waitDumpSignal(signals, configs, instances);
+    });
+}
+#endif
+
+int main(int argc, char** argv)
+{
+    std::string configFile = argc > 1 ? argv[1] : defaultConfigFile;
+
     auto io = std::make_shared<boost::asio::io_context>();
     auto connection = std::make_shared<sdbusplus::asio::connection>(*io);
     auto objServer =
@@ -34,10 +185,20 @@ int main()
 
     connection->request_name("xyz.openbmc_project.Smbios.MDR_V2");
 
-    auto mdrV2 = std::make_shared<phosphor::smbios::MDRV2>(
-        io, connection, objServer, mdrDefaultFile,
-        phosphor::smbios::defaultObjectPath,
-        phosphor::smbios::defaultInventoryPath);
+    // All instances share the loop, the connection and the object server
+    std::vector<InstanceConfig> configs = loadInstances(configFile);
+    std::vector<std::shared_ptr<phosphor::smbios::MDRV2>> instances;
+    for (const auto& instance : configs)
+    {
+        instances.emplace_back(std::make_shared<phosphor::smbios::MDRV2>(
+            io, connection, objServer, instance.filePath, instance.objectPath,
+            instance.inventoryPath));
+    }
+
+#ifdef SMBIOS_METRICS_DUMP
+    boost::asio::signal_set signals(*io, SIGUSR1);
+    waitDumpSignal(signals, configs, instances);
+#endif
 
     io->run();
 
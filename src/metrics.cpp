@@ -0,0 +1,92 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "metrics.hpp"
+
+namespace phosphor
+{
+namespace smbios
+{
+
+const char* phaseName(Phase phase)
+{
+    switch (phase)
+    {
+        case Phase::fileRead:
+            return "FileRead";
+        case Phase::versionCheck:
+            return "VersionCheck";
+        case Phase::indexing:
+            return "Indexing";
+        case Phase::decodeCpu:
+            return "DecodeCpu";
+        case Phase::decodeDimm:
+            return "DecodeDimm";
+        case Phase::decodePcie:
+            return "DecodePcie";
+        case Phase::decodeTpm:
+            return "DecodeTpm";
+        case Phase::decodeFirmware:
+            return "DecodeFirmware";
+        case Phase::decodeSystem:
+            return "DecodeSystem";
+        case Phase::mapperQuery:
+            return "MapperQuery";
+        case Phase::objectRemoval:
+            return "ObjectRemoval";
+        case Phase::objectCreation:
+            return "ObjectCreation";
+        case Phase::count:
+            break;
+    }
+    return "";
+}
+
+const char* counterName(Counter counter)
+{
+    switch (counter)
+    {
+        case Counter::tablesLoaded:
+            return "TablesLoaded";
+        case Counter::rebuilds:
+            return "Rebuilds";
+        case Counter::recordsDecoded:
+            return "RecordsDecoded";
+        case Counter::signalsEmitted:
+            return "SignalsEmitted";
+        case Counter::dedupHits:
+            return "DedupHits";
+        case Counter::count:
+            break;
+    }
+    return "";
+}
+
+void Metrics::record(Phase phase, std::chrono::nanoseconds elapsed)
+{
+    phases[static_cast<size_t>(phase)].record(
+        static_cast<uint64_t>(elapsed.count()));
+}
+
+Metrics::PhaseStats Metrics::stats(Phase phase) const
+{
+    AtomicStats::Snapshot slot = phases[static_cast<size_t>(phase)].snapshot();
+    return {slot.count, std::chrono::nanoseconds(slot.total),
+            std::chrono::nanoseconds(slot.max)};
+}
+
+} // namespace smbios
+} // namespace phosphor
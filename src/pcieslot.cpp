@@ -8,17 +8,15 @@ namespace phosphor
 namespace smbios
 {
 
-void Pcie::pcieInfoUpdate(uint8_t* smbiosTableStorage,
-                          const std::string& motherboard)
+PcieRecord Pcie::decode(uint8_t* smbiosTableStorage, uint8_t pcieNum)
 {
-    storage = smbiosTableStorage;
-    motherboardPath = motherboard;
+    PcieRecord record;
 
-    uint8_t* dataIn = getSMBIOSTypePtr(storage, systemSlots);
+    uint8_t* dataIn = getSMBIOSTypePtr(smbiosTableStorage, systemSlots);
 
     if (dataIn == nullptr)
     {
-        return;
+        return record;
     }
 
     /* offset 5 points to the slot type */
@@ -29,12 +27,12 @@ void Pcie::pcieInfoUpdate(uint8_t* smbiosTableStorage,
         dataIn = smbiosNextPtr(dataIn);
         if (dataIn == nullptr)
         {
-            return;
+            return record;
         }
         dataIn = getSMBIOSTypePtr(dataIn, systemSlots);
         if (dataIn == nullptr)
         {
-            return;
+            return record;
         }
         if (pcieSmbiosType.find(*(dataIn + 5)) != pcieSmbiosType.end())
         {
@@ -68,39 +66,55 @@ void Pcie::pcieInfoUpdate(uint8_t* smbiosTableStorage,
         }
     }
 
-    pcieGeneration(pcieInfo->slotType);
-    pcieType(pcieInfo->slotType, pcieInfo->slotLength, slotHight);
-    pcieLaneSize(pcieInfo->slotDataBusWidth);
-    pcieIsHotPluggable(pcieInfo->characteristics2);
-    pcieLocation(pcieInfo->slotDesignation, pcieInfo->length, dataIn);
+    record.generation = pcieGeneration(pcieInfo->slotType);
+    record.slotType = pcieType(pcieInfo->slotType, pcieInfo->slotLength,
+                               slotHight);
+    record.lanes = pcieLaneSize(pcieInfo->slotDataBusWidth);
+    /*  Bit 1 of slot characteristics 2 indicates if slot supports hot-plug
+     *  devices
+     */
+    record.hotPluggable = pcieInfo->characteristics2 & 0x2;
+    record.location = positionToString(pcieInfo->slotDesignation,
+                                       pcieInfo->length, dataIn);
+
+    return record;
+}
+
+void Pcie::pcieInfoUpdate(const PcieRecord& record,
+                          const std::string& motherboard)
+{
+    motherboardPath = motherboard;
+
+    PCIeSlot::generation(record.generation, true);
+    PCIeSlot::slotType(record.slotType, true);
+    PCIeSlot::lanes(record.lanes, true);
+    PCIeSlot::hotPluggable(record.hotPluggable, true);
+    location::locationCode(record.location, true);
 
     /* Pcie slot is embedded on the board. Always be true */
-    Item::present(true);
+    Item::present(true, true);
 
     if (!motherboardPath.empty())
     {
         std::vector<std::tuple<std::string, std::string, std::string>> assocs;
         assocs.emplace_back("chassis", "pcie_slots", motherboardPath);
-        association::associations(assocs);
+        association::associations(assocs, true);
     }
 }
 
-void Pcie::pcieGeneration(const uint8_t type)
+PCIeGeneration Pcie::pcieGeneration(const uint8_t type)
 {
     std::map<uint8_t, PCIeGeneration>::const_iterator it =
         pcieGenerationTable.find(type);
     if (it == pcieGenerationTable.end())
     {
-        PCIeSlot::generation(PCIeGeneration::Unknown);
-    }
-    else
-    {
-        PCIeSlot::generation(it->second);
+        return PCIeGeneration::Unknown;
     }
+    return it->second;
 }
 
-void Pcie::pcieType(const uint8_t type, const uint8_t length,
-                    const uint8_t height)
+PCIeType Pcie::pcieType(const uint8_t type, const uint8_t length,
+                        const uint8_t height)
 {
     PCIeType dbusPcieType = PCIeType::Unknown;
     std::map<uint8_t, PCIeType>::const_iterator it = pcieTypeTable.find(type);
@@ -121,35 +135,17 @@ void Pcie::pcieType(const uint8_t type, const uint8_t length,
         dbusPcieType = PCIeType::HalfLength;
     }
 
-    PCIeSlot::slotType(dbusPcieType);
+    return dbusPcieType;
 }
 
-void Pcie::pcieLaneSize(const uint8_t width)
+size_t Pcie::pcieLaneSize(const uint8_t width)
 {
     std::map<uint8_t, size_t>::const_iterator it = pcieLanesTable.find(width);
     if (it == pcieLanesTable.end())
     {
-        PCIeSlot::lanes(0);
-    }
-    else
-    {
-        PCIeSlot::lanes(it->second);
+        return 0;
     }
-}
-
-void Pcie::pcieIsHotPluggable(const uint8_t characteristics)
-{
-    /*  Bit 1 of slot characteristics 2 indicates if slot supports hot-plug
-     *  devices
-     */
-    PCIeSlot::hotPluggable(characteristics & 0x2);
-}
-
-void Pcie::pcieLocation(const uint8_t slotDesignation, const uint8_t structLen,
-                        uint8_t* dataIn)
-{
-    location::locationCode(
-        positionToString(slotDesignation, structLen, dataIn));
+    return it->second;
 }
 
 } // namespace smbios
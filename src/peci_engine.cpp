@@ -0,0 +1,229 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "peci_engine.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/error.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+Engine::SocketLock::SocketLock(Engine& engine_, uint8_t socket_,
+                               std::chrono::milliseconds timeout) :
+    engine(engine_), socket(socket_)
+{
+    std::unique_lock lock(engine.mutex);
+    engine.released.wait_for(lock, timeout, [this]() {
+        return !engine.busy.contains(socket) ||
+               engine.lengthy.contains(socket);
+    });
+    owned = engine.busy.insert(socket).second;
+}
+
+Engine::SocketLock::~SocketLock()
+{
+    if (!owned)
+    {
+        return;
+    }
+    {
+        std::lock_guard lock(engine.mutex);
+        engine.busy.erase(socket);
+    }
+    engine.released.notify_all();
+    engine.wake.notify_all();
+}
+
+Engine::Engine(boost::asio::io_context& io, unsigned int workers) :
+    notifyDescriptor(io)
+{
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        std::cerr << "Failed to create PECI engine eventfd: "
+                  << std::strerror(errno) << '\n';
+        return;
+    }
+    notifyDescriptor.assign(fd);
+    readNotify();
+
+    for (unsigned int i = 0; i < workers; ++i)
+    {
+        this->workers.emplace_back([this]() { run(); });
+    }
+}
+
+Engine::~Engine()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers)
+    {
+        worker.join();
+    }
+
+    boost::system::error_code ec;
+    notifyDescriptor.close(ec);
+}
+
+void Engine::submit(uint8_t socket, Work work, Completion done,
+                    bool lengthy)
+{
+    if (workers.empty())
+    {
+        // No worker, run inline rather than drop the job
+        std::exception_ptr error;
+        try
+        {
+            work();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        done(error);
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        pending.push_back(
+            {socket, std::move(work), std::move(done), lengthy, nullptr});
+    }
+    wake.notify_one();
+}
+
+Engine::SocketLock Engine::lockSocket(uint8_t socket,
+                                      std::chrono::milliseconds timeout)
+{
+    return SocketLock(*this, socket, timeout);
+}
+
+bool Engine::takeJob(Job& job)
+{
+    // Jobs queued behind a busy socket's job must wait for it too, or they
+    // would overtake it
+    std::set<uint8_t> skipped;
+    for (auto it = pending.begin(); it != pending.end(); ++it)
+    {
+        if (busy.contains(it->socket) || skipped.contains(it->socket))
+        {
+            skipped.insert(it->socket);
+            continue;
+        }
+        job = std::move(*it);
+        pending.erase(it);
+        busy.insert(job.socket);
+        if (job.lengthy)
+        {
+            lengthy.insert(job.socket);
+            // A write waiting for the socket gives up rather than wait
+            released.notify_all();
+        }
+        return true;
+    }
+    return false;
+}
+
+void Engine::run()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        Job job;
+        wake.wait(lock, [&]() { return stopping || takeJob(job); });
+        if (stopping)
+        {
+            if (job.work)
+            {
+                busy.erase(job.socket);
+                lengthy.erase(job.socket);
+            }
+            return;
+        }
+        lock.unlock();
+
+        try
+        {
+            job.work();
+        }
+        catch (...)
+        {
+            job.error = std::current_exception();
+        }
+        // Drop what the work captured here, the completion keeps its own
+        job.work = nullptr;
+
+        lock.lock();
+        busy.erase(job.socket);
+        lengthy.erase(job.socket);
+        released.notify_all();
+        // Another worker may be waiting for this socket's next job
+        wake.notify_one();
+        finished.push_back(std::move(job));
+
+        uint64_t one = 1;
+        if (write(notifyDescriptor.native_handle(), &one, sizeof(one)) < 0)
+        {
+            std::cerr << "Failed to notify PECI job completion: "
+                      << std::strerror(errno) << '\n';
+        }
+    }
+}
+
+void Engine::readNotify()
+{
+    notifyDescriptor.async_read_some(
+        boost::asio::buffer(&notifyValue, sizeof(notifyValue)),
+        [this](const boost::system::error_code& ec, size_t) {
+        if (ec)
+        {
+            if (ec != boost::asio::error::operation_aborted)
+            {
+                std::cerr << "PECI engine read error: " << ec.message()
+                          << '\n';
+            }
+            return;
+        }
+
+        std::deque<Job> jobs;
+        {
+            std::lock_guard lock(mutex);
+            jobs.swap(finished);
+        }
+        for (Job& job : jobs)
+        {
+            job.done(job.error);
+        }
+        readNotify();
+    });
+}
+
+} // namespace peci
+} // namespace cpu_info
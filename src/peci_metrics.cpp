@@ -0,0 +1,374 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "peci_metrics.hpp"
+
+#include "cpuinfo.hpp"
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+// PECI completion code for a CPU in a low-power state, see Wake-on-PECI
+static constexpr uint8_t ccUnavailableResource = 0x82;
+
+const char* commandName(Command command)
+{
+    switch (command)
+    {
+        case Command::getCPUID:
+            return "GetCPUID";
+        case Command::rdPkgConfig:
+            return "RdPkgConfig";
+        case Command::wrPkgConfig:
+            return "WrPkgConfig";
+        case Command::rdIAMSR:
+            return "RdIAMSR";
+        case Command::rdPCIConfigLocal:
+            return "RdPCIConfigLocal";
+        case Command::wrPCIConfigLocal:
+            return "WrPCIConfigLocal";
+        case Command::count:
+            break;
+    }
+    return "";
+}
+
+void Histogram::record(std::chrono::nanoseconds elapsed)
+{
+    auto us = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+            .count());
+
+    latency.record(us);
+    auto bucket = std::lower_bound(latencyBucketsUs.begin(),
+                                   latencyBucketsUs.end(), us);
+    buckets[bucket - latencyBucketsUs.begin()].fetch_add(
+        1, std::memory_order_relaxed);
+}
+
+Histogram::Snapshot Histogram::snapshot() const
+{
+    phosphor::smbios::AtomicStats::Snapshot stats = latency.snapshot();
+    Snapshot ret;
+    ret.count = stats.count;
+    ret.totalUs = stats.total;
+    ret.maxUs = stats.max;
+    for (const auto& bucket : buckets)
+    {
+        ret.buckets.push_back(bucket.load(std::memory_order_relaxed));
+    }
+    return ret;
+}
+
+Metrics::Socket* Metrics::socket(uint8_t address)
+{
+    if (address < MIN_CLIENT_ADDR || address > MAX_CLIENT_ADDR)
+    {
+        return nullptr;
+    }
+    return &perSocket[address - MIN_CLIENT_ADDR];
+}
+
+const Metrics::Socket* Metrics::socket(uint8_t address) const
+{
+    if (address < MIN_CLIENT_ADDR || address > MAX_CLIENT_ADDR)
+    {
+        return nullptr;
+    }
+    return &perSocket[address - MIN_CLIENT_ADDR];
+}
+
+void Metrics::recordCommand(uint8_t address, Command command,
+                            EPECIStatus status, uint8_t cc,
+                            std::chrono::nanoseconds elapsed)
+{
+    Socket* s = socket(address);
+    if (s == nullptr)
+    {
+        return;
+    }
+    CommandStats& stats = s->commands[static_cast<size_t>(command)];
+    stats.latency.record(elapsed);
+    if (status == PECI_CC_SUCCESS && cc == PECI_DEV_CC_SUCCESS)
+    {
+        return;
+    }
+    stats.errors.fetch_add(1, std::memory_order_relaxed);
+    if (status == PECI_CC_TIMEOUT)
+    {
+        stats.timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (cc == ccUnavailableResource)
+    {
+        stats.sleeping.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::recordMailbox(uint8_t address, MailboxOutcome outcome,
+                            unsigned int busyPolls,
+                            std::chrono::nanoseconds elapsed)
+{
+    Socket* s = socket(address);
+    if (s == nullptr)
+    {
+        return;
+    }
+    MailboxStats& stats = s->mailbox;
+    stats.roundTrip.record(elapsed);
+    stats.busyPolls.fetch_add(busyPolls, std::memory_order_relaxed);
+    switch (outcome)
+    {
+        case MailboxOutcome::success:
+            break;
+        case MailboxOutcome::errorStatus:
+            stats.errors.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case MailboxOutcome::timeout:
+            stats.timeouts.fetch_add(1, std::memory_order_relaxed);
+            break;
+        case MailboxOutcome::peciFailure:
+            stats.peciFailures.fetch_add(1, std::memory_order_relaxed);
+            break;
+    }
+}
+
+void Metrics::recordWake(uint8_t address)
+{
+    if (Socket* s = socket(address))
+    {
+        s->mailbox.wakes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Metrics::recordDiscovery(uint8_t address,
+                              std::chrono::nanoseconds elapsed)
+{
+    if (Socket* s = socket(address))
+    {
+        s->discovery.record(elapsed);
+    }
+}
+
+void Metrics::recordDiscoveryPass(std::chrono::nanoseconds elapsed)
+{
+    pass.record(elapsed);
+}
+
+const Metrics::CommandStats* Metrics::command(uint8_t address,
+                                              Command command) const
+{
+    const Socket* s = socket(address);
+    return s != nullptr ? &s->commands[static_cast<size_t>(command)]
+                        : nullptr;
+}
+
+const Metrics::MailboxStats* Metrics::mailbox(uint8_t address) const
+{
+    const Socket* s = socket(address);
+    return s != nullptr ? &s->mailbox : nullptr;
+}
+
+const Histogram* Metrics::discovery(uint8_t address) const
+{
+    const Socket* s = socket(address);
+    return s != nullptr ? &s->discovery : nullptr;
+}
+
+Metrics& getMetrics()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+MeteredTransport::MeteredTransport(std::unique_ptr<Transport> transport) :
+    transport(std::move(transport))
+{}
+
+template <typename Fn>
+EPECIStatus MeteredTransport::metered(uint8_t address, Command command,
+                                      uint8_t* cc, Fn&& fn)
+{
+    auto start = std::chrono::steady_clock::now();
+    EPECIStatus status = fn();
+    getMetrics().recordCommand(address, command, status, *cc,
+                               std::chrono::steady_clock::now() - start);
+    return status;
+}
+
+EPECIStatus MeteredTransport::getCPUID(uint8_t address, CPUModel* model,
+                                       uint8_t* stepping, uint8_t* cc)
+{
+    return metered(address, Command::getCPUID, cc, [&]() {
+        return transport->getCPUID(address, model, stepping, cc);
+    });
+}
+
+EPECIStatus MeteredTransport::rdPkgConfig(uint8_t address, uint8_t index,
+                                          uint16_t param, uint8_t readLen,
+                                          uint8_t* data, uint8_t* cc)
+{
+    return metered(address, Command::rdPkgConfig, cc, [&]() {
+        return transport->rdPkgConfig(address, index, param, readLen, data,
+                                      cc);
+    });
+}
+
+EPECIStatus MeteredTransport::wrPkgConfig(uint8_t address, uint8_t index,
+                                          uint16_t param, uint32_t value,
+                                          uint8_t writeLen, uint8_t* cc)
+{
+    return metered(address, Command::wrPkgConfig, cc, [&]() {
+        return transport->wrPkgConfig(address, index, param, value, writeLen,
+                                      cc);
+    });
+}
+
+EPECIStatus MeteredTransport::rdIAMSR(uint8_t address, uint8_t thread,
+                                      uint16_t msrAddress, uint64_t* value,
+                                      uint8_t* cc)
+{
+    return metered(address, Command::rdIAMSR, cc, [&]() {
+        return transport->rdIAMSR(address, thread, msrAddress, value, cc);
+    });
+}
+
+EPECIStatus MeteredTransport::rdEndPointConfigPciLocal(
+    uint8_t address, uint8_t segment, uint8_t bus, uint8_t device,
+    uint8_t function, uint16_t reg, uint8_t readLen, uint8_t* data, uint8_t* cc)
+{
+    return metered(address, Command::rdPCIConfigLocal, cc, [&]() {
+        return transport->rdEndPointConfigPciLocal(
+            address, segment, bus, device, function, reg, readLen, data, cc);
+    });
+}
+
+EPECIStatus MeteredTransport::wrEndPointPCIConfigLocal(
+    uint8_t address, uint8_t segment, uint8_t bus, uint8_t device,
+    uint8_t function, uint16_t reg, uint8_t dataLen, uint32_t data, uint8_t* cc)
+{
+    return metered(address, Command::wrPCIConfigLocal, cc, [&]() {
+        return transport->wrEndPointPCIConfigLocal(
+            address, segment, bus, device, function, reg, dataLen, data, cc);
+    });
+}
+
+using CommandRow = std::tuple<uint8_t, std::string, uint64_t, uint64_t,
+                              uint64_t, uint64_t, uint64_t, uint64_t,
+                              std::vector<uint64_t>>;
+using MailboxRow = std::tuple<uint8_t, uint64_t, uint64_t, uint64_t, uint64_t,
+                              uint64_t, uint64_t, uint64_t, uint64_t,
+                              std::vector<uint64_t>>;
+using TimeRow = std::tuple<std::string, uint64_t, uint64_t, uint64_t,
+                           std::vector<uint64_t>>;
+
+static std::vector<CommandRow> getCommandStats()
+{
+    std::vector<CommandRow> ret;
+    const Metrics& metrics = getMetrics();
+    for (uint8_t address = MIN_CLIENT_ADDR; address <= MAX_CLIENT_ADDR;
+         ++address)
+    {
+        for (size_t index = 0; index < static_cast<size_t>(Command::count);
+             index++)
+        {
+            auto command = static_cast<Command>(index);
+            const Metrics::CommandStats* stats = metrics.command(address,
+                                                                 command);
+            Histogram::Snapshot latency = stats->latency.snapshot();
+            if (latency.count == 0)
+            {
+                continue;
+            }
+            ret.emplace_back(address, commandName(command), latency.count,
+                             stats->errors.load(std::memory_order_relaxed),
+                             stats->timeouts.load(std::memory_order_relaxed),
+                             stats->sleeping.load(std::memory_order_relaxed),
+                             latency.totalUs, latency.maxUs,
+                             std::move(latency.buckets));
+        }
+    }
+    return ret;
+}
+
+static std::vector<MailboxRow> getMailboxStats()
+{
+    std::vector<MailboxRow> ret;
+    const Metrics& metrics = getMetrics();
+    for (uint8_t address = MIN_CLIENT_ADDR; address <= MAX_CLIENT_ADDR;
+         ++address)
+    {
+        const Metrics::MailboxStats* stats = metrics.mailbox(address);
+        Histogram::Snapshot roundTrip = stats->roundTrip.snapshot();
+        uint64_t wakes = stats->wakes.load(std::memory_order_relaxed);
+        if (roundTrip.count == 0 && wakes == 0)
+        {
+            continue;
+        }
+        ret.emplace_back(address, roundTrip.count,
+                         stats->errors.load(std::memory_order_relaxed),
+                         stats->timeouts.load(std::memory_order_relaxed),
+                         stats->peciFailures.load(std::memory_order_relaxed),
+                         stats->busyPolls.load(std::memory_order_relaxed),
+                         wakes, roundTrip.totalUs, roundTrip.maxUs,
+                         std::move(roundTrip.buckets));
+    }
+    return ret;
+}
+
+static std::vector<TimeRow> getDiscoveryTimes()
+{
+    std::vector<TimeRow> ret;
+    const Metrics& metrics = getMetrics();
+    Histogram::Snapshot pass = metrics.discoveryPass().snapshot();
+    ret.emplace_back("Pass", pass.count, pass.totalUs, pass.maxUs,
+                     std::move(pass.buckets));
+    for (uint8_t address = MIN_CLIENT_ADDR; address <= MAX_CLIENT_ADDR;
+         ++address)
+    {
+        Histogram::Snapshot socket = metrics.discovery(address)->snapshot();
+        if (socket.count == 0)
+        {
+            continue;
+        }
+        ret.emplace_back("CPU" + std::to_string(address - MIN_CLIENT_ADDR),
+                         socket.count, socket.totalUs, socket.maxUs,
+                         std::move(socket.buckets));
+    }
+    return ret;
+}
+
+void registerMetrics(sdbusplus::asio::object_server& server)
+{
+    static std::shared_ptr<sdbusplus::asio::dbus_interface> iface =
+        server.add_interface(cpuInfoPath, metricsInterface);
+    iface->register_method("GetLatencyBuckets", []() {
+        return std::vector<uint64_t>(latencyBucketsUs.begin(),
+                                     latencyBucketsUs.end());
+    });
+    iface->register_method("GetCommandStats", getCommandStats);
+    iface->register_method("GetMailboxStats", getMailboxStats);
+    iface->register_method("GetDiscoveryTimes", getDiscoveryTimes);
+    iface->initialize();
+}
+
+} // namespace peci
+} // namespace cpu_info
@@ -0,0 +1,574 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "peci_sim.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+namespace cpu_info
+{
+namespace peci
+{
+
+// Completion codes that libpeci passes through from the PECI client
+static constexpr uint8_t ccUnavailableResource = 0x82;
+static constexpr uint8_t ccInvalidRequest = 0x90;
+
+// PCode OS Mailbox registers, as addressed in sst_mailbox.cpp
+static constexpr uint8_t mbBusIceLake = 14;
+static constexpr uint8_t mbBusOther = 31;
+static constexpr uint8_t mbDevice = 30;
+static constexpr uint8_t mbFunction = 1;
+static constexpr uint16_t mbDataReg = 0xA0;
+static constexpr uint16_t mbInterfaceReg = 0xA4;
+static constexpr uint32_t mbBusyBit = 1u << 31;
+static constexpr uint8_t mbSstCommand = 0x7F;
+
+enum MailboxStatus : uint8_t
+{
+    noError = 0x0,
+    invalidCommand = 0x1,
+    illegalData = 0x16,
+};
+
+// Package Config indexes
+static constexpr uint8_t pkgIdentifier = 0;
+static constexpr uint16_t pkgIdentifierMicrocode = 4;
+static constexpr uint8_t pkgWakeOnPECI = 5;
+static constexpr uint8_t pkgPPIN = 19;
+
+static constexpr uint16_t msrTurboRatioLimitCores = 0x1AE;
+
+SimSocket makeSimSocket(CPUModel model, unsigned int index)
+{
+    SimSocket cpu;
+    cpu.model = model;
+    cpu.ppin = 0x5A5A000000000000ull | (index + 1);
+    cpu.microcode = 0x2B000590;
+    // 2, 4, 8, 12, 16, 24 and 32 active cores
+    cpu.trlCores = 0x00201810'0C080402ull;
+
+    auto level = [](unsigned int cores, unsigned int tdp, unsigned int p0,
+                    unsigned int p1) {
+        SimLevel l;
+        l.tdp = tdp;
+        l.tdpRatio = p1;
+        l.coreMask = (cores >= 64) ? ~0ull : (1ull << cores) - 1;
+        for (unsigned int bucket = 0; bucket < 7; ++bucket)
+        {
+            l.turboRatios |= static_cast<uint64_t>(p0 - bucket)
+                             << (bucket * 8);
+        }
+        l.p0 = p0;
+        l.p1 = p1;
+        l.pn = 8;
+        l.pm = 5;
+        l.tProchot = 100;
+        return l;
+    };
+
+    cpu.levels.resize(5);
+    cpu.levels[0] = level(32, 350, 38, 20);
+    cpu.levels[0]->pbfSupport = true;
+    cpu.levels[0]->bfHighPriorityMask = 0x1111'1111ull;
+    cpu.levels[0]->p1Hi = 27;
+    cpu.levels[0]->p1Lo = 18;
+    cpu.levels[3] = level(28, 300, 37, 23);
+    cpu.levels[4] = level(24, 270, 36, 25);
+    return cpu;
+}
+
+std::optional<SimConfig> parseSimSpec(std::string_view spec)
+{
+    SimConfig config;
+    unsigned int socketCount = 2;
+    CPUModel model = sapphireRapids;
+    unsigned int latency = 0;
+    unsigned int busy = 0;
+    unsigned int timeouts = 0;
+    bool sleeping = false;
+
+    while (!spec.empty())
+    {
+        std::string_view item = spec.substr(0, spec.find(','));
+        spec.remove_prefix(std::min(spec.size(), item.size() + 1));
+
+        size_t eq = item.find('=');
+        std::string_view key = item.substr(0, eq);
+        std::string_view value = (eq == std::string_view::npos)
+                                     ? std::string_view{}
+                                     : item.substr(eq + 1);
+
+        auto number = [&value](unsigned int& out) {
+            auto [end, ec] = std::from_chars(value.data(),
+                                             value.data() + value.size(), out);
+            return ec == std::errc{} && end == value.data() + value.size();
+        };
+
+        bool ok = true;
+        if (key == "sockets")
+        {
+            ok = number(socketCount) &&
+                 socketCount <= MAX_CLIENT_ADDR - MIN_CLIENT_ADDR + 1;
+        }
+        else if (key == "model")
+        {
+            if (value == "icx")
+            {
+                model = iceLake;
+            }
+            else if (value == "icxd")
+            {
+                model = iceLakeD;
+            }
+            else if (value == "spr")
+            {
+                model = sapphireRapids;
+            }
+            else if (value == "emr")
+            {
+                model = emeraldRapids;
+            }
+            else
+            {
+                ok = false;
+            }
+        }
+        else if (key == "latency")
+        {
+            ok = number(latency);
+        }
+        else if (key == "busy")
+        {
+            ok = number(busy);
+        }
+        else if (key == "timeouts")
+        {
+            ok = number(timeouts);
+        }
+        else if (key == "sleeping")
+        {
+            sleeping = (value == "1");
+            ok = sleeping || value == "0";
+        }
+        else
+        {
+            ok = false;
+        }
+
+        if (!ok)
+        {
+            std::cerr << "Invalid PECI simulation setting: " << item << '\n';
+            return std::nullopt;
+        }
+    }
+
+    config.latency.fill(std::chrono::microseconds(latency));
+    for (unsigned int i = 0; i < socketCount; ++i)
+    {
+        SimSocket cpu = makeSimSocket(model, i);
+        cpu.busyCycles = busy;
+        cpu.sleeping = sleeping;
+        cpu.timeouts = timeouts;
+        config.sockets.emplace(MIN_CLIENT_ADDR + i, std::move(cpu));
+    }
+    return config;
+}
+
+SimulatedTransport::SimulatedTransport(SimConfig config) :
+    config(std::move(config))
+{
+    for (const auto& [address, cpu] : this->config.sockets)
+    {
+        sockets[address].cpu = cpu;
+    }
+}
+
+template <typename Fn>
+EPECIStatus SimulatedTransport::transact(uint8_t address, Command command,
+                                         uint8_t* cc, Fn&& fn)
+{
+    std::unique_lock busLock(busMutex, std::defer_lock);
+    if (config.sharedBus)
+    {
+        busLock.lock();
+    }
+    std::this_thread::sleep_for(
+        config.latency[static_cast<size_t>(command)]);
+
+    std::lock_guard lock(stateMutex);
+    ++counts[address][static_cast<size_t>(command)];
+    ++total;
+
+    auto socket = sockets.find(address);
+    if (socket == sockets.end())
+    {
+        return PECI_CC_CPU_NOT_PRESENT;
+    }
+    if (socket->second.cpu.timeouts > 0)
+    {
+        --socket->second.cpu.timeouts;
+        return PECI_CC_TIMEOUT;
+    }
+    *cc = PECI_DEV_CC_SUCCESS;
+    return fn(socket->second);
+}
+
+EPECIStatus SimulatedTransport::getCPUID(uint8_t address, CPUModel* model,
+                                         uint8_t* stepping, uint8_t* cc)
+{
+    return transact(address, Command::getCPUID, cc, [&](Socket& socket) {
+        *model = socket.cpu.model;
+        *stepping = socket.cpu.stepping;
+        return PECI_CC_SUCCESS;
+    });
+}
+
+EPECIStatus SimulatedTransport::rdPkgConfig(uint8_t address, uint8_t index,
+                                            uint16_t param, uint8_t readLen,
+                                            uint8_t* data, uint8_t* cc)
+{
+    return transact(address, Command::rdPkgConfig, cc, [&](Socket& socket) {
+        uint32_t value = 0;
+        if (index == pkgIdentifier && param == pkgIdentifierMicrocode)
+        {
+            value = socket.cpu.microcode;
+        }
+        else if (index == pkgWakeOnPECI)
+        {
+            value = socket.wakeOnPECI ? 1 : 0;
+        }
+        else if (index == pkgPPIN && (param == 1 || param == 2))
+        {
+            value = static_cast<uint32_t>(socket.cpu.ppin >>
+                                          (param == 2 ? 32 : 0));
+        }
+        else
+        {
+            *cc = ccInvalidRequest;
+            return PECI_CC_SUCCESS;
+        }
+        std::memcpy(data, &value, std::min<size_t>(readLen, sizeof(value)));
+        return PECI_CC_SUCCESS;
+    });
+}
+
+EPECIStatus SimulatedTransport::wrPkgConfig(uint8_t address, uint8_t index,
+                                            uint16_t param,
+                                            uint32_t /* value */,
+                                            uint8_t /* writeLen */,
+                                            uint8_t* cc)
+{
+    return transact(address, Command::wrPkgConfig, cc, [&](Socket& socket) {
+        if (index != pkgWakeOnPECI)
+        {
+            *cc = ccInvalidRequest;
+            return PECI_CC_SUCCESS;
+        }
+        // The mode is selected by the parameter, not the data
+        bool enable = (param & 1) != 0;
+        if (enable != socket.wakeOnPECI)
+        {
+            ++(enable ? socket.wakeSets : socket.wakeClears);
+        }
+        socket.wakeOnPECI = enable;
+        return PECI_CC_SUCCESS;
+    });
+}
+
+EPECIStatus SimulatedTransport::rdIAMSR(uint8_t address, uint8_t /* thread */,
+                                        uint16_t msrAddress, uint64_t* value,
+                                        uint8_t* cc)
+{
+    return transact(address, Command::rdIAMSR, cc, [&](Socket& socket) {
+        if (socket.cpu.sleeping && !socket.wakeOnPECI)
+        {
+            *cc = ccUnavailableResource;
+            return PECI_CC_DRIVER_ERR;
+        }
+        if (msrAddress != msrTurboRatioLimitCores)
+        {
+            *cc = ccInvalidRequest;
+            return PECI_CC_SUCCESS;
+        }
+        *value = socket.cpu.trlCores;
+        return PECI_CC_SUCCESS;
+    });
+}
+
+bool SimulatedTransport::mailboxTarget(const Socket& socket, uint8_t segment,
+                                       uint8_t bus, uint8_t device,
+                                       uint8_t function, uint16_t reg,
+                                       uint8_t len) const
+{
+    uint8_t mbBus = (socket.cpu.model == iceLake) ? mbBusIceLake : mbBusOther;
+    return segment == 0 && bus == mbBus && device == mbDevice &&
+           function == mbFunction &&
+           (reg == mbDataReg || reg == mbInterfaceReg) &&
+           len == sizeof(uint32_t);
+}
+
+EPECIStatus SimulatedTransport::rdEndPointConfigPciLocal(
+    uint8_t address, uint8_t segment, uint8_t bus, uint8_t device,
+    uint8_t function, uint16_t reg, uint8_t readLen, uint8_t* data, uint8_t* cc)
+{
+    return transact(address, Command::rdPCIConfigLocal, cc,
+                    [&](Socket& socket) {
+        // Observed on hardware: reads fail in the driver while sleeping
+        if (socket.cpu.sleeping && !socket.wakeOnPECI)
+        {
+            *cc = ccUnavailableResource;
+            return PECI_CC_DRIVER_ERR;
+        }
+        if (!mailboxTarget(socket, segment, bus, device, function, reg,
+                           readLen))
+        {
+            *cc = ccInvalidRequest;
+            return PECI_CC_SUCCESS;
+        }
+
+        uint32_t value = socket.dataReg;
+        if (reg == mbInterfaceReg)
+        {
+            if (socket.pending)
+            {
+                if (socket.busyLeft > 0)
+                {
+                    --socket.busyLeft;
+                }
+                else
+                {
+                    runMailboxCommand(socket);
+                }
+            }
+            value = socket.interfaceReg;
+        }
+        std::memcpy(data, &value, sizeof(value));
+        return PECI_CC_SUCCESS;
+    });
+}
+
+EPECIStatus SimulatedTransport::wrEndPointPCIConfigLocal(
+    uint8_t address, uint8_t segment, uint8_t bus, uint8_t device,
+    uint8_t function, uint16_t reg, uint8_t dataLen, uint32_t data, uint8_t* cc)
+{
+    return transact(address, Command::wrPCIConfigLocal, cc,
+                    [&](Socket& socket) {
+        // Observed on hardware: writes time out while sleeping
+        if (socket.cpu.sleeping && !socket.wakeOnPECI)
+        {
+            *cc = ccUnavailableResource;
+            return PECI_CC_TIMEOUT;
+        }
+        if (!mailboxTarget(socket, segment, bus, device, function, reg,
+                           dataLen))
+        {
+            *cc = ccInvalidRequest;
+            return PECI_CC_SUCCESS;
+        }
+
+        // PCode ignores writes while a command is running
+        if (socket.pending)
+        {
+            return PECI_CC_SUCCESS;
+        }
+        if (reg == mbDataReg)
+        {
+            socket.dataReg = data;
+        }
+        else
+        {
+            socket.interfaceReg = data;
+            if ((data & mbBusyBit) != 0)
+            {
+                socket.pending = true;
+                socket.busyLeft = socket.cpu.busyCycles;
+            }
+        }
+        return PECI_CC_SUCCESS;
+    });
+}
+
+void SimulatedTransport::runMailboxCommand(Socket& socket)
+{
+    SimSocket& cpu = socket.cpu;
+    uint8_t command = socket.interfaceReg & 0xFF;
+    uint8_t subCommand = (socket.interfaceReg >> 8) & 0xFF;
+    uint32_t param = socket.dataReg;
+    unsigned int levelParam = param & 0xFF;
+    unsigned int word = (param >> 8) & 0xFF;
+
+    const SimLevel* level = nullptr;
+    if (levelParam < cpu.levels.size() && cpu.levels[levelParam])
+    {
+        level = &*cpu.levels[levelParam];
+    }
+    auto half = [word](uint64_t value) {
+        return static_cast<uint32_t>(word == 0 ? value : value >> 32);
+    };
+
+    uint32_t result = 0;
+    MailboxStatus status = noError;
+    if (command != mbSstCommand)
+    {
+        status = invalidCommand;
+    }
+    else if (subCommand == 0x0) // GetLevelsInfo
+    {
+        result = (cpu.ppEnabled ? 1u << 31 : 0) | (cpu.locked ? 1u << 24 : 0) |
+                 (cpu.currentLevel << 16) |
+                 (static_cast<uint32_t>(cpu.levels.size() - 1) << 8) | 1;
+    }
+    else if (subCommand == 0x2) // SetConfigTdpControl
+    {
+        const auto& current = cpu.levels[cpu.currentLevel];
+        bool bf = (param & (1u << 17)) != 0;
+        bool tf = (param & (1u << 16)) != 0;
+        if (cpu.locked)
+        {
+            status = invalidCommand;
+        }
+        else if ((bf && !current->pbfSupport) || (tf && !current->factSupport))
+        {
+            status = illegalData;
+        }
+        else
+        {
+            cpu.bfEnabled = bf;
+            cpu.tfEnabled = tf;
+        }
+    }
+    else if (subCommand == 0x8) // SetLevel
+    {
+        if (cpu.locked)
+        {
+            status = invalidCommand;
+        }
+        else if (level == nullptr)
+        {
+            status = illegalData;
+        }
+        else
+        {
+            cpu.currentLevel = levelParam;
+            cpu.bfEnabled = false;
+            cpu.tfEnabled = false;
+        }
+    }
+    else if (level == nullptr)
+    {
+        // Every other command describes a level
+        status = illegalData;
+    }
+    else
+    {
+        bool current = (levelParam == cpu.currentLevel);
+        switch (subCommand)
+        {
+            case 0x1: // GetConfigTdpControl
+                result = (current && cpu.bfEnabled ? 1u << 17 : 0) |
+                         (current && cpu.tfEnabled ? 1u << 16 : 0) |
+                         (level->pbfSupport ? 1u << 1 : 0) |
+                         (level->factSupport ? 1u : 0);
+                break;
+            case 0x3: // GetTdpInfo
+                result = (level->tdpRatio << 16) | (level->tdp & 0x7FFF);
+                break;
+            case 0x5: // GetTjmaxInfo
+                result = level->tProchot & 0xFF;
+                break;
+            case 0x6: // GetCoreMask
+                result = half(level->coreMask);
+                break;
+            case 0x7: // GetTurboLimitRatios
+                result = half(level->turboRatios);
+                break;
+            case 0xC: // GetRatioInfo
+                result = (level->pm << 24) | (level->pn << 16) |
+                         (level->p1 << 8) | level->p0;
+                break;
+            case 0x20: // PbfGetCoreMaskInfo
+                result = half(level->bfHighPriorityMask);
+                status = level->pbfSupport ? noError : illegalData;
+                break;
+            case 0x21: // PbfGetP1HiP1LoInfo
+                result = (level->p1Hi << 8) | level->p1Lo;
+                status = level->pbfSupport ? noError : illegalData;
+                break;
+            default:
+                status = invalidCommand;
+                break;
+        }
+    }
+
+    socket.dataReg = result;
+    socket.interfaceReg = status;
+    socket.pending = false;
+}
+
+void SimulatedTransport::update(uint8_t address,
+                                const std::function<void(SimSocket&)>& fn)
+{
+    std::lock_guard lock(stateMutex);
+    auto socket = sockets.find(address);
+    if (socket != sockets.end())
+    {
+        fn(socket->second.cpu);
+    }
+}
+
+bool SimulatedTransport::wakeOnPECI(uint8_t address) const
+{
+    std::lock_guard lock(stateMutex);
+    auto socket = sockets.find(address);
+    return socket != sockets.end() && socket->second.wakeOnPECI;
+}
+
+std::pair<uint64_t, uint64_t>
+    SimulatedTransport::wakeTransitions(uint8_t address) const
+{
+    std::lock_guard lock(stateMutex);
+    auto socket = sockets.find(address);
+    if (socket == sockets.end())
+    {
+        return {0, 0};
+    }
+    return {socket->second.wakeSets, socket->second.wakeClears};
+}
+
+uint64_t SimulatedTransport::transactions(uint8_t address,
+                                          Command command) const
+{
+    std::lock_guard lock(stateMutex);
+    auto count = counts.find(address);
+    if (count == counts.end())
+    {
+        return 0;
+    }
+    return count->second[static_cast<size_t>(command)];
+}
+
+uint64_t SimulatedTransport::transactions() const
+{
+    return total;
+}
+
+} // namespace peci
+} // namespace cpu_info
@@ -0,0 +1,89 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "peci_transport.hpp"
+
+#include "peci_metrics.hpp"
+
+namespace cpu_info
+{
+namespace peci
+{
+
+EPECIStatus LibPECITransport::getCPUID(uint8_t address, CPUModel* model,
+                                       uint8_t* stepping, uint8_t* cc)
+{
+    return peci_GetCPUID(address, model, stepping, cc);
+}
+
+EPECIStatus LibPECITransport::rdPkgConfig(uint8_t address, uint8_t index,
+                                          uint16_t param, uint8_t readLen,
+                                          uint8_t* data, uint8_t* cc)
+{
+    return peci_RdPkgConfig(address, index, param, readLen, data, cc);
+}
+
+EPECIStatus LibPECITransport::wrPkgConfig(uint8_t address, uint8_t index,
+                                          uint16_t param, uint32_t value,
+                                          uint8_t writeLen, uint8_t* cc)
+{
+    return peci_WrPkgConfig(address, index, param, value, writeLen, cc);
+}
+
+EPECIStatus LibPECITransport::rdIAMSR(uint8_t address, uint8_t thread,
+                                      uint16_t msrAddress, uint64_t* value,
+                                      uint8_t* cc)
+{
+    return peci_RdIAMSR(address, thread, msrAddress, value, cc);
+}
+
+EPECIStatus LibPECITransport::rdEndPointConfigPciLocal(
+    uint8_t address, uint8_t segment, uint8_t bus, uint8_t device,
+    uint8_t function, uint16_t reg, uint8_t readLen, uint8_t* data, uint8_t* cc)
+{
+    return peci_RdEndPointConfigPciLocal(address, segment, bus, device,
+                                         function, reg, readLen, data, cc);
+}
+
+EPECIStatus LibPECITransport::wrEndPointPCIConfigLocal(
+    uint8_t address, uint8_t segment, uint8_t bus, uint8_t device,
+    uint8_t function, uint16_t reg, uint8_t dataLen, uint32_t data, uint8_t* cc)
+{
+    return peci_WrEndPointPCIConfigLocal(address, segment, bus, device,
+                                         function, reg, dataLen, data, cc);
+}
+
+static std::unique_ptr<Transport>& transportInstance()
+{
+    static std::unique_ptr<Transport> transport =
+        std::make_unique<MeteredTransport>(
+            std::make_unique<LibPECITransport>());
+    return transport;
+}
+
+Transport& getTransport()
+{
+    return *transportInstance();
+}
+
+void setTransport(std::unique_ptr<Transport> transport)
+{
+    transportInstance() =
+        std::make_unique<MeteredTransport>(std::move(transport));
+}
+
+} // namespace peci
+} // namespace cpu_info
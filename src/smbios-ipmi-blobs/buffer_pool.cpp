@@ -0,0 +1,79 @@
+#include "buffer_pool.hpp"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <utility>
+
+namespace blobs
+{
+
+bool StagingBuffer::write(size_t offset, const uint8_t* data, size_t length)
+{
+    if (!storage || offset > bufferCapacity ||
+        length > bufferCapacity - offset)
+    {
+        return false;
+    }
+
+    /* Only the hole between the written extent and the new data needs to be
+     * defined, everything else is either already written or overwritten now.
+     */
+    if (offset > extent)
+    {
+        std::memset(storage.get() + extent, 0, offset - extent);
+    }
+
+    std::memcpy(storage.get() + offset, data, length);
+    if (offset + length > extent)
+    {
+        extent = offset + length;
+    }
+    return true;
+}
+
+StagingBufferPool::StagingBufferPool(size_t bufferSize, size_t maxIdle) :
+    maxIdle(maxIdle)
+{
+    long pageSize = sysconf(_SC_PAGESIZE);
+    alignment = pageSize > 0 ? static_cast<size_t>(pageSize) : 4096;
+    alignedSize = (bufferSize + alignment - 1) / alignment * alignment;
+    if (alignedSize == 0)
+    {
+        alignedSize = alignment;
+    }
+    idle.reserve(maxIdle);
+}
+
+StagingBuffer StagingBufferPool::acquire()
+{
+    if (!idle.empty())
+    {
+        StagingBuffer buffer = std::move(idle.back());
+        idle.pop_back();
+        buffer.clear();
+        return buffer;
+    }
+
+    auto data =
+        static_cast<uint8_t*>(std::aligned_alloc(alignment, alignedSize));
+    if (data == nullptr)
+    {
+        return StagingBuffer();
+    }
+    return StagingBuffer(data, alignedSize);
+}
+
+void StagingBufferPool::release(StagingBuffer&& buffer)
+{
+    if (!buffer.valid() || buffer.capacity() != alignedSize ||
+        idle.size() >= maxIdle)
+    {
+        return;
+    }
+
+    buffer.clear();
+    idle.emplace_back(std::move(buffer));
+}
+
+} // namespace blobs
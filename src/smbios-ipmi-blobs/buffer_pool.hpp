@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace blobs
+{
+
+/**
+ * Page-aligned staging buffer handed out by StagingBufferPool.
+ *
+ * The buffer tracks the extent of the data written so far instead of sizing
+ * (and zero-filling) a container on every write. Bytes in [0, size()) are
+ * always defined: a write that starts past the current extent zeroes only the
+ * gap in between.
+ */
+class StagingBuffer
+{
+  public:
+    StagingBuffer() = default;
+    StagingBuffer(uint8_t* data, size_t capacity) :
+        storage(data), bufferCapacity(capacity)
+    {}
+
+    /** @brief Copy data into the buffer at the given offset.
+     *  @return false if the data does not fit in the buffer capacity.
+     */
+    bool write(size_t offset, const uint8_t* data, size_t length);
+
+    /** @brief Forget all written data without touching the memory. */
+    void clear()
+    {
+        extent = 0;
+    }
+
+    const uint8_t* data() const
+    {
+        return storage.get();
+    }
+
+    /** @brief Size of the written extent. */
+    size_t size() const
+    {
+        return extent;
+    }
+
+    size_t capacity() const
+    {
+        return bufferCapacity;
+    }
+
+    bool valid() const
+    {
+        return storage != nullptr;
+    }
+
+  private:
+    struct FreeDeleter
+    {
+        void operator()(uint8_t* ptr) const
+        {
+            std::free(ptr);
+        }
+    };
+
+    std::unique_ptr<uint8_t, FreeDeleter> storage;
+    size_t bufferCapacity = 0;
+    size_t extent = 0;
+};
+
+/**
+ * Small pool of reusable staging buffers, kept alive across blob sessions so
+ * that a long-running ipmid does not allocate and free a full table-sized
+ * buffer on every upload.
+ */
+class StagingBufferPool
+{
+  public:
+    /** @brief Constructs a pool of buffers.
+     *  @param bufferSize Minimum capacity of every buffer, rounded up to a
+     *                    whole number of pages.
+     *  @param maxIdle    Maximum number of released buffers kept for reuse.
+     */
+    StagingBufferPool(size_t bufferSize, size_t maxIdle);
+
+    /** @brief Take a buffer from the pool, allocating one if none is idle.
+     *  @return An empty buffer, or an invalid one if allocation failed.
+     */
+    StagingBuffer acquire();
+
+    /** @brief Return a buffer to the pool for reuse. */
+    void release(StagingBuffer&& buffer);
+
+    size_t bufferSize() const
+    {
+        return alignedSize;
+    }
+
+    size_t idleCount() const
+    {
+        return idle.size();
+    }
+
+  private:
+    size_t alignment;
+    size_t alignedSize;
+    size_t maxIdle;
+    std::vector<StagingBuffer> idle;
+};
+
+} // namespace blobs
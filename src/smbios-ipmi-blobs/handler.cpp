@@ -2,6 +2,7 @@
 
 #include "mdrv2.hpp"
 #include "smbios_mdrv2.hpp"
+#include "smbios_persist.hpp"
 
 #include <sys/stat.h>
 #include <unistd.h>
@@ -16,9 +17,10 @@
 #include <cstdint>
 #include <ctime>
 #include <filesystem>
-#include <fstream>
 #include <memory>
+#include <span>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace blobs
@@ -109,7 +111,16 @@ bool SmbiosBlobHandler::open(uint16_t session, uint16_t flags,
     {
         return false;
     }
-    blobPtr = std::make_unique<SmbiosBlob>(session, path, flags);
+
+    StagingBuffer buffer = bufferPool.acquire();
+    if (!buffer.valid())
+    {
+        phosphor::logging::log<phosphor::logging::level::ERR>(
+            "Failed to allocate SMBIOS staging buffer");
+        return false;
+    }
+    blobPtr = std::make_unique<SmbiosBlob>(session, path, flags,
+                                           std::move(buffer));
     return true;
 }
 
@@ -149,15 +160,7 @@ bool SmbiosBlobHandler::write(uint16_t session, uint32_t offset,
         return false;
     }
 
-    /* Resize the buffer if what we're writing will go over the size */
-    uint32_t newBufferSize = data.size() + offset;
-    if (newBufferSize > blobPtr->buffer.size())
-    {
-        blobPtr->buffer.resize(newBufferSize);
-    }
-
-    std::memcpy(blobPtr->buffer.data() + offset, data.data(), data.size());
-    return true;
+    return blobPtr->buffer.write(offset, data.data(), data.size());
 }
 
 bool SmbiosBlobHandler::writeMeta(uint16_t /* session */, uint32_t /* offset */,
@@ -213,35 +216,19 @@ bool SmbiosBlobHandler::commit(uint16_t session,
         }
     }
 
-    try
-    {
-        std::ofstream smbiosFile(mdrDefaultFile,
-                                 std::ios_base::binary | std::ios_base::trunc);
-        if (!smbiosFile.good())
-        {
-            phosphor::logging::log<phosphor::logging::level::ERR>(
-                "Write data from flash error - Open SMBIOS table file failure");
-            blobPtr->state |= blobs::StateFlags::commit_error;
-            return false;
-        }
-
-        smbiosFile.exceptions(std::ofstream::badbit | std::ofstream::failbit);
-
-        smbiosFile.write(reinterpret_cast<char*>(&mdrHdr),
-                         sizeof(MDRSMBIOSHeader));
-        smbiosFile.write(reinterpret_cast<char*>(blobPtr->buffer.data()),
-                         mdrHdr.dataSize);
-        smbiosFile.close();
-        blobPtr->state |= blobs::StateFlags::committing;
-    }
-    catch (const std::ofstream::failure& e)
+    /* The table is written to a temporary file and renamed over the live one,
+     * so a power loss during commit never leaves a torn table behind.
+     */
+    if (!phosphor::smbios::writeTableFile(
+            mdrDefaultFile, mdrHdr,
+            std::span(blobPtr->buffer.data(), blobPtr->buffer.size())))
     {
         phosphor::logging::log<phosphor::logging::level::ERR>(
-            "Write data from flash error - write data error",
-            phosphor::logging::entry("ERROR=%s", e.what()));
+            "Write data from flash error - write data error");
         blobPtr->state |= blobs::StateFlags::commit_error;
         return false;
     }
+    blobPtr->state |= blobs::StateFlags::committing;
 
     if (!internal::syncSmbiosData())
     {
@@ -257,6 +244,12 @@ bool SmbiosBlobHandler::commit(uint16_t session,
     return true;
 }
 
+void SmbiosBlobHandler::releaseBlob()
+{
+    bufferPool.release(std::move(blobPtr->buffer));
+    blobPtr = nullptr;
+}
+
 bool SmbiosBlobHandler::close(uint16_t session)
 {
     if (!blobPtr || blobPtr->sessionId != session)
@@ -264,7 +257,7 @@ bool SmbiosBlobHandler::close(uint16_t session)
         return false;
     }
 
-    blobPtr = nullptr;
+    releaseBlob();
     return true;
 }
 
@@ -1,10 +1,14 @@
 #pragma once
 
+#include "buffer_pool.hpp"
+#include "config.h"
+
 #include <blobs-ipmid/blobs.hpp>
 
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace blobs
@@ -13,7 +17,10 @@ namespace blobs
 class SmbiosBlobHandler : public GenericBlobInterface
 {
   public:
-    SmbiosBlobHandler() = default;
+    SmbiosBlobHandler() : SmbiosBlobHandler(defaultMaxBufferSize) {}
+    explicit SmbiosBlobHandler(uint32_t maxTableSize) :
+        maxBufferSize(maxTableSize), bufferPool(maxTableSize, maxIdleBuffers)
+    {}
     ~SmbiosBlobHandler() = default;
     SmbiosBlobHandler(const SmbiosBlobHandler&) = delete;
     SmbiosBlobHandler& operator=(const SmbiosBlobHandler&) = delete;
@@ -22,16 +29,15 @@ class SmbiosBlobHandler : public GenericBlobInterface
 
     struct SmbiosBlob
     {
-        SmbiosBlob(uint16_t id, const std::string& path, uint16_t flags) :
-            sessionId(id), blobId(path), state(0)
+        SmbiosBlob(uint16_t id, const std::string& path, uint16_t flags,
+                   StagingBuffer&& stagingBuffer) :
+            sessionId(id), blobId(path), state(0),
+            buffer(std::move(stagingBuffer))
         {
             if (flags & blobs::OpenFlags::write)
             {
                 state |= blobs::StateFlags::open_write;
             }
-
-            /* Pre-allocate the buffer.capacity() with maxBufferSize */
-            buffer.reserve(maxBufferSize);
         }
 
         /* The blob handler session id. */
@@ -43,8 +49,8 @@ class SmbiosBlobHandler : public GenericBlobInterface
         /* The current state. */
         uint16_t state;
 
-        /* The staging buffer. */
-        std::vector<uint8_t> buffer;
+        /* The staging buffer, borrowed from the handler's pool. */
+        StagingBuffer buffer;
     };
 
     bool canHandleBlob(const std::string& path) override;
@@ -67,8 +73,20 @@ class SmbiosBlobHandler : public GenericBlobInterface
   private:
     static constexpr char blobId[] = "/smbios";
 
+    /* Default SMBIOS table storage size, the same as MDRV2's */
+    static constexpr uint32_t defaultMaxBufferSize = SMBIOS_TABLE_STORAGE_SIZE;
+
+    /* Released staging buffers kept for the next session */
+    static constexpr size_t maxIdleBuffers = 2;
+
+    /* Return the staging buffer of the open blob to the pool and drop it. */
+    void releaseBlob();
+
     /* SMBIOS table storage size */
-    static constexpr uint32_t maxBufferSize = 64 * 1024;
+    uint32_t maxBufferSize;
+
+    /* Staging buffers shared by all sessions of this handler. */
+    StagingBufferPool bufferPool;
 
     /* The handler only allows one open blob. */
     std::unique_ptr<SmbiosBlob> blobPtr = nullptr;
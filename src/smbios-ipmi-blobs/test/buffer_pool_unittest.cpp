@@ -0,0 +1,70 @@
+#include "buffer_pool.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace blobs
+{
+
+class StagingBufferPoolTest : public ::testing::Test
+{
+  protected:
+    StagingBufferPool pool{64 * 1024, 2};
+};
+
+TEST_F(StagingBufferPoolTest, BuffersArePageAligned)
+{
+    StagingBuffer buffer = pool.acquire();
+
+    ASSERT_TRUE(buffer.valid());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer.data()) % 4096, 0u);
+    EXPECT_GE(buffer.capacity(), 64u * 1024);
+    EXPECT_EQ(buffer.size(), 0u);
+}
+
+TEST_F(StagingBufferPoolTest, ReleasedBufferIsReused)
+{
+    StagingBuffer buffer = pool.acquire();
+    const uint8_t* data = buffer.data();
+    pool.release(std::move(buffer));
+    EXPECT_EQ(pool.idleCount(), 1u);
+
+    StagingBuffer again = pool.acquire();
+    EXPECT_EQ(again.data(), data);
+    EXPECT_EQ(again.size(), 0u);
+    EXPECT_EQ(pool.idleCount(), 0u);
+}
+
+TEST_F(StagingBufferPoolTest, WriteBeyondCapacityFails)
+{
+    StagingBuffer buffer = pool.acquire();
+    std::vector<uint8_t> data = {0x01, 0x02};
+
+    EXPECT_FALSE(buffer.write(buffer.capacity() - 1, data.data(), data.size()));
+    EXPECT_EQ(buffer.size(), 0u);
+}
+
+TEST_F(StagingBufferPoolTest, GapBeforeWriteIsZeroed)
+{
+    // Dirty a buffer, then reuse it for a sparse write.
+    StagingBuffer buffer = pool.acquire();
+    std::vector<uint8_t> dirty(16, 0xff);
+    EXPECT_TRUE(buffer.write(0, dirty.data(), dirty.size()));
+    pool.release(std::move(buffer));
+
+    StagingBuffer reused = pool.acquire();
+    std::vector<uint8_t> data = {0x11};
+    EXPECT_TRUE(reused.write(8, data.data(), data.size()));
+
+    ASSERT_EQ(reused.size(), 9u);
+    for (size_t i = 0; i < 8; i++)
+    {
+        EXPECT_EQ(reused.data()[i], 0);
+    }
+    EXPECT_EQ(reused.data()[8], 0x11);
+}
+
+} // namespace blobs
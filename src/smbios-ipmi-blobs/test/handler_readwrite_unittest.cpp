@@ -83,6 +83,18 @@ TEST_F(SmbiosBlobHandlerReadWriteTest, WritingOneByteToTheLastOffsetSucceeds)
     EXPECT_TRUE(handler.write(session, handlerMaxBufferSize - 1, data));
 }
 
+TEST_F(SmbiosBlobHandlerReadWriteTest, ConfiguredTableSizeIsEnforced)
+{
+    const uint32_t tableSize = 1024;
+    SmbiosBlobHandler smallHandler(tableSize);
+    std::vector<uint8_t> data(tableSize, 0x01);
+
+    EXPECT_TRUE(
+        smallHandler.open(session, blobs::OpenFlags::write, expectedBlobId));
+    EXPECT_TRUE(smallHandler.write(session, 0, data));
+    EXPECT_FALSE(smallHandler.write(session, 1, data));
+}
+
 TEST_F(SmbiosBlobHandlerReadWriteTest, ReadAlwaysReturnsEmpty)
 {
     const uint32_t testOffset = 0;
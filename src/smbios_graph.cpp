@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "smbios_graph.hpp"
+
+#include "smbios_mdrv2.hpp"
+
+#include <cstring>
+#include <map>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+// Offsets in the formatted area of the structures the graph follows
+static constexpr size_t boardObjectCountOffset = 0x0e;
+static constexpr size_t boardObjectHandlesOffset = 0x0f;
+static constexpr size_t firmwareComponentCountOffset = 0x17;
+static constexpr size_t firmwareComponentHandlesOffset = 0x18;
+static constexpr size_t deviceArrayHandleOffset = 0x04;
+
+HandleGraph::HandleGraph(std::span<uint8_t> table,
+                         std::pmr::memory_resource* resource) :
+    table(table), structures(table, resource), containers(resource),
+    firmwareComponents(resource), memoryArrays(resource)
+{
+    for (const auto& entry : structures.entries())
+    {
+        switch (entry.type)
+        {
+            case baseboardType:
+                addBoard(entry);
+                break;
+            case firmwareInventoryInformationType:
+                addFirmware(entry);
+                break;
+            case memoryDeviceType:
+                addMemoryDevice(entry);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+uint8_t* HandleGraph::structure(uint16_t handle) const
+{
+    const StructureEntry* entry = structures.find(handle);
+    if (entry == nullptr)
+    {
+        return nullptr;
+    }
+    return table.data() + entry->offset;
+}
+
+const Containment* HandleGraph::container(uint16_t handle) const
+{
+    auto it = containers.find(handle);
+    if (it == containers.end())
+    {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+std::span<const uint16_t> HandleGraph::components(
+    uint16_t firmwareHandle) const
+{
+    auto it = firmwareComponents.find(firmwareHandle);
+    if (it == firmwareComponents.end())
+    {
+        return {};
+    }
+    return it->second;
+}
+
+std::optional<uint16_t> HandleGraph::memoryArray(uint16_t deviceHandle) const
+{
+    auto it = memoryArrays.find(deviceHandle);
+    if (it == memoryArrays.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+std::optional<uint16_t> HandleGraph::handleAt(const StructureEntry& entry,
+                                              size_t offset) const
+{
+    uint8_t length = table[entry.offset + 1];
+    if (offset + sizeof(uint16_t) > length)
+    {
+        return std::nullopt;
+    }
+
+    uint16_t handle;
+    std::memcpy(&handle, table.data() + entry.offset + offset, sizeof(handle));
+    return handle;
+}
+
+void HandleGraph::addBoard(const StructureEntry& board)
+{
+    uint8_t length = table[board.offset + 1];
+    if (length <= boardObjectCountOffset)
+    {
+        return;
+    }
+
+    // Boards are visited in table order, so the first board listing a handle
+    // keeps it.
+    std::pmr::map<uint8_t, size_t> typeCount(
+        containers.get_allocator().resource());
+    uint8_t count = table[board.offset + boardObjectCountOffset];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        auto handle = handleAt(board,
+                               boardObjectHandlesOffset + i * sizeof(uint16_t));
+        if (!handle)
+        {
+            break;
+        }
+
+        const StructureEntry* object = structures.find(*handle);
+        if (object == nullptr)
+        {
+            continue;
+        }
+        containers.try_emplace(
+            *handle, Containment{board.handle, typeCount[object->type]});
+        typeCount[object->type]++;
+    }
+}
+
+void HandleGraph::addFirmware(const StructureEntry& firmware)
+{
+    uint8_t length = table[firmware.offset + 1];
+    if (length <= firmwareComponentCountOffset)
+    {
+        return;
+    }
+
+    std::pmr::vector<uint16_t> handles(
+        firmwareComponents.get_allocator().resource());
+    uint8_t count = table[firmware.offset + firmwareComponentCountOffset];
+    for (uint8_t i = 0; i < count; i++)
+    {
+        auto handle = handleAt(firmware, firmwareComponentHandlesOffset +
+                                             i * sizeof(uint16_t));
+        if (!handle)
+        {
+            break;
+        }
+        if (structures.find(*handle) != nullptr)
+        {
+            handles.push_back(*handle);
+        }
+    }
+
+    if (!handles.empty())
+    {
+        firmwareComponents.try_emplace(firmware.handle, std::move(handles));
+    }
+}
+
+void HandleGraph::addMemoryDevice(const StructureEntry& device)
+{
+    auto handle = handleAt(device, deviceArrayHandleOffset);
+    if (!handle)
+    {
+        return;
+    }
+
+    const StructureEntry* array = structures.find(*handle);
+    if (array != nullptr && array->type == physicalMemoryArrayType)
+    {
+        memoryArrays.try_emplace(device.handle, *handle);
+    }
+}
+
+} // namespace smbios
+} // namespace phosphor
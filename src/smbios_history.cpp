@@ -0,0 +1,200 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "smbios_history.hpp"
+
+#include "smbios_persist.hpp"
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <utility>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+// <sequence>-<hash>, both fixed width so that names sort by sequence
+static constexpr size_t sequenceDigits = 10;
+static constexpr size_t hashDigits = 16;
+
+uint64_t tableHash(std::span<const uint8_t> data)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (uint8_t byte : data)
+    {
+        hash ^= byte;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static bool parseGenerationName(const std::string& name,
+                                TableHistory::Generation& generation)
+{
+    if (name.size() != sequenceDigits + 1 + hashDigits ||
+        name[sequenceDigits] != '-')
+    {
+        return false;
+    }
+
+    const char* begin = name.data();
+    const char* end = begin + sequenceDigits;
+    auto seq = std::from_chars(begin, end, generation.sequence);
+    if (seq.ec != std::errc() || seq.ptr != end)
+    {
+        return false;
+    }
+
+    begin = end + 1;
+    end = name.data() + name.size();
+    auto hash = std::from_chars(begin, end, generation.hash, 16);
+    return hash.ec == std::errc() && hash.ptr == end;
+}
+
+TableHistory::TableHistory(std::string directory, size_t depth) :
+    directory(std::move(directory)), depth(depth)
+{}
+
+std::string TableHistory::generationPath(const Generation& generation) const
+{
+    char name[sequenceDigits + 1 + hashDigits + 1];
+    std::snprintf(name, sizeof(name), "%010u-%016llx", generation.sequence,
+                  static_cast<unsigned long long>(generation.hash));
+    return directory + "/" + name;
+}
+
+void TableHistory::scan()
+{
+    if (scanned)
+    {
+        return;
+    }
+    scanned = true;
+
+    std::error_code ec;
+    for (const auto& file : std::filesystem::directory_iterator(directory, ec))
+    {
+        Generation generation{};
+        if (!parseGenerationName(file.path().filename().string(), generation))
+        {
+            continue;
+        }
+
+        MDRSMBIOSHeader header{};
+        std::ifstream stream(file.path(), std::ios_base::binary);
+        stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if (!stream.good())
+        {
+            continue;
+        }
+        generation.timestamp = header.timestamp;
+        ring.push_back(generation);
+    }
+
+    std::ranges::sort(ring, {}, &Generation::sequence);
+}
+
+const std::vector<TableHistory::Generation>& TableHistory::generations()
+{
+    scan();
+    return ring;
+}
+
+bool TableHistory::record(const MDRSMBIOSHeader& header,
+                          std::span<const uint8_t> data)
+{
+    scan();
+
+    Generation generation{};
+    generation.sequence = ring.empty() ? 1 : ring.back().sequence + 1;
+    generation.timestamp = header.timestamp;
+    generation.hash = tableHash(data);
+
+    auto existing = std::ranges::find(ring, generation.hash, &Generation::hash);
+    if (existing != ring.end())
+    {
+        if (std::next(existing) == ring.end())
+        {
+            // Already the newest generation, e.g. the same table after reboot
+            return true;
+        }
+
+        // The table went back to an older generation, move it to the front
+        // of the ring instead of storing it twice. It is written again rather
+        // than renamed so its header carries the new timestamp.
+        if (!writeTableFile(generationPath(generation), header, data))
+        {
+            return false;
+        }
+        removeTableFile(generationPath(*existing));
+        ring.erase(existing);
+        ring.push_back(generation);
+        return true;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(directory, ec);
+    if (ec)
+    {
+        lg2::error("Failed to create SMBIOS history directory {DIR}: {ERR}",
+                   "DIR", directory, "ERR", ec.message());
+        return false;
+    }
+
+    if (!writeTableFile(generationPath(generation), header, data))
+    {
+        return false;
+    }
+    ring.push_back(generation);
+
+    while (ring.size() > depth)
+    {
+        removeTableFile(generationPath(ring.front()));
+        ring.erase(ring.begin());
+    }
+    return true;
+}
+
+bool TableHistory::load(uint32_t sequence, std::vector<uint8_t>& data)
+{
+    scan();
+
+    auto generation = std::ranges::find(ring, sequence, &Generation::sequence);
+    if (generation == ring.end())
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> content;
+    if (!readFile(generationPath(*generation), content) ||
+        content.size() < sizeof(MDRSMBIOSHeader))
+    {
+        return false;
+    }
+
+    data.assign(content.begin() + sizeof(MDRSMBIOSHeader), content.end());
+    return true;
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "smbios_index.hpp"
+
+#include "smbios_mdrv2.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+static constexpr uint8_t endOfTableType = 127;
+
+static size_t structureTableOffset(std::span<const uint8_t> table)
+{
+    if (table.size() < sizeof(EntryPointStructure30))
+    {
+        return 0;
+    }
+
+    std::string_view anchor(reinterpret_cast<const char*>(table.data()),
+                            anchorString30.length());
+    if (anchor != anchorString30)
+    {
+        return 0;
+    }
+
+    EntryPointStructure30 ep;
+    std::memcpy(&ep, table.data(), sizeof(ep));
+    if (ep.structTableAddr < mdrSMBIOSSize &&
+        ep.structTableAddr < table.size())
+    {
+        return static_cast<size_t>(ep.structTableAddr);
+    }
+    return 0;
+}
+
+StructureIndex::StructureIndex(std::span<const uint8_t> table,
+                               std::pmr::memory_resource* resource) :
+    structures(resource), handles(resource)
+{
+    size_t offset = structureTableOffset(table);
+
+    while (offset + sizeof(StructureHeader) <= table.size())
+    {
+        StructureHeader header;
+        std::memcpy(&header, table.data() + offset, sizeof(header));
+        if (header.length < sizeof(StructureHeader) ||
+            offset + header.length > table.size())
+        {
+            break;
+        }
+
+        // The string-set ends with a double null, an empty one is just the
+        // double null itself.
+        size_t end = offset + header.length;
+        while (end + 1 < table.size() &&
+               (table[end] != 0 || table[end + 1] != 0))
+        {
+            end++;
+        }
+        if (end + 1 >= table.size())
+        {
+            break;
+        }
+        end += separateLen;
+
+        uint16_t handle = header.handle;
+        handles.emplace(handle, structures.size());
+        structures.push_back(
+            StructureEntry{handle, header.type, offset, end - offset});
+
+        if (header.type == endOfTableType)
+        {
+            break;
+        }
+        offset = end;
+    }
+}
+
+const StructureEntry* StructureIndex::find(uint16_t handle) const
+{
+    auto it = handles.find(handle);
+    if (it == handles.end())
+    {
+        return nullptr;
+    }
+    return &structures[it->second];
+}
+
+std::vector<const StructureEntry*> StructureIndex::ofType(uint8_t type) const
+{
+    std::vector<const StructureEntry*> ret;
+    for (const auto& entry : structures)
+    {
+        if (entry.type == type)
+        {
+            ret.push_back(&entry);
+        }
+    }
+    return ret;
+}
+
+std::vector<StructureDiff> diffTables(std::span<const uint8_t> oldTable,
+                                      const StructureIndex& oldIndex,
+                                      std::span<const uint8_t> newTable,
+                                      const StructureIndex& newIndex)
+{
+    std::vector<StructureDiff> ret;
+
+    for (const auto& oldEntry : oldIndex.entries())
+    {
+        const StructureEntry* newEntry = newIndex.find(oldEntry.handle);
+        if (newEntry == nullptr || newEntry->type != oldEntry.type)
+        {
+            ret.push_back(StructureDiff{StructureChange::removed,
+                                        oldEntry.handle, oldEntry.type});
+            continue;
+        }
+
+        auto oldBytes = oldTable.subspan(oldEntry.offset, oldEntry.size);
+        auto newBytes = newTable.subspan(newEntry->offset, newEntry->size);
+        if (!std::ranges::equal(oldBytes, newBytes))
+        {
+            ret.push_back(StructureDiff{StructureChange::modified,
+                                        oldEntry.handle, oldEntry.type});
+        }
+    }
+
+    for (const auto& newEntry : newIndex.entries())
+    {
+        const StructureEntry* oldEntry = oldIndex.find(newEntry.handle);
+        if (oldEntry == nullptr || oldEntry->type != newEntry.type)
+        {
+            ret.push_back(StructureDiff{StructureChange::added, newEntry.handle,
+                                        newEntry.type});
+        }
+    }
+
+    std::ranges::stable_sort(ret, {}, &StructureDiff::handle);
+    return ret;
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -0,0 +1,223 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "smbios_persist.hpp"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+static bool writeAll(int fd, std::span<const uint8_t> data)
+{
+    while (!data.empty())
+    {
+        ssize_t written = ::write(fd, data.data(), data.size());
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data = data.subspan(static_cast<size_t>(written));
+    }
+    return true;
+}
+
+static bool syncDirectory(const std::string& path)
+{
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    if (dir.empty())
+    {
+        dir = ".";
+    }
+
+    int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        lg2::error("Failed to open directory {DIR}: {ERRNO}", "DIR", dir,
+                   "ERRNO", errno);
+        return false;
+    }
+
+    bool ret = ::fsync(fd) == 0;
+    if (!ret)
+    {
+        lg2::error("Failed to sync directory {DIR}: {ERRNO}", "DIR", dir,
+                   "ERRNO", errno);
+    }
+    ::close(fd);
+    return ret;
+}
+
+bool writeFileAtomic(const std::string& path,
+                     std::initializer_list<std::span<const uint8_t>> parts)
+{
+    std::string tmpPath = path + ".tmp";
+
+    int fd = ::open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                    S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    if (fd < 0)
+    {
+        lg2::error("Failed to create {FILE}: {ERRNO}", "FILE", tmpPath,
+                   "ERRNO", errno);
+        return false;
+    }
+
+    bool ok = std::all_of(parts.begin(), parts.end(),
+                          [fd](std::span<const uint8_t> part) {
+        return writeAll(fd, part);
+    });
+    if (!ok)
+    {
+        lg2::error("Failed to write {FILE}: {ERRNO}", "FILE", tmpPath, "ERRNO",
+                   errno);
+    }
+    else if (::fsync(fd) != 0)
+    {
+        lg2::error("Failed to sync {FILE}: {ERRNO}", "FILE", tmpPath, "ERRNO",
+                   errno);
+        ok = false;
+    }
+
+    if (::close(fd) != 0)
+    {
+        ok = false;
+    }
+
+    if (ok && ::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        lg2::error("Failed to rename {FROM} to {TO}: {ERRNO}", "FROM", tmpPath,
+                   "TO", path, "ERRNO", errno);
+        ok = false;
+    }
+
+    if (!ok)
+    {
+        ::unlink(tmpPath.c_str());
+        return false;
+    }
+
+    return syncDirectory(path);
+}
+
+bool writeTableFile(const std::string& path, const MDRSMBIOSHeader& header,
+                    std::span<const uint8_t> data)
+{
+    if (header.dataSize != data.size())
+    {
+        lg2::error("MDR header size {HDR} does not match data size {SIZE}",
+                   "HDR", header.dataSize, "SIZE", data.size());
+        return false;
+    }
+
+    return writeFileAtomic(
+        path, {std::span(reinterpret_cast<const uint8_t*>(&header),
+                         sizeof(MDRSMBIOSHeader)),
+               data});
+}
+
+bool readFile(const std::string& path, std::vector<uint8_t>& content)
+{
+    std::ifstream file(path, std::ios_base::binary | std::ios_base::ate);
+    if (!file.good())
+    {
+        return false;
+    }
+
+    std::streamsize size = file.tellg();
+    if (size < 0)
+    {
+        return false;
+    }
+    file.seekg(0, std::ios_base::beg);
+    content.resize(static_cast<size_t>(size));
+    file.read(reinterpret_cast<char*>(content.data()), size);
+    return file.good();
+}
+
+bool removeTableFile(const std::string& path)
+{
+    if (::unlink(path.c_str()) != 0 && errno != ENOENT)
+    {
+        lg2::error("Failed to remove {FILE}: {ERRNO}", "FILE", path, "ERRNO",
+                   errno);
+        return false;
+    }
+    return syncDirectory(path);
+}
+
+bool promoteLastKnownGood(const std::string& path,
+                          const MDRSMBIOSHeader& header,
+                          std::span<const uint8_t> data)
+{
+    std::string lkgPath = lastKnownGoodPath(path);
+
+    // Skip the flash write when the copy already holds this table. The
+    // timestamp is ignored, a re-sent table is the same generation.
+    std::vector<uint8_t> current;
+    if (readFile(lkgPath, current) &&
+        current.size() == sizeof(MDRSMBIOSHeader) + data.size() &&
+        std::equal(data.begin(), data.end(),
+                   current.begin() + sizeof(MDRSMBIOSHeader)))
+    {
+        return true;
+    }
+
+    if (!writeTableFile(lkgPath, header, data))
+    {
+        lg2::error("Failed to update last-known-good SMBIOS table {FILE}",
+                   "FILE", lkgPath);
+        return false;
+    }
+    return true;
+}
+
+bool restoreLastKnownGood(const std::string& path)
+{
+    std::string lkgPath = lastKnownGoodPath(path);
+    std::vector<uint8_t> content;
+    if (!readFile(lkgPath, content) || content.size() < sizeof(MDRSMBIOSHeader))
+    {
+        return false;
+    }
+
+    if (!writeFileAtomic(path, {content}))
+    {
+        return false;
+    }
+
+    lg2::info("Restored SMBIOS table {FILE} from last-known-good copy", "FILE",
+              path);
+    return true;
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -16,19 +16,30 @@
 
 #include "cpuinfo.hpp"
 #include "cpuinfo_utils.hpp"
+#include "peci_engine.hpp"
+#include "peci_metrics.hpp"
+#include "peci_transport.hpp"
+#include "sst_cache.hpp"
+#include "sst_discovery.hpp"
 
 #include <peci.h>
 
 #include <boost/asio/error.hpp>
 #include <boost/asio/steady_timer.hpp>
+#include <sdbusplus/asio/object_server.hpp>
 #include <xyz/openbmc_project/Common/Device/error.hpp>
 #include <xyz/openbmc_project/Common/error.hpp>
 #include <xyz/openbmc_project/Control/Processor/CurrentOperatingConfig/server.hpp>
 #include <xyz/openbmc_project/Inventory/Item/Cpu/OperatingConfig/server.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 
@@ -37,6 +48,44 @@ namespace cpu_info
 namespace sst
 {
 
+#ifndef SST_PROPERTY_TTL
+#define SST_PROPERTY_TTL 5
+#endif
+#ifndef SST_REFRESH_INTERVAL
+#define SST_REFRESH_INTERVAL 30
+#endif
+
+/** How long a read current level and SST-BF state answer get-property calls */
+static constexpr std::chrono::seconds propertyTTL(SST_PROPERTY_TTL);
+/** Period of the background refresh of those values, zero to disable it */
+static constexpr std::chrono::seconds refreshInterval(SST_REFRESH_INTERVAL);
+/** How long a CPU may still be woken after a write, for the writes and reads
+ *  that usually follow it */
+static constexpr std::chrono::seconds wakeLinger(10);
+/** How long a write waits for a refresh or wake release of its socket. A few
+ *  OS Mailbox commands, each given up after 50 ms. */
+static constexpr std::chrono::milliseconds writeLockTimeout(200);
+
+static constexpr const char* speedSelectInterface =
+    "xyz.openbmc_project.CPUInfo.SpeedSelect";
+
+/** Mirrors hostState for the PECI worker, which must not read hostState */
+static std::atomic<bool> hostPoweredOn{false};
+
+/** PECI commands that memoized reads saved over all discovery passes */
+static std::atomic<uint64_t> discoveryTransactionsSaved{0};
+
+/** PECI jobs that may run at once. The bus is shared, but a socket waiting
+ *  for its mailbox leaves it free for the others. */
+static constexpr unsigned int peciWorkers = 4;
+
+/** Runs every PECI transaction of SST off the I/O thread */
+static peci::Engine& getEngine()
+{
+    static peci::Engine engine(dbus::getIOContext(), peciWorkers);
+    return engine;
+}
+
 // Specialize char to print the integer value instead of ascii. We basically
 // never want to print a single ascii char.
 std::ostream& operator<<(std::ostream& os, uint8_t value)
@@ -126,25 +175,74 @@ class OperatingConfig : public BaseOperatingConfig
     {}
 };
 
-class CPUConfig : public BaseCurrentOperatingConfig
+/**
+ * Hold a wake of an SST backend for the operations in a scope. At the end of
+ * the scope, Wake-on-PECI is cleared again if it had to be set and no other
+ * hold is left.
+ */
+class WakeScope
+{
+  public:
+    explicit WakeScope(SSTInterface& sst_) : sst(sst_)
+    {
+        sst.holdWake();
+    }
+
+    WakeScope(const WakeScope&) = delete;
+    WakeScope& operator=(const WakeScope&) = delete;
+
+    ~WakeScope()
+    {
+        try
+        {
+            sst.releaseWake();
+        }
+        catch (const PECIError& error)
+        {
+            std::cerr << "Failed to clear Wake-on-PECI: " << error.what()
+                      << "\n";
+        }
+    }
+
+  private:
+    SSTInterface& sst;
+};
+
+class CPUConfig :
+    public BaseCurrentOperatingConfig,
+    public std::enable_shared_from_this<CPUConfig>
 {
   private:
     /** Objects describing all available SST configs - not modifiable. */
     std::vector<std::unique_ptr<OperatingConfig>> availConfigs;
     sdbusplus::bus_t& bus;
-    const uint8_t peciAddress;
     const std::string path; ///< D-Bus path of CPU object
-    const CPUModel cpuModel;
+    const unsigned int cpuIndex;
+    const uint8_t peciAddress;
+    /** Identity of the part the levels were read from, if it could be read */
+    const std::optional<SocketIdentity> identity;
+    /** Backend found at discovery, used for every later read and write.
+     *  Shared with the PECI jobs in flight. */
+    const std::shared_ptr<SSTInterface> sst;
 
     // Keep mutable copies of the properties so we can cache values that we
     // retrieve in the getters. We don't want to throw an error on a D-Bus
     // get-property call (extra error handling in clients), so by caching we can
     // hide any temporary hiccup in PECI communication.
-    // These values can be changed by in-band software so we have to do a full
-    // PECI read on every get-property, and can't assume that values will change
-    // only when set-property is done.
+    // These values can be changed by in-band software, so they are read again
+    // when they are older than propertyTTL, and by the background refresh.
     mutable unsigned int currentLevel;
     mutable bool bfEnabled;
+    /** When the values were last read, the epoch if never. */
+    mutable std::chrono::steady_clock::time_point refreshed;
+    /** A read of the values is queued on the PECI engine. */
+    mutable bool refreshPending = false;
+    /** Counts level changes made here, so a read that started before one
+     *  doesn't overwrite it. */
+    unsigned int writes = 0;
+    /** Releases the wake hold taken for writes once wakeLinger passed */
+    boost::asio::steady_timer wakeReleaseTimer;
+    bool wakeHeld = false;
 
     /**
      * Enforce common pre-conditions for D-Bus set property handlers.
@@ -161,72 +259,139 @@ class CPUConfig : public BaseCurrentOperatingConfig
         }
     }
 
-  public:
-    CPUConfig(sdbusplus::bus_t& bus_, uint8_t index, CPUModel model,
-              unsigned int currentLevel_, bool bfEnabled_) :
-        BaseCurrentOperatingConfig(bus_, generatePath(index).c_str(),
-                                   action::defer_emit),
-        bus(bus_), peciAddress(index + MIN_CLIENT_ADDR),
-        path(generatePath(index)), cpuModel(model), currentLevel(currentLevel_),
-        bfEnabled(bfEnabled_)
-    {}
-
-    //
-    // D-Bus Property Overrides
-    //
-
-    sdbusplus::message::object_path appliedConfig() const override
+    /**
+     * Hold a wake for writes, and keep it until no write came for wakeLinger.
+     * A sequence of writes and the reads following them then set and clear
+     * Wake-on-PECI only once. Must be called with the socket locked on the
+     * engine.
+     */
+    void holdWakeForWrite()
     {
-        DEBUG_PRINT << "Reading AppliedConfig\n";
-        if (hostState != HostState::off)
+        if (!wakeHeld)
         {
-            // Otherwise, try to read current state
-            auto sst = getInstance(peciAddress, cpuModel, dontWake);
-            if (!sst || !sst->ready())
+            sst->holdWake();
+            wakeHeld = true;
+        }
+        wakeReleaseTimer.expires_after(wakeLinger);
+        wakeReleaseTimer.async_wait([this](boost::system::error_code ec) {
+            // Also aborted when the timer is rearmed or destroyed
+            if (ec)
             {
-                std::cerr << __func__
-                          << ": Failed to get SST provider instance\n";
+                return;
             }
-            else
-            {
+            wakeHeld = false;
+            getEngine().submit(
+                peciAddress, [backend = sst]() { backend->releaseWake(); },
+                [](std::exception_ptr error) {
                 try
                 {
-                    currentLevel = sst->currentLevel();
+                    if (error)
+                    {
+                        std::rethrow_exception(error);
+                    }
                 }
-                catch (const PECIError& error)
+                catch (const PECIError& err)
                 {
-                    std::cerr << "Failed to get SST-PP level: " << error.what()
+                    std::cerr << "Failed to clear Wake-on-PECI: " << err.what()
                               << "\n";
                 }
-            }
-        }
-        return generateConfigPath(currentLevel);
+            });
+        });
     }
 
-    bool baseSpeedPriorityEnabled() const override
+    /**
+     * Start reading the current level and SST-BF state from the CPU on the
+     * PECI engine, unless the cached values are younger than propertyTTL. When
+     * the read finishes, the values that changed are signaled.
+     *
+     * @param[in]   force   Read even if the cached values are fresh.
+     */
+    void refresh(bool force) const
     {
-        DEBUG_PRINT << "Reading BaseSpeedPriorityEnabled\n";
-        if (hostState != HostState::off)
+        if (hostState == HostState::off || refreshPending)
         {
-            auto sst = getInstance(peciAddress, cpuModel, dontWake);
-            if (!sst || !sst->ready())
+            return;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (!force && refreshed != std::chrono::steady_clock::time_point{} &&
+            now - refreshed < propertyTTL)
+        {
+            return;
+        }
+
+        refreshPending = true;
+        auto values = std::make_shared<std::pair<unsigned int, bool>>();
+        // Only the D-Bus getters are const, the object itself never is
+        std::weak_ptr<CPUConfig> self =
+            std::const_pointer_cast<CPUConfig>(shared_from_this());
+        getEngine().submit(
+            peciAddress, [backend = sst, values]() {
+            if (!backend->ready())
             {
-                std::cerr << __func__
-                          << ": Failed to get SST provider instance\n";
+                throw PECIError("SST provider not ready");
             }
-            else
+            values->first = backend->currentLevel();
+            values->second = backend->bfEnabled(values->first);
+        },
+            [self, values, writes = writes](std::exception_ptr error) {
+            auto cpu = self.lock();
+            if (cpu == nullptr)
             {
-                try
-                {
-                    bfEnabled = sst->bfEnabled(currentLevel);
-                }
-                catch (const PECIError& error)
+                return;
+            }
+            cpu->refreshPending = false;
+            try
+            {
+                if (error)
                 {
-                    std::cerr << "Failed to get SST-BF status: " << error.what()
-                              << "\n";
+                    std::rethrow_exception(error);
                 }
             }
-        }
+            catch (const PECIError& err)
+            {
+                std::cerr << "Failed to get SST-PP level and SST-BF status: "
+                          << err.what() << "\n";
+                return;
+            }
+            cpu->takeValues(writes, values->first, values->second);
+        });
+    }
+
+  public:
+    CPUConfig(sdbusplus::bus_t& bus_, uint8_t index,
+              std::shared_ptr<SSTInterface> sst_,
+              std::optional<SocketIdentity> identity_, unsigned int currentLevel_,
+              bool bfEnabled_) :
+        BaseCurrentOperatingConfig(bus_, generatePath(index).c_str(),
+                                   action::defer_emit),
+        bus(bus_), path(generatePath(index)), cpuIndex(index),
+        peciAddress(static_cast<uint8_t>(MIN_CLIENT_ADDR + index)),
+        identity(std::move(identity_)), sst(std::move(sst_)),
+        currentLevel(currentLevel_), bfEnabled(bfEnabled_),
+        refreshed(std::chrono::steady_clock::now()),
+        wakeReleaseTimer(dbus::getIOContext())
+    {
+        // The stored values are only used to detect changes to signal
+        BaseCurrentOperatingConfig::appliedConfig(
+            generateConfigPath(currentLevel), true);
+        BaseCurrentOperatingConfig::baseSpeedPriorityEnabled(bfEnabled, true);
+    }
+
+    //
+    // D-Bus Property Overrides
+    //
+
+    sdbusplus::message::object_path appliedConfig() const override
+    {
+        DEBUG_PRINT << "Reading AppliedConfig\n";
+        refresh(false);
+        return generateConfigPath(currentLevel);
+    }
+
+    bool baseSpeedPriorityEnabled() const override
+    {
+        DEBUG_PRINT << "Reading BaseSpeedPriorityEnabled\n";
+        refresh(false);
         return bfEnabled;
     }
 
@@ -249,17 +414,25 @@ class CPUConfig : public BaseCurrentOperatingConfig
                 InvalidArgument();
         }
 
-        auto sst = getInstance(peciAddress, cpuModel, wakeAllowed);
-        if (!sst)
-        {
-            std::cerr << __func__ << ": Failed to get SST provider instance\n";
-            return sdbusplus::message::object_path();
-        }
         try
         {
+            // The reply reports the result, so the write can't wait in the
+            // engine's queue. Keep queued reads from interleaving with it.
+            // A running refresh or wake release is waited for, a discovery
+            // pass would hold up the I/O thread too long.
+            auto lock = getEngine().lockSocket(peciAddress, writeLockTimeout);
+            if (!lock)
+            {
+                throw sdbusplus::xyz::openbmc_project::Common::Error::
+                    Unavailable();
+            }
             setPropertyCheckOrThrow(*sst);
+            holdWakeForWrite();
             sst->setCurrentLevel(newConfig->level);
             currentLevel = newConfig->level;
+            ++writes;
+            // The SST-BF state belongs to the old level
+            refreshed = {};
         }
         catch (const PECIError& error)
         {
@@ -269,6 +442,8 @@ class CPUConfig : public BaseCurrentOperatingConfig
                 WriteFailure();
         }
 
+        BaseCurrentOperatingConfig::appliedConfig(value, false);
+
         // return value not used
         return sdbusplus::message::object_path();
     }
@@ -285,6 +460,66 @@ class CPUConfig : public BaseCurrentOperatingConfig
     // Additions
     //
 
+    /**
+     * Read the current level and SST-BF state as in a get-property call. Once
+     * read, PropertiesChanged is emitted for the ones that differ from what
+     * was last signaled.
+     *
+     * @param[in]   force   Read even if the cached values are fresh.
+     */
+    void update(bool force)
+    {
+        refresh(force);
+    }
+
+    WakeStats wakeStats() const
+    {
+        return sst->wakeStats();
+    }
+
+    unsigned int index() const
+    {
+        return cpuIndex;
+    }
+
+    const std::optional<SocketIdentity>& socketIdentity() const
+    {
+        return identity;
+    }
+
+    const std::shared_ptr<SSTInterface>& backend() const
+    {
+        return sst;
+    }
+
+    /** Number of level changes made through AppliedConfig so far */
+    unsigned int writeCount() const
+    {
+        return writes;
+    }
+
+    /**
+     * Take the current level and SST-BF state read from the CPU, and emit
+     * PropertiesChanged for the ones that differ from what was last signaled.
+     *
+     * @param[in]   writesAtRead    writeCount() when the read started. If a
+     *                              write came since, the values are dropped.
+     */
+    void takeValues(unsigned int writesAtRead, unsigned int level,
+                    bool bfEnabled_)
+    {
+        if (writesAtRead != writes)
+        {
+            return;
+        }
+        currentLevel = level;
+        bfEnabled = bfEnabled_;
+        refreshed = std::chrono::steady_clock::now();
+        BaseCurrentOperatingConfig::appliedConfig(
+            generateConfigPath(currentLevel), false);
+        BaseCurrentOperatingConfig::baseSpeedPriorityEnabled(bfEnabled, false);
+    }
+
     OperatingConfig& newConfig(unsigned int level)
     {
         availConfigs.emplace_back(std::make_unique<OperatingConfig>(
@@ -317,34 +552,38 @@ class CPUConfig : public BaseCurrentOperatingConfig
     }
 };
 
+/** Persistent list - a CPU is added once its discovery is complete */
+static std::vector<std::shared_ptr<CPUConfig>> cpus;
+
 /**
- * Retrieve the SST parameters for a single config and fill the values into the
- * properties on the D-Bus interface.
+ * Retrieve the SST parameters for a single config.
  *
  * @param[in,out]   sst         Interface to SST backend.
  * @param[in]       level       Config TDP level to retrieve.
- * @param[out]      config      D-Bus interface to update.
+ *
+ * @return  Values of the OperatingConfig properties.
  */
-static void getSingleConfig(SSTInterface& sst, unsigned int level,
-                            OperatingConfig& config)
+static LevelConfig getSingleConfig(SSTInterface& sst, unsigned int level)
 {
-    config.powerLimit(sst.tdp(level));
-    DEBUG_PRINT << " TDP = " << config.powerLimit() << '\n';
+    LevelConfig config;
+    config.level = level;
 
-    config.availableCoreCount(sst.coreCount(level));
-    DEBUG_PRINT << " coreCount = " << config.availableCoreCount() << '\n';
+    config.powerLimit = sst.tdp(level);
+    DEBUG_PRINT << " TDP = " << config.powerLimit << '\n';
 
-    config.baseSpeed(sst.p1Freq(level));
-    DEBUG_PRINT << " baseSpeed = " << config.baseSpeed() << '\n';
+    config.coreCount = sst.coreCount(level);
+    DEBUG_PRINT << " coreCount = " << config.coreCount << '\n';
 
-    config.maxSpeed(sst.p0Freq(level));
-    DEBUG_PRINT << " maxSpeed = " << config.maxSpeed() << '\n';
+    config.baseSpeed = sst.p1Freq(level);
+    DEBUG_PRINT << " baseSpeed = " << config.baseSpeed << '\n';
 
-    config.maxJunctionTemperature(sst.prochotTemp(level));
-    DEBUG_PRINT << " procHot = " << config.maxJunctionTemperature() << '\n';
+    config.maxSpeed = sst.p0Freq(level);
+    DEBUG_PRINT << " maxSpeed = " << config.maxSpeed << '\n';
+
+    config.maxJunctionTemperature = sst.prochotTemp(level);
+    DEBUG_PRINT << " procHot = " << config.maxJunctionTemperature << '\n';
 
     // Construct BaseSpeedPrioritySettings
-    std::vector<std::tuple<uint32_t, std::vector<uint32_t>>> baseSpeeds;
     if (sst.bfSupported(level))
     {
         std::vector<uint32_t> totalCoreList, loFreqCoreList, hiFreqCoreList;
@@ -355,107 +594,190 @@ static void getSingleConfig(SSTInterface& sst, unsigned int level,
             hiFreqCoreList.end(),
             std::inserter(loFreqCoreList, loFreqCoreList.begin()));
 
-        baseSpeeds = {{sst.bfHighPriorityFreq(level), hiFreqCoreList},
-                      {sst.bfLowPriorityFreq(level), loFreqCoreList}};
+        config.baseSpeedPrioritySettings = {
+            {sst.bfHighPriorityFreq(level), hiFreqCoreList},
+            {sst.bfLowPriorityFreq(level), loFreqCoreList}};
     }
-    config.baseSpeedPrioritySettings(baseSpeeds);
 
-    config.turboProfile(sst.sseTurboProfile(level));
+    config.turboProfile = sst.sseTurboProfile(level);
+    return config;
 }
 
 /**
- * Retrieve all SST configuration info for all discoverable CPUs, and publish
- * the info on new D-Bus objects on the given bus connection.
- *
- * @param[in,out]   ioc     ASIO context.
- * @param[in,out]   conn    D-Bus ASIO connection.
- *
- * @return  Whether discovery was successfully finished.
- *
- * @throw PECIError     A PECI command failed on a CPU which had previously
- *                      responded to a command.
+ * Fill the values of a single config into the properties on the D-Bus
+ * interface.
  */
-static bool discoverCPUsAndConfigs(boost::asio::io_context& ioc,
-                                   sdbusplus::asio::connection& conn)
+static void publishSingleConfig(const LevelConfig& config,
+                                OperatingConfig& dbusConfig)
 {
-    // Persistent list - only populated after complete/successful discovery
-    static std::vector<std::unique_ptr<CPUConfig>> cpus;
-    cpus.clear();
+    dbusConfig.powerLimit(config.powerLimit);
+    dbusConfig.availableCoreCount(config.coreCount);
+    dbusConfig.baseSpeed(config.baseSpeed);
+    dbusConfig.maxSpeed(config.maxSpeed);
+    dbusConfig.maxJunctionTemperature(config.maxJunctionTemperature);
+    dbusConfig.baseSpeedPrioritySettings(config.baseSpeedPrioritySettings);
+    dbusConfig.turboProfile(config.turboProfile);
+}
 
-    // Temporary staging list. In case there is any failure, these temporary
-    // objects will get dropped to avoid presenting incomplete info until the
-    // next discovery attempt.
-    std::vector<std::unique_ptr<CPUConfig>> cpuList;
+/**
+ * Read what identifies the CPU part in a socket, using the same Package Config
+ * reads as the PPIN inventory property.
+ *
+ * @return  Empty if the PPIN can't be read, e.g. before BIOS enabled it.
+ */
+static std::optional<SocketIdentity>
+    readIdentity(uint8_t address, CPUModel model, uint8_t stepping)
+{
+    constexpr uint8_t pkgIdentifierIndex = 0;
+    constexpr uint16_t microcodeParam = 4;
+    constexpr uint8_t ppinIndex = 19;
+    constexpr uint16_t ppinLowParam = 1;
+    constexpr uint16_t ppinHighParam = 2;
+
+    auto read = [address](uint8_t index,
+                          uint16_t param) -> std::optional<uint32_t> {
+        uint32_t value = 0;
+        uint8_t cc = 0;
+        EPECIStatus status = peci::getTransport().rdPkgConfig(
+            address, index, param, sizeof(value),
+            reinterpret_cast<uint8_t*>(&value), &cc);
+        if (status != PECI_CC_SUCCESS || cc != PECI_DEV_CC_SUCCESS)
+        {
+            return std::nullopt;
+        }
+        return value;
+    };
+
+    std::optional<uint32_t> ppinLow = read(ppinIndex, ppinLowParam);
+    std::optional<uint32_t> ppinHigh = read(ppinIndex, ppinHighParam);
+    std::optional<uint32_t> microcode = read(pkgIdentifierIndex,
+                                             microcodeParam);
+    if (!ppinLow || !ppinHigh || !microcode)
+    {
+        return std::nullopt;
+    }
 
-    for (uint8_t i = MIN_CLIENT_ADDR; i <= MAX_CLIENT_ADDR; ++i)
+    SocketIdentity identity;
+    identity.model = model;
+    identity.stepping = stepping;
+    identity.ppin = (static_cast<uint64_t>(*ppinHigh) << 32) | *ppinLow;
+    identity.microcode = *microcode;
+    if (identity.ppin == 0)
     {
-        // Let the event handler run any waiting tasks. If there is a lot of
-        // PECI contention, SST discovery could take a long time. This lets us
-        // get updates to hostState and handle any D-Bus requests.
-        ioc.poll();
+        return std::nullopt;
+    }
+    return identity;
+}
 
-        if (hostState == HostState::off)
-        {
-            return false;
-        }
+/** Levels found on earlier boots, so unchanged CPUs don't have to be
+ *  enumerated again over PECI. */
+static ConfigCache& getConfigCache()
+{
+    static ConfigCache configCache(configCachePath);
+    return configCache;
+}
 
-        unsigned int cpuIndex = i - MIN_CLIENT_ADDR;
-        DEBUG_PRINT << "Discovering CPU " << cpuIndex << '\n';
+bool discoverSocket(uint8_t address,
+                    const std::optional<PublishedCPU>& published,
+                    ConfigCache& configCache,
+                    std::optional<DiscoveredCPU>& found, bool memoize)
+{
+    unsigned int cpuIndex = address - MIN_CLIENT_ADDR;
+    DEBUG_PRINT << "Discovering CPU " << cpuIndex << '\n';
+
+    // We could possibly check D-Bus for CPU presence and model, but PECI is
+    // 10x faster and so much simpler.
+    uint8_t cc, stepping;
+    CPUModel cpuModel;
+    EPECIStatus status = peci::getTransport().getCPUID(address, &cpuModel,
+                                                         &stepping, &cc);
+    if (status == PECI_CC_TIMEOUT)
+    {
+        // Timing out indicates the CPU is present but PCS services not
+        // working yet. Try again later.
+        throw PECIError("Get CPUID timed out");
+    }
+    if (status == PECI_CC_CPU_NOT_PRESENT)
+    {
+        configCache.update(cpuIndex, std::nullopt);
+        return true;
+    }
+    if (status != PECI_CC_SUCCESS || cc != PECI_DEV_CC_SUCCESS)
+    {
+        std::cerr << "GetCPUID returned status " << status << ", cc = " << cc
+                  << '\n';
+        return true;
+    }
 
-        // We could possibly check D-Bus for CPU presence and model, but PECI is
-        // 10x faster and so much simpler.
-        uint8_t cc, stepping;
-        CPUModel cpuModel;
-        EPECIStatus status = peci_GetCPUID(i, &cpuModel, &stepping, &cc);
-        if (status == PECI_CC_TIMEOUT)
-        {
-            // Timing out indicates the CPU is present but PCS services not
-            // working yet. Try again later.
-            throw PECIError("Get CPUID timed out");
-        }
-        if (status == PECI_CC_CPU_NOT_PRESENT)
-        {
-            continue;
-        }
-        if (status != PECI_CC_SUCCESS || cc != PECI_DEV_CC_SUCCESS)
+    std::optional<SocketIdentity> identity;
+    if (published)
+    {
+        // A matching CPUID and PPIN is a few Package Config reads, much less
+        // than enumerating the levels again
+        identity = readIdentity(address, cpuModel, stepping);
+        SSTInterface& backend = *published->sst;
+        if (identity == published->identity && backend.ready())
         {
-            std::cerr << "GetCPUID returned status " << status
-                      << ", cc = " << cc << '\n';
-            continue;
+            DEBUG_PRINT << "same CPU as published, reading current level\n";
+            WakeScope wake(backend);
+            DiscoveredCPU cpu{cpuIndex, published->sst, 0, false, identity, {},
+                              true};
+            cpu.currentLevel = backend.currentLevel();
+            cpu.bfEnabled = backend.bfEnabled(cpu.currentLevel);
+            found = std::move(cpu);
+            return true;
         }
+    }
 
-        std::unique_ptr<SSTInterface> sst = getInstance(i, cpuModel,
-                                                        wakeAllowed);
+    std::shared_ptr<SSTInterface> sst = getInstance(address, cpuModel,
+                                                    dontWake);
 
-        if (!sst)
-        {
-            // No supported backend for this CPU.
-            continue;
-        }
+    if (!sst)
+    {
+        // No supported backend for this CPU.
+        return true;
+    }
 
-        if (!sst->ready())
-        {
-            // Supported CPU but it can't be queried yet. Try again later.
-            std::cerr << "sst not ready yet\n";
-            return false;
-        }
+    // Discovery reads the same mailbox values for several properties, only
+    // send each distinct command once. The CPU may be woken for the whole pass
+    // over it, Wake-on-PECI is cleared once at the end.
+    sst->setMemoize(memoize);
+    WakeScope wake(*sst);
 
-        if (!sst->ppEnabled())
-        {
-            // Supported CPU but the specific SKU doesn't support SST-PP.
-            std::cerr << "CPU doesn't support SST-PP\n";
-            continue;
-        }
+    if (!sst->ready())
+    {
+        // Supported CPU but it can't be queried yet. Try again later.
+        std::cerr << "sst not ready yet\n";
+        return false;
+    }
+
+    if (!sst->ppEnabled())
+    {
+        // Supported CPU but the specific SKU doesn't support SST-PP.
+        std::cerr << "CPU doesn't support SST-PP\n";
+        return true;
+    }
 
-        // Create the per-CPU configuration object
-        unsigned int currentLevel = sst->currentLevel();
-        cpuList.emplace_back(
-            std::make_unique<CPUConfig>(conn, cpuIndex, cpuModel, currentLevel,
-                                        sst->bfEnabled(currentLevel)));
-        CPUConfig& cpu = *cpuList.back();
+    if (!published)
+    {
+        identity = readIdentity(address, cpuModel, stepping);
+    }
+    std::optional<SocketConfig> cached =
+        identity ? configCache.find(cpuIndex, *identity) : std::nullopt;
 
-        bool foundCurrentLevel = false;
+    DiscoveredCPU cpu{cpuIndex, sst, 0, false, identity, {}};
+    cpu.currentLevel = sst->currentLevel();
+    cpu.bfEnabled = sst->bfEnabled(cpu.currentLevel);
 
+    if (cached)
+    {
+        // Same part as when the levels were stored, only the current level
+        // and BF state above had to be read.
+        DEBUG_PRINT << "using cached levels\n";
+        cpu.config = std::move(*cached);
+    }
+    else
+    {
         for (unsigned int level = 0; level <= sst->maxLevel(); ++level)
         {
             DEBUG_PRINT << "checking level " << level << ": ";
@@ -470,76 +792,273 @@ static bool discoverCPUsAndConfigs(boost::asio::io_context& ioc,
 
             DEBUG_PRINT << "supported\n";
 
-            getSingleConfig(*sst, level, cpu.newConfig(level));
-
-            if (level == currentLevel)
-            {
-                foundCurrentLevel = true;
-            }
+            cpu.config.levels.push_back(getSingleConfig(*sst, level));
         }
+    }
 
-        DEBUG_PRINT << "current level is " << currentLevel << '\n';
+    DEBUG_PRINT << "current level is " << cpu.currentLevel << '\n';
 
-        if (!foundCurrentLevel)
-        {
-            // In case we didn't encounter a PECI error, but also didn't find
-            // the config which is supposedly applied, we won't be able to
-            // populate the CurrentOperatingConfig so we have to remove this CPU
-            // from consideration.
-            std::cerr << "CPU " << cpuIndex
-                      << " claimed SST support but invalid configs\n";
-            cpuList.pop_back();
-            continue;
-        }
+    // Later reads must not be memoized, discovery of this CPU is done
+    sst->setMemoize(false);
+    discoveryTransactionsSaved += sst->transactionsSaved();
+    DEBUG_PRINT << "memoized reads saved " << sst->transactionsSaved()
+                << " PECI commands\n";
+
+    if (std::none_of(cpu.config.levels.begin(), cpu.config.levels.end(),
+                     [&cpu](const LevelConfig& config) {
+        return config.level == cpu.currentLevel;
+    }))
+    {
+        // In case we didn't encounter a PECI error, but also didn't find the
+        // config which is supposedly applied, we won't be able to populate
+        // the CurrentOperatingConfig so we have to remove this CPU from
+        // consideration.
+        std::cerr << "CPU " << cpuIndex
+                  << " claimed SST support but invalid configs\n";
+        return true;
     }
 
-    cpuList.swap(cpus);
-    std::for_each(cpus.begin(), cpus.end(), [](auto& cpu) { cpu->finalize(); });
+    std::optional<SocketConfig> stored;
+    if (identity)
+    {
+        cpu.config.identity = *identity;
+        stored = cpu.config;
+    }
+    configCache.update(cpuIndex, std::move(stored));
+    found = std::move(cpu);
     return true;
 }
 
+/** Drop the D-Bus objects of the CPU at an index, if it was published */
+static void unpublishCPU(unsigned int cpuIndex)
+{
+    std::erase_if(cpus, [cpuIndex](const auto& cpu) {
+        return cpu->index() == cpuIndex;
+    });
+}
+
 /**
- * Attempt discovery process, and if it fails, wait for 10 seconds to try again.
+ * Publish a discovered CPU on new D-Bus objects on the given bus connection,
+ * replacing the objects of a different CPU found earlier in the socket.
  */
-static void discoverOrWait()
+static void publishCPU(sdbusplus::asio::connection& conn,
+                       DiscoveredCPU& discovered)
 {
-    static boost::asio::steady_timer peciRetryTimer(dbus::getIOContext());
-    static int peciErrorCount = 0;
-    bool finished = false;
+    unpublishCPU(discovered.index);
+    auto cpu = std::make_shared<CPUConfig>(
+        conn, discovered.index, std::move(discovered.sst),
+        std::move(discovered.identity), discovered.currentLevel,
+        discovered.bfEnabled);
+    for (const LevelConfig& config : discovered.config.levels)
+    {
+        publishSingleConfig(config, cpu->newConfig(config.level));
+    }
+    cpu->finalize();
+    cpus.push_back(std::move(cpu));
+}
 
-    // This function may be called from hostStateHandler or by retrying itself.
-    // In case those overlap, cancel any outstanding retry timer.
-    peciRetryTimer.cancel();
+/**
+ * Periodically read the values of every CPU that in-band software can change,
+ * so clients get PropertiesChanged instead of having to poll. Stops while the
+ * host is off, discovery starts it again.
+ */
+static void scheduleRefresh()
+{
+    static boost::asio::steady_timer refreshTimer(dbus::getIOContext());
 
-    try
+    if (refreshInterval == std::chrono::seconds::zero())
     {
-        DEBUG_PRINT << "Starting discovery\n";
-        finished = discoverCPUsAndConfigs(dbus::getIOContext(),
-                                          *dbus::getConnection());
+        return;
     }
-    catch (const PECIError& err)
-    {
-        std::cerr << "PECI Error: " << err.what() << '\n';
 
-        // In case of repeated failure to finish discovery, turn off this
-        // feature altogether. Possible cause is that the CPU model does not
-        // actually support the necessary commands.
-        if (++peciErrorCount >= 50)
+    refreshTimer.expires_after(refreshInterval);
+    refreshTimer.async_wait([](boost::system::error_code ec) {
+        if (ec)
         {
-            std::cerr << "Aborting SST discovery\n";
+            if (ec != boost::asio::error::operation_aborted)
+            {
+                std::cerr << "SST Refresh Timer failed: " << ec << '\n';
+            }
             return;
         }
+        if (hostState == HostState::off)
+        {
+            return;
+        }
+        for (auto& cpu : cpus)
+        {
+            cpu->update(false);
+        }
+        scheduleRefresh();
+    });
+}
+
+/**
+ * Discovery of the CPU at one PECI address. Each socket is discovered on its
+ * own and published as soon as it's done, and has its own retries, so a slow
+ * or failing socket doesn't hold back the others.
+ */
+class SocketDiscovery
+{
+  public:
+    explicit SocketDiscovery(uint8_t address_) :
+        address(address_), retryTimer(dbus::getIOContext())
+    {}
 
-        std::cerr << "Retrying SST discovery later\n";
+    /** Discover the socket again from the start, dropping any attempt of an
+     *  earlier pass. A CPU published for it stays until a different one or
+     *  none is found. */
+    void start()
+    {
+        retryTimer.cancel();
+        ++attempt;
+        errorCount = 0;
+        backoff = firstBackoff;
+        settled = false;
+        run();
     }
 
-    DEBUG_PRINT << "Finished discovery attempt: " << finished << '\n';
+    /** Begin timing a discovery pass over the given number of sockets */
+    static void startPass(unsigned int sockets)
+    {
+        passStart = std::chrono::steady_clock::now();
+        unsettled = sockets;
+    }
+
+  private:
+    static constexpr std::chrono::seconds firstBackoff{2};
+    static constexpr std::chrono::seconds maxBackoff{60};
+
+    void run()
+    {
+        unsigned int cpuIndex = address - MIN_CLIENT_ADDR;
+        std::optional<PublishedCPU> published;
+        unsigned int writes = 0;
+        for (const auto& cpu : cpus)
+        {
+            if (cpu->index() == cpuIndex && cpu->socketIdentity())
+            {
+                published = PublishedCPU{cpu->backend(),
+                                         *cpu->socketIdentity()};
+                writes = cpu->writeCount();
+            }
+        }
+
+        auto found = std::make_shared<std::optional<DiscoveredCPU>>();
+        auto finished = std::make_shared<bool>(false);
+        getEngine().submit(
+            address,
+            [address = address, published, found, finished]() {
+            // Not finished, discovery restarts when the host is powered on
+            if (!hostPoweredOn)
+            {
+                return;
+            }
+            auto start = std::chrono::steady_clock::now();
+            try
+            {
+                *finished = discoverSocket(address, published,
+                                           getConfigCache(), *found);
+            }
+            catch (...)
+            {
+                peci::getMetrics().recordDiscovery(
+                    address, std::chrono::steady_clock::now() - start);
+                throw;
+            }
+            peci::getMetrics().recordDiscovery(
+                address, std::chrono::steady_clock::now() - start);
+        },
+            [this, found, finished, writes,
+             attempt = attempt](std::exception_ptr error) {
+            if (attempt != this->attempt)
+            {
+                return;
+            }
+            done(error, *finished, *found, writes);
+        },
+            /*lengthy=*/true);
+    }
 
-    // Retry later if no CPUs were available, or there was a PECI error.
-    if (!finished)
+    /**
+     * Handle the end of a discovery attempt.
+     *
+     * @param[in]   writes  writeCount() of the published CPU when the attempt
+     *                      started.
+     */
+    void done(std::exception_ptr error, bool finished,
+              std::optional<DiscoveredCPU>& found, unsigned int writes)
     {
-        peciRetryTimer.expires_after(std::chrono::seconds(10));
-        peciRetryTimer.async_wait([](boost::system::error_code ec) {
+        unsigned int cpuIndex = address - MIN_CLIENT_ADDR;
+        try
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+        catch (const PECIError& err)
+        {
+            std::cerr << "PECI Error on CPU " << cpuIndex << ": " << err.what()
+                      << '\n';
+
+            // In case of repeated failure to finish discovery, turn off this
+            // feature for the socket. Possible cause is that the CPU model
+            // does not actually support the necessary commands.
+            if (++errorCount >= 50)
+            {
+                std::cerr << "Aborting SST discovery of CPU " << cpuIndex
+                          << '\n';
+                settle();
+                return;
+            }
+        }
+
+        DEBUG_PRINT << "Finished discovery attempt of CPU " << cpuIndex << ": "
+                    << finished << '\n';
+
+        if (finished)
+        {
+            if (!found)
+            {
+                unpublishCPU(cpuIndex);
+            }
+            else if (found->unchanged)
+            {
+                for (auto& cpu : cpus)
+                {
+                    if (cpu->index() == cpuIndex)
+                    {
+                        cpu->takeValues(writes, found->currentLevel,
+                                        found->bfEnabled);
+                    }
+                }
+            }
+            else
+            {
+                bool first = cpus.empty();
+                publishCPU(*dbus::getConnection(), *found);
+                if (first)
+                {
+                    scheduleRefresh();
+                }
+            }
+            settle();
+            return;
+        }
+
+        // Discovery restarts when the host is powered on again
+        if (hostState == HostState::off)
+        {
+            return;
+        }
+
+        // Retry later if the CPU wasn't ready, or there was a PECI error.
+        std::cerr << "Retrying SST discovery of CPU " << cpuIndex << " in "
+                  << backoff.count() << "s\n";
+        retryTimer.expires_after(backoff);
+        backoff = std::min(backoff * 2, maxBackoff);
+        retryTimer.async_wait([this](boost::system::error_code ec) {
             if (ec)
             {
                 if (ec != boost::asio::error::operation_aborted)
@@ -548,24 +1067,117 @@ static void discoverOrWait()
                 }
                 return;
             }
-            discoverOrWait();
+            run();
         });
     }
+
+    /** Note the socket is done for this pass, finished or given up on. The
+     *  pass is recorded in the PECI metrics once every socket is. */
+    void settle()
+    {
+        if (settled)
+        {
+            return;
+        }
+        settled = true;
+        if (unsettled > 0 && --unsettled == 0)
+        {
+            peci::getMetrics().recordDiscoveryPass(
+                std::chrono::steady_clock::now() - passStart);
+        }
+    }
+
+    uint8_t address;
+    boost::asio::steady_timer retryTimer;
+    /** Identifies the current pass, results of older ones are dropped */
+    unsigned int attempt = 0;
+    unsigned int errorCount = 0;
+    std::chrono::seconds backoff = firstBackoff;
+    bool settled = false;
+
+    static inline std::chrono::steady_clock::time_point passStart;
+    /** Sockets of the current pass not settled yet */
+    static inline unsigned int unsettled = 0;
+};
+
+/**
+ * Start discovery of every socket. The CPUs published so far are kept while
+ * the same parts are found again, so a host power cycle doesn't remove and
+ * add all objects again.
+ */
+static void discoverAll()
+{
+    static std::vector<std::unique_ptr<SocketDiscovery>> sockets;
+    if (sockets.empty())
+    {
+        for (uint8_t i = MIN_CLIENT_ADDR; i <= MAX_CLIENT_ADDR; ++i)
+        {
+            sockets.push_back(std::make_unique<SocketDiscovery>(i));
+        }
+    }
+
+    DEBUG_PRINT << "Starting discovery\n";
+    SocketDiscovery::startPass(sockets.size());
+    for (auto& socket : sockets)
+    {
+        socket->start();
+    }
+    // Stopped while the host was off
+    if (!cpus.empty())
+    {
+        scheduleRefresh();
+    }
 }
 
-static void hostStateHandler(HostState prevState, HostState)
+static void hostStateHandler(HostState prevState, HostState newState)
 {
+    hostPoweredOn = newState != HostState::off;
     if (prevState == HostState::off)
     {
         // Start or re-start discovery any time the host moves out of the
         // powered off state.
-        discoverOrWait();
+        discoverAll();
     }
 }
 
-void init()
+void init(sdbusplus::asio::object_server& server)
 {
     addHostStateCallback(hostStateHandler);
+
+    static std::shared_ptr<sdbusplus::asio::dbus_interface> iface =
+        server.add_interface(cpuInfoPath, speedSelectInterface);
+    // Read the current level and SST-BF state of every CPU now, regardless
+    // of the TTL, and signal the ones that changed.
+    iface->register_method("Refresh", []() {
+        for (auto& cpu : cpus)
+        {
+            cpu->update(true);
+        }
+    });
+    iface->register_property_r<uint64_t>(
+        "DiscoveryTransactionsSaved", 0, sdbusplus::vtable::property_::none,
+        [](const uint64_t&) { return discoveryTransactionsSaved.load(); });
+    iface->register_property_r<uint64_t>(
+        "WakeTransitions", 0, sdbusplus::vtable::property_::none,
+        [](const uint64_t&) {
+        uint64_t transitions = 0;
+        for (const auto& cpu : cpus)
+        {
+            transitions += cpu->wakeStats().transitions;
+        }
+        return transitions;
+    });
+    iface->register_property_r<uint64_t>(
+        "WakeTransitionsAvoided", 0, sdbusplus::vtable::property_::none,
+        [](const uint64_t&) {
+        uint64_t avoided = 0;
+        for (const auto& cpu : cpus)
+        {
+            avoided += cpu->wakeStats().avoided;
+        }
+        return avoided;
+    });
+    iface->initialize();
 }
 
 } // namespace sst
@@ -0,0 +1,167 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "sst_cache.hpp"
+
+#include "smbios_persist.hpp"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string>
+
+namespace cpu_info
+{
+namespace sst
+{
+
+// Increase when the meaning of a stored field changes, old files are dropped
+static constexpr int cacheVersion = 1;
+
+static void to_json(nlohmann::json& j, const LevelConfig& level)
+{
+    j = {{"level", level.level},
+         {"powerLimit", level.powerLimit},
+         {"coreCount", level.coreCount},
+         {"baseSpeed", level.baseSpeed},
+         {"maxSpeed", level.maxSpeed},
+         {"maxJunctionTemperature", level.maxJunctionTemperature},
+         {"baseSpeedPrioritySettings", level.baseSpeedPrioritySettings},
+         {"turboProfile", level.turboProfile}};
+}
+
+static void from_json(const nlohmann::json& j, LevelConfig& level)
+{
+    j.at("level").get_to(level.level);
+    j.at("powerLimit").get_to(level.powerLimit);
+    j.at("coreCount").get_to(level.coreCount);
+    j.at("baseSpeed").get_to(level.baseSpeed);
+    j.at("maxSpeed").get_to(level.maxSpeed);
+    j.at("maxJunctionTemperature").get_to(level.maxJunctionTemperature);
+    j.at("baseSpeedPrioritySettings").get_to(level.baseSpeedPrioritySettings);
+    j.at("turboProfile").get_to(level.turboProfile);
+}
+
+ConfigCache::ConfigCache(std::string path) : path(std::move(path))
+{
+    load();
+}
+
+std::optional<SocketConfig>
+    ConfigCache::find(unsigned int cpuIndex,
+                      const SocketIdentity& identity) const
+{
+    std::lock_guard lock(mutex);
+    auto socket = sockets.find(cpuIndex);
+    if (socket == sockets.end() || !(socket->second.identity == identity))
+    {
+        return std::nullopt;
+    }
+    return socket->second;
+}
+
+void ConfigCache::update(unsigned int cpuIndex,
+                         std::optional<SocketConfig> discovered)
+{
+    std::lock_guard lock(mutex);
+    auto socket = sockets.find(cpuIndex);
+    if (!discovered)
+    {
+        if (socket == sockets.end())
+        {
+            return;
+        }
+        sockets.erase(socket);
+    }
+    else if (socket == sockets.end() || !(socket->second == *discovered))
+    {
+        sockets[cpuIndex] = std::move(*discovered);
+    }
+    else
+    {
+        return;
+    }
+
+    if (!save())
+    {
+        std::cerr << "Failed to write SST config cache " << path << '\n';
+    }
+}
+
+void ConfigCache::load()
+{
+    std::ifstream file(path);
+    if (!file)
+    {
+        return;
+    }
+
+    try
+    {
+        nlohmann::json j = nlohmann::json::parse(file);
+        if (j.at("version").get<int>() != cacheVersion)
+        {
+            return;
+        }
+        for (const auto& entry : j.at("sockets"))
+        {
+            SocketConfig config;
+            entry.at("model").get_to(config.identity.model);
+            entry.at("stepping").get_to(config.identity.stepping);
+            entry.at("ppin").get_to(config.identity.ppin);
+            entry.at("microcode").get_to(config.identity.microcode);
+            for (const auto& level : entry.at("levels"))
+            {
+                config.levels.push_back(level.get<LevelConfig>());
+            }
+            sockets[entry.at("index").get<unsigned int>()] = std::move(config);
+        }
+    }
+    catch (const nlohmann::json::exception& e)
+    {
+        std::cerr << "Ignoring invalid SST config cache " << path << ": "
+                  << e.what() << '\n';
+        sockets.clear();
+    }
+}
+
+bool ConfigCache::save() const
+{
+    nlohmann::json entries = nlohmann::json::array();
+    for (const auto& [index, config] : sockets)
+    {
+        entries.push_back({{"index", index},
+                           {"model", config.identity.model},
+                           {"stepping", config.identity.stepping},
+                           {"ppin", config.identity.ppin},
+                           {"microcode", config.identity.microcode},
+                           {"levels", config.levels}});
+    }
+    nlohmann::json j = {{"version", cacheVersion}, {"sockets", entries}};
+
+    // Replaced in one step and synced, so neither a crash nor a power loss
+    // leaves half of it
+    std::string content = j.dump();
+    return phosphor::smbios::writeFileAtomic(
+        path, {std::span(reinterpret_cast<const uint8_t*>(content.data()),
+                         content.size())});
+}
+
+} // namespace sst
+} // namespace cpu_info
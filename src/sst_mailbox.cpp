@@ -13,9 +13,18 @@
 // limitations under the License.
 
 #include "cpuinfo_utils.hpp"
+#include "peci_metrics.hpp"
+#include "peci_transport.hpp"
 #include "speed_select.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
+#include <map>
+#include <optional>
+#include <thread>
+#include <tuple>
 
 namespace cpu_info
 {
@@ -31,6 +40,10 @@ namespace sst
  * Whenever a PECI command fails with associated error code, set WOP bit and
  * retry command. Upon manager destruction, clear WOP bit only if we previously
  * set it.
+ *
+ * Waking is allowed by the wake policy or while any wake hold is taken. Holds
+ * are counted, so nested or overlapping batches of commands set WOP at most
+ * once and clear it once, when the last hold is released.
  */
 struct PECIManager
 {
@@ -39,6 +52,13 @@ struct PECIManager
     CPUModel cpuModel;
     uint8_t mbBus;
     WakePolicy wakePolicy;
+    unsigned int wakeHolds = 0;
+    /** Times the WOP bit was set or cleared */
+    std::atomic<uint64_t> wakeTransitions{0};
+    /** Set and clear pairs not needed because a hold found WOP already set */
+    std::atomic<uint64_t> wakeTransitionsAvoided{0};
+    /** Mailbox register accesses made, not counting retries after waking */
+    uint64_t transactions = 0;
 
     PECIManager(uint8_t address, CPUModel model, WakePolicy wakePolicy_) :
         peciAddress(address), peciWoken(false), cpuModel(model),
@@ -75,23 +95,66 @@ struct PECIManager
                completionCode == PECI_DEV_CC_UNAVAIL_RESOURCE;
     }
 
+    bool wakeAllowedNow() const
+    {
+        return wakePolicy == wakeAllowed || wakeHolds > 0;
+    }
+
+    /**
+     * Apply a new wake policy. Clears the Wake-On-PECI mode bit if it was set
+     * under the previous policy and waking is no longer allowed.
+     */
+    void setWakePolicy(WakePolicy policy)
+    {
+        wakePolicy = policy;
+        if (!wakeAllowedNow() && peciWoken)
+        {
+            setWakeOnPECI(false);
+        }
+    }
+
+    /** Allow waking until the matching releaseWake() */
+    void holdWake()
+    {
+        ++wakeHolds;
+        if (peciWoken)
+        {
+            wakeTransitionsAvoided += 2;
+        }
+    }
+
+    /** Drop a hold, clearing the WOP bit if it was the last one */
+    void releaseWake()
+    {
+        if (wakeHolds > 0)
+        {
+            --wakeHolds;
+        }
+        if (!wakeAllowedNow() && peciWoken)
+        {
+            setWakeOnPECI(false);
+        }
+    }
+
     /**
      * Send a single PECI PCS write to modify the Wake-On-PECI mode bit
      */
     void setWakeOnPECI(bool enable)
     {
         uint8_t completionCode;
-        EPECIStatus libStatus = peci_WrPkgConfig(peciAddress, 5, enable ? 1 : 0,
-                                                 0, sizeof(uint32_t),
-                                                 &completionCode);
+        EPECIStatus libStatus = peci::getTransport().wrPkgConfig(
+            peciAddress, 5, enable ? 1 : 0, 0, sizeof(uint32_t),
+            &completionCode);
         if (!checkPECIStatus(libStatus, completionCode))
         {
             throw PECIError("Failed to set Wake-On-PECI mode bit");
         }
 
+        peciWoken = enable;
+        ++wakeTransitions;
         if (enable)
         {
-            peciWoken = true;
+            peci::getMetrics().recordWake(peciAddress);
         }
     }
 
@@ -105,6 +168,12 @@ struct PECIManager
     static constexpr int mbInterfaceReg = 0xA4;
     static constexpr int mbRegSize = sizeof(uint32_t);
 
+    // Time allowed for one mailbox command, and the range of the pause
+    // between polls of a busy mailbox
+    static constexpr std::chrono::milliseconds mbDeadline{50};
+    static constexpr std::chrono::microseconds mbMinBackoff{20};
+    static constexpr std::chrono::microseconds mbMaxBackoff{2000};
+
     enum class MailboxStatus
     {
         NoError = 0x0,
@@ -122,12 +191,14 @@ struct PECIManager
     void wrMailboxReg(uint16_t regAddress, uint32_t data)
     {
         uint8_t completionCode;
-        bool tryWaking = (wakePolicy == wakeAllowed);
+        bool tryWaking = wakeAllowedNow();
+        ++transactions;
         while (true)
         {
-            EPECIStatus libStatus = peci_WrEndPointPCIConfigLocal(
-                peciAddress, mbSegment, mbBus, mbDevice, mbFunction, regAddress,
-                mbRegSize, data, &completionCode);
+            EPECIStatus libStatus =
+                peci::getTransport().wrEndPointPCIConfigLocal(
+                    peciAddress, mbSegment, mbBus, mbDevice, mbFunction,
+                    regAddress, mbRegSize, data, &completionCode);
             if (tryWaking && isSleeping(libStatus, completionCode))
             {
                 setWakeOnPECI(true);
@@ -154,13 +225,15 @@ struct PECIManager
     {
         uint8_t completionCode;
         uint32_t outputData;
-        bool tryWaking = (wakePolicy == wakeAllowed);
+        bool tryWaking = wakeAllowedNow();
+        ++transactions;
         while (true)
         {
-            EPECIStatus libStatus = peci_RdEndPointConfigPciLocal(
-                peciAddress, mbSegment, mbBus, mbDevice, mbFunction, regAddress,
-                mbRegSize, reinterpret_cast<uint8_t*>(&outputData),
-                &completionCode);
+            EPECIStatus libStatus =
+                peci::getTransport().rdEndPointConfigPciLocal(
+                    peciAddress, mbSegment, mbBus, mbDevice, mbFunction,
+                    regAddress, mbRegSize,
+                    reinterpret_cast<uint8_t*>(&outputData), &completionCode);
             if (tryWaking && isSleeping(libStatus, completionCode))
             {
                 setWakeOnPECI(true);
@@ -176,6 +249,32 @@ struct PECIManager
         return outputData;
     }
 
+    /** Outcome of one OS Mailbox command */
+    struct MailboxResult
+    {
+        MailboxStatus status;
+        /** Only read if the status is NoError */
+        uint32_t data;
+        /** PECI commands it took */
+        uint64_t transactions;
+    };
+
+    /** While set, getters are answered from earlier identical commands */
+    bool memoizing = false;
+    std::map<std::tuple<uint8_t, uint8_t, uint32_t>, MailboxResult> memos;
+    /** PECI commands not sent thanks to memoized getters */
+    uint64_t transactionsSaved = 0;
+
+    /**
+     * Start or stop memoizing getters. Stopping forgets their results, the
+     * values they read may change afterwards.
+     */
+    void setMemoize(bool enable)
+    {
+        memoizing = enable;
+        memos.clear();
+    }
+
     /**
      * Send command on PCode OS Mailbox interface.
      *
@@ -187,29 +286,119 @@ struct PECIManager
      * @param[out]  responseCode    Optional parameter to receive the
      *                              mailbox-level response status. If null, a
      *                              PECIError will be thrown for error status.
+     * @param[in]   getter      The command only reads, so while memoizing an
+     *                          identical earlier one answers it. Any other
+     *                          command drops what was memoized.
      *
      * @return  Data returned in mailbox. Value is undefined if command is a
      *          "setter".
      */
     uint32_t sendPECIOSMailboxCmd(uint8_t command, uint8_t subCommand,
                                   uint32_t inputData = 0,
-                                  MailboxStatus* responseCode = nullptr)
+                                  MailboxStatus* responseCode = nullptr,
+                                  bool getter = false)
     {
-        // The simple mailbox algorithm just says to wait until the busy bit
-        // is clear, but we'll give up after 10 tries. It's arbitrary but that's
-        // quite long wall clock time.
-        constexpr int mbRetries = 10;
-        constexpr uint32_t mbBusyBit = bit(31);
+        auto key = std::make_tuple(command, subCommand, inputData);
+        MailboxResult result;
+        auto memo = memoizing && getter ? memos.find(key) : memos.end();
+        if (memo != memos.end())
+        {
+            result = memo->second;
+            transactionsSaved += result.transactions;
+        }
+        else
+        {
+            if (!getter)
+            {
+                memos.clear();
+            }
+            result = runPECIOSMailboxCmd(command, subCommand, inputData);
+            if (memoizing && getter)
+            {
+                memos.emplace(key, result);
+            }
+        }
 
-        // Wait until RUN_BUSY == 0
-        int attempts = mbRetries;
-        while ((rdMailboxReg(mbInterfaceReg) & mbBusyBit) != 0 &&
-               --attempts > 0)
-            ;
-        if (attempts == 0)
+        if (responseCode != nullptr)
+        {
+            *responseCode = result.status;
+        }
+        else if (result.status != MailboxStatus::NoError)
+        {
+            throw PECIError(std::string("OS Mailbox returned with error: ") +
+                            std::to_string(static_cast<int>(result.status)));
+        }
+        return result.data;
+    }
+
+    /** Run a command on the mailbox and record it in the PECI metrics, see
+     *  sendPECIOSMailboxCmd */
+    MailboxResult runPECIOSMailboxCmd(uint8_t command, uint8_t subCommand,
+                                      uint32_t inputData)
+    {
+        auto start = std::chrono::steady_clock::now();
+        unsigned int busyPolls = 0;
+        bool timedOut = false;
+        try
+        {
+            MailboxResult result = runPECIOSMailboxCmd(
+                command, subCommand, inputData, start, busyPolls, timedOut);
+            peci::getMetrics().recordMailbox(
+                peciAddress,
+                result.status == MailboxStatus::NoError
+                    ? peci::MailboxOutcome::success
+                    : peci::MailboxOutcome::errorStatus,
+                busyPolls, std::chrono::steady_clock::now() - start);
+            return result;
+        }
+        catch (const PECIError&)
         {
-            throw PECIError("OS Mailbox failed to become free");
+            peci::getMetrics().recordMailbox(
+                peciAddress,
+                timedOut ? peci::MailboxOutcome::timeout
+                         : peci::MailboxOutcome::peciFailure,
+                busyPolls, std::chrono::steady_clock::now() - start);
+            throw;
         }
+    }
+
+    /** Run the command for runPECIOSMailboxCmd above, counting the polls
+     *  that found the mailbox busy and whether it stayed busy too long. */
+    MailboxResult
+        runPECIOSMailboxCmd(uint8_t command, uint8_t subCommand,
+                            uint32_t inputData,
+                            std::chrono::steady_clock::time_point start,
+                            unsigned int& busyPolls, bool& timedOut)
+    {
+        constexpr uint32_t mbBusyBit = bit(31);
+        uint64_t startTransactions = transactions;
+
+        // The simple mailbox algorithm just says to wait until the busy bit
+        // is clear. Commands normally finish within a poll or two, so poll
+        // again right away at first and back off while the mailbox stays
+        // busy, giving up when the whole command runs past its deadline.
+        auto deadline = start + mbDeadline;
+        auto waitNotBusy = [this, deadline, &busyPolls,
+                            &timedOut](const char* what) {
+            std::chrono::microseconds backoff = mbMinBackoff;
+            uint32_t interfaceReg;
+            while (((interfaceReg = rdMailboxReg(mbInterfaceReg)) &
+                    mbBusyBit) != 0)
+            {
+                ++busyPolls;
+                if (std::chrono::steady_clock::now() + backoff > deadline)
+                {
+                    timedOut = true;
+                    throw PECIError(what);
+                }
+                std::this_thread::sleep_for(backoff);
+                backoff = std::min(backoff * 2, mbMaxBackoff);
+            }
+            return interfaceReg;
+        };
+
+        // Wait until RUN_BUSY == 0
+        waitNotBusy("OS Mailbox failed to become free");
 
         // Write required command specific input data to data register
         wrMailboxReg(mbDataReg, inputData);
@@ -221,30 +410,17 @@ struct PECIManager
         wrMailboxReg(mbInterfaceReg, interfaceReg);
 
         // Wait until RUN_BUSY == 0
-        attempts = mbRetries;
-        do
-        {
-            interfaceReg = rdMailboxReg(mbInterfaceReg);
-        } while ((interfaceReg & mbBusyBit) != 0 && --attempts > 0);
-        if (attempts == 0)
-        {
-            throw PECIError("OS Mailbox failed to return");
-        }
+        interfaceReg = waitNotBusy("OS Mailbox failed to return");
 
-        // Read command return status or error code from interface register
-        auto status = static_cast<MailboxStatus>(interfaceReg & 0xFF);
-        if (responseCode != nullptr)
-        {
-            *responseCode = status;
-        }
-        else if (status != MailboxStatus::NoError)
+        MailboxResult result{static_cast<MailboxStatus>(interfaceReg & 0xFF),
+                             0, 0};
+        if (result.status == MailboxStatus::NoError)
         {
-            throw PECIError(std::string("OS Mailbox returned with error: ") +
-                            std::to_string(static_cast<int>(status)));
+            // Read command return data from the data register
+            result.data = rdMailboxReg(mbDataReg);
         }
-
-        // Read command return data from the data register
-        return rdMailboxReg(mbDataReg);
+        result.transactions = transactions - startTransactions;
+        return result;
     }
 };
 
@@ -253,7 +429,7 @@ struct PECIManager
  * Constructing it runs the command and stores the value for use by derived
  * class accessor methods.
  */
-template <uint8_t subcommand>
+template <uint8_t subcommand, bool getter = true>
 struct OsMailboxCommand
 {
     enum ErrorPolicy
@@ -284,7 +460,8 @@ struct OsMailboxCommand
         uint32_t param = (static_cast<uint32_t>(param4) << 24) |
                          (static_cast<uint32_t>(param3) << 16) |
                          (static_cast<uint32_t>(param2) << 8) | param1;
-        value = pm.sendPECIOSMailboxCmd(0x7F, subcommand, param, callStatus);
+        value = pm.sendPECIOSMailboxCmd(0x7F, subcommand, param, callStatus,
+                                        getter);
     }
 
     /** Return whether the mailbox status indicated success or not. */
@@ -327,7 +504,7 @@ struct GetConfigTdpControl : OsMailboxCommand<0x1>
     FIELD(bool, factSupport, 0, 0);
 };
 
-struct SetConfigTdpControl : OsMailboxCommand<0x2>
+struct SetConfigTdpControl : OsMailboxCommand<0x2, false>
 {
     using OsMailboxCommand::OsMailboxCommand;
 };
@@ -350,7 +527,7 @@ struct GetTurboLimitRatios : OsMailboxCommand<0x7>
     using OsMailboxCommand::OsMailboxCommand;
 };
 
-struct SetLevel : OsMailboxCommand<0x8>
+struct SetLevel : OsMailboxCommand<0x8, false>
 {
     using OsMailboxCommand::OsMailboxCommand;
 };
@@ -386,8 +563,8 @@ struct PbfGetP1HiP1LoInfo : OsMailboxCommand<0x21>
 /**
  * Implementation of SSTInterface based on OS Mailbox interface supported on ICX
  * and SPR processors.
- * It's expected that an instance of this class will be created for each
- * "atomic" set of operations.
+ * An instance is kept for each discovered CPU and used for all later reads and
+ * writes.
  */
 class SSTMailbox : public SSTInterface
 {
@@ -395,6 +572,9 @@ class SSTMailbox : public SSTInterface
     uint8_t address;
     CPUModel model;
     PECIManager pm;
+    /** Turbo Ratio Limit Cores MSR, kept while memoizing */
+    std::optional<uint64_t> trlCores;
+    uint64_t msrReadsSaved = 0;
 
     static constexpr int mhzPerRatio = 100;
 
@@ -410,6 +590,37 @@ class SSTMailbox : public SSTInterface
         return true;
     }
 
+    void setWakePolicy(WakePolicy policy) override
+    {
+        pm.setWakePolicy(policy);
+    }
+
+    void holdWake() override
+    {
+        pm.holdWake();
+    }
+
+    void releaseWake() override
+    {
+        pm.releaseWake();
+    }
+
+    WakeStats wakeStats() const override
+    {
+        return {pm.wakeTransitions, pm.wakeTransitionsAvoided};
+    }
+
+    void setMemoize(bool enable) override
+    {
+        pm.setMemoize(enable);
+        trlCores.reset();
+    }
+
+    uint64_t transactionsSaved() const override
+    {
+        return pm.transactionsSaved + msrReadsSaved;
+    }
+
     bool supportsControl() override
     {
         switch (model)
@@ -483,14 +694,27 @@ class SSTMailbox : public SSTInterface
     {
         // Read the Turbo Ratio Limit Cores MSR which is used to generate the
         // Turbo Profile for each profile. This is a package scope MSR, so just
-        // read thread 0.
-        uint64_t trlCores;
-        uint8_t cc;
-        EPECIStatus status = peci_RdIAMSR(static_cast<uint8_t>(address), 0,
-                                          0x1AE, &trlCores, &cc);
-        if (!checkPECIStatus(status, cc))
+        // read thread 0. It's the same for every level, so while memoizing
+        // it's only read for the first one.
+        uint64_t bucketCores;
+        if (trlCores)
         {
-            throw PECIError("Failed to read TRL MSR");
+            bucketCores = *trlCores;
+            ++msrReadsSaved;
+        }
+        else
+        {
+            uint8_t cc;
+            EPECIStatus status = peci::getTransport().rdIAMSR(
+                static_cast<uint8_t>(address), 0, 0x1AE, &bucketCores, &cc);
+            if (!checkPECIStatus(status, cc))
+            {
+                throw PECIError("Failed to read TRL MSR");
+            }
+            if (pm.memoizing)
+            {
+                trlCores = bucketCores;
+            }
         }
 
         std::vector<TurboEntry> turboSpeeds;
@@ -503,14 +727,14 @@ class SSTMailbox : public SSTInterface
         constexpr int maxTFBuckets = 8;
         for (int i = 0; i < maxTFBuckets; ++i)
         {
-            size_t bucketCount = trlCores & 0xFF;
+            size_t bucketCount = bucketCores & 0xFF;
             int bucketSpeed = limitRatios & 0xFF;
             if (bucketCount != 0 && bucketSpeed != 0)
             {
                 turboSpeeds.push_back({bucketSpeed * mhzPerRatio, bucketCount});
             }
 
-            trlCores >>= 8;
+            bucketCores >>= 8;
             limitRatios >>= 8;
         }
         return turboSpeeds;
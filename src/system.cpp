@@ -17,11 +17,13 @@
 #include "system.hpp"
 
 #include "mdrv2.hpp"
+#include "smbios_persist.hpp"
 
 #include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
+#include <utility>
 
 static constexpr const char* biosActiveObjPath =
     "/xyz/openbmc_project/software/bios_active";
@@ -34,10 +36,11 @@ namespace phosphor
 namespace smbios
 {
 
-std::string System::uuid(std::string /* value */)
+SystemRecord System::decode(uint8_t* smbiosTableStorage)
 {
-    uint8_t* dataIn = storage;
-    dataIn = getSMBIOSTypePtr(dataIn, systemType);
+    SystemRecord record;
+
+    uint8_t* dataIn = getSMBIOSTypePtr(smbiosTableStorage, systemType);
     if (dataIn != nullptr)
     {
         auto systemInfo = reinterpret_cast<struct SystemInfo*>(dataIn);
@@ -60,53 +63,42 @@ std::string System::uuid(std::string /* value */)
         stream << std::setw(2) << static_cast<int>(systemInfo->uuid.node[3]);
         stream << std::setw(2) << static_cast<int>(systemInfo->uuid.node[4]);
         stream << std::setw(2) << static_cast<int>(systemInfo->uuid.node[5]);
+        record.uuid = stream.str();
+    }
 
-        return sdbusplus::server::xyz::openbmc_project::common::UUID::uuid(
-            stream.str());
+    dataIn = getSMBIOSTypePtr(smbiosTableStorage, biosType);
+    if (dataIn != nullptr)
+    {
+        auto biosInfo = reinterpret_cast<struct BIOSInfo*>(dataIn);
+        std::string tempS = positionToString(biosInfo->biosVersion,
+                                             biosInfo->length, dataIn);
+        record.biosVersionBroken =
+            std::find_if(tempS.begin(), tempS.end(),
+                         [](char ch) { return !isprint(ch); }) != tempS.end();
+        record.biosVersion = std::move(tempS);
     }
 
-    return sdbusplus::server::xyz::openbmc_project::common::UUID::uuid(
-        "00000000-0000-0000-0000-000000000000");
+    return record;
 }
 
-static std::string getService(sdbusplus::bus_t& bus,
-                              const std::string& objectPath,
-                              const std::string& interface)
+std::string System::uuid(std::string value)
 {
-    auto method = bus.new_method_call("xyz.openbmc_project.ObjectMapper",
-                                      "/xyz/openbmc_project/object_mapper",
-                                      "xyz.openbmc_project.ObjectMapper",
-                                      "GetObject");
-
-    method.append(objectPath);
-    method.append(std::vector<std::string>({interface}));
-
-    std::vector<std::pair<std::string, std::vector<std::string>>> response;
-
-    try
-    {
-        auto reply = bus.call(method);
-        reply.read(response);
-    }
-    catch (const sdbusplus::exception_t& e)
-    {
-        lg2::error("Error in mapper method call - {ERROR}, SERVICE - "
-                   "{SERVICE}, PATH - {PATH}",
-                   "ERROR", e.what(), "SERVICE", objectPath.c_str(), "PATH",
-                   interface.c_str());
-
-        return std::string{};
-    }
+    return uuid(std::move(value), false);
+}
 
-    return response[0].first;
+std::string System::uuid(std::string /* value */, bool skipSignal)
+{
+    return sdbusplus::server::xyz::openbmc_project::common::UUID::uuid(
+        record.uuid, skipSignal);
 }
 
-static void setProperty(sdbusplus::bus_t& bus, const std::string& objectPath,
+static void setProperty(sdbusplus::bus_t& bus, MapperCache& mapper,
+                        const std::string& objectPath,
                         const std::string& interface,
                         const std::string& propertyName,
                         const std::string& value)
 {
-    auto service = getService(bus, objectPath, interface);
+    auto service = mapper.service(objectPath, interface);
     if (service.empty())
     {
         return;
@@ -120,41 +112,37 @@ static void setProperty(sdbusplus::bus_t& bus, const std::string& objectPath,
     bus.call_noreply(method);
 }
 
-std::string System::version(std::string /* value */)
+std::string System::version(std::string value)
+{
+    return version(std::move(value), false);
+}
+
+std::string System::version(std::string /* value */, bool skipSignal)
 {
     std::string result = "No BIOS Version";
-    uint8_t* dataIn = storage;
-    dataIn = getSMBIOSTypePtr(dataIn, biosType);
-    if (dataIn != nullptr)
+    if (record.biosVersion)
     {
-        auto biosInfo = reinterpret_cast<struct BIOSInfo*>(dataIn);
-        std::string tempS = positionToString(biosInfo->biosVersion,
-                                             biosInfo->length, dataIn);
-        if (std::find_if(tempS.begin(), tempS.end(),
-                         [](char ch) { return !isprint(ch); }) != tempS.end())
+        if (record.biosVersionBroken)
         {
-            std::ofstream smbiosFile(smbiosFilePath, std::ios_base::trunc);
-            if (!smbiosFile.good())
+            if (!removeTableFile(smbiosFilePath))
             {
                 phosphor::logging::log<phosphor::logging::level::ERR>(
-                    "Open MDRV2 table file failure");
+                    "Remove MDRV2 table file failure");
                 return result;
             }
-            smbiosFile.clear();
-            smbiosFile.close();
             phosphor::logging::log<phosphor::logging::level::ERR>(
                 "Find non-print char, delete the broken MDRV2 table file!");
             return sdbusplus::server::xyz::openbmc_project::inventory::
-                decorator::Revision::version(result);
+                decorator::Revision::version(result, skipSignal);
         }
-        result = tempS;
+        result = *record.biosVersion;
 
-        setProperty(*bus, biosActiveObjPath, biosVersionIntf, biosVersionProp,
-                    result);
+        setProperty(*bus, mapper, biosActiveObjPath, biosVersionIntf,
+                    biosVersionProp, result);
     }
     lg2::info("VERSION INFO - BIOS - {VER}", "VER", result);
     return sdbusplus::server::xyz::openbmc_project::inventory::decorator::
-        Revision::version(result);
+        Revision::version(result, skipSignal);
 }
 
 } // namespace smbios
@@ -0,0 +1,406 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "table_decoder.hpp"
+
+#include "baseboard.hpp"
+#include "mdrv2.hpp"
+#include "smbios_graph.hpp"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <regex>
+#include <unordered_map>
+#include <utility>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+static size_t countStructures(uint8_t* dataIn, uint8_t typeId,
+                              size_t minSize = 0)
+{
+    size_t num = 0;
+
+    while (1)
+    {
+        dataIn = getSMBIOSTypePtr(dataIn, typeId, minSize);
+        if (dataIn == nullptr)
+        {
+            break;
+        }
+        num++;
+        dataIn = smbiosNextPtr(dataIn);
+        if (dataIn == nullptr)
+        {
+            break;
+        }
+        if (num >= limitEntryLen)
+        {
+            break;
+        }
+    }
+
+    return num;
+}
+
+static size_t countPcieSlots(uint8_t* dataIn)
+{
+    size_t num = 0;
+
+    while (1)
+    {
+        dataIn = getSMBIOSTypePtr(dataIn, systemSlots);
+        if (dataIn == nullptr)
+        {
+            break;
+        }
+
+        /* System slot type offset. Check if the slot is a PCIE slots. All
+         * PCIE slot type are hardcoded in a table.
+         */
+        if (pcieSmbiosType.find(*(dataIn + 5)) != pcieSmbiosType.end())
+        {
+            num++;
+        }
+        dataIn = smbiosNextPtr(dataIn);
+        if (dataIn == nullptr)
+        {
+            break;
+        }
+        if (num >= limitEntryLen)
+        {
+            break;
+        }
+    }
+
+    return num;
+}
+
+static bool firmwareSkipped([[maybe_unused]] const std::string& firmwareName)
+{
+#ifdef FIRMWARE_COMPONENT_NAME_BMC
+    std::string bmcComponentName(FIRMWARE_COMPONENT_NAME_BMC);
+    if (bmcComponentName == firmwareName)
+    {
+        return true;
+    }
+#endif
+#ifdef FIRMWARE_COMPONENT_NAME_BIOS
+    std::string biosComponentName(FIRMWARE_COMPONENT_NAME_BIOS);
+    if (biosComponentName == firmwareName)
+    {
+        return true;
+    }
+#endif
+#ifdef FIRMWARE_COMPONENT_NAME_CX7
+    std::string cx7ComponentName(FIRMWARE_COMPONENT_NAME_CX7);
+    if (firmwareName.rfind(cx7ComponentName) != std::string::npos)
+    {
+        return true;
+    }
+#endif
+#ifdef FIRMWARE_COMPONENT_NAME_FPGA
+    std::string fpgaComponentName(FIRMWARE_COMPONENT_NAME_FPGA);
+    if (firmwareName.rfind(fpgaComponentName) != std::string::npos)
+    {
+        return true;
+    }
+#endif
+#ifdef FIRMWARE_COMPONENT_NAME_TPM
+    std::string tpmComponentName(FIRMWARE_COMPONENT_NAME_TPM);
+    if (tpmComponentName == firmwareName)
+    {
+        return true;
+    }
+#endif
+    return false;
+}
+
+// Enough for the records of a typical two socket table, bigger tables grow
+// the arena geometrically.
+static constexpr size_t initialArenaSize = 16 * 1024;
+
+DecodedTable::DecodedTable() :
+    arena(std::make_unique<std::pmr::monotonic_buffer_resource>(
+        initialArenaSize)),
+    cpus(arena.get()), dimms(arena.get()), pcies(arena.get()),
+    firmware(arena.get())
+{}
+
+DecodedTable decodeTable(std::span<uint8_t> storage, Metrics* metrics)
+{
+    DecodedTable ret;
+    uint8_t* data = storage.data();
+    std::pmr::memory_resource* arena = ret.arena.get();
+
+    Metrics::Timer timer(metrics, Phase::indexing);
+    HandleGraph graph(storage, arena);
+
+    // Name of every board whose contained objects get renamed
+    std::pmr::unordered_map<uint16_t, std::string> boardNames(arena);
+#ifdef PROCMOD_DBUS
+    int processorModuleIndex = 0;
+    size_t boardNum = countStructures(data, baseboardType);
+    for (size_t index = 0; index < boardNum; index++)
+    {
+        using enum phosphor::smbios::Baseboard::BoardType;
+        Baseboard baseboard(index, data);
+        switch (baseboard.getType())
+        {
+            case ProcessorModule:
+            case ProcesssorMemoryModule:
+            case ProcessorIoModule:
+                baseboard.setName("ProcessorModule_" +
+                                  std::to_string(processorModuleIndex++));
+                break;
+            default:
+                break;
+        }
+        if (auto handle = baseboard.getHandle())
+        {
+            boardNames.try_emplace(*handle, baseboard.getName());
+        }
+    }
+#endif
+
+#ifdef CPU_DBUS
+    timer.next(Phase::decodeCpu);
+    size_t cpuNum = countStructures(data, processorsType);
+    ret.cpus.reserve(cpuNum);
+    for (size_t index = 0; index < cpuNum; index++)
+    {
+        ret.cpus.emplace_back(Cpu::decode(data, index));
+    }
+#endif
+
+#ifdef DIMM_DBUS
+    timer.next(Phase::decodeDimm);
+    size_t dimmNum = countStructures(data, memoryDeviceType);
+    ret.dimms.reserve(dimmNum);
+    for (size_t index = 0; index < dimmNum; index++)
+    {
+        DecodedTable::NamedDimm dimm{"Memory_" + std::to_string(index),
+                                     Dimm::decode(data, graph, index)};
+
+        // Rename the object if it's contaned by a board
+        const Containment* container = graph.container(dimm.record.handle);
+        if (container != nullptr)
+        {
+            auto board = boardNames.find(container->board);
+            if (board != boardNames.end())
+            {
+                dimm.objName = board->second + "_" + "Memory_" +
+                               std::to_string(container->indexOfType);
+            }
+        }
+        ret.dimms.emplace_back(std::move(dimm));
+    }
+#endif
+
+    timer.next(Phase::decodePcie);
+    size_t pcieNum = countPcieSlots(data);
+    ret.pcies.reserve(pcieNum);
+    for (size_t index = 0; index < pcieNum; index++)
+    {
+        ret.pcies.emplace_back(Pcie::decode(data, index));
+    }
+
+    timer.next(Phase::decodeTpm);
+    if (countStructures(data, tpmDeviceType) == 1)
+    {
+        ret.tpm = Tpm::decode(data);
+    }
+
+    timer.next(Phase::decodeFirmware);
+    size_t firmwareNum = countStructures(data,
+                                         firmwareInventoryInformationType);
+    ret.firmware.reserve(firmwareNum);
+    for (size_t index = 0; index < firmwareNum; index++)
+    {
+        DecodedTable::NamedFirmware firmware{
+            "", Firmware::decode(data, graph, static_cast<int>(index))};
+        if (firmwareSkipped(firmware.record.name))
+        {
+            continue;
+        }
+
+        firmware.objName = firmware.record.id;
+        if (firmware.objName.empty())
+        {
+            firmware.objName = "firmware" + std::to_string(index);
+        }
+        firmware.objName = std::regex_replace(
+            firmware.objName, std::regex("[^a-zA-Z0-9_/]+"), "_");
+
+        std::string cp = firmware.objName;
+        std::transform(cp.begin(), cp.end(), cp.begin(), ::tolower);
+        if (cp.find("psu") != std::string::npos)
+        {
+            continue;
+        }
+
+        ret.firmware.emplace_back(std::move(firmware));
+    }
+
+    timer.next(Phase::decodeSystem);
+    ret.system = System::decode(data);
+    timer.stop();
+
+    if (metrics != nullptr)
+    {
+        metrics->add(Counter::recordsDecoded,
+                     ret.cpus.size() + ret.dimms.size() + ret.pcies.size() +
+                         (ret.tpm ? 1 : 0) + ret.firmware.size() + 1);
+    }
+
+    return ret;
+}
+
+TableDecoder::TableDecoder(boost::asio::io_context& io, Callback onDecoded,
+                           Metrics* metrics) :
+    notifyDescriptor(io), onDecoded(std::move(onDecoded)), metrics(metrics)
+{
+    int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0)
+    {
+        lg2::error("Failed to create decoder eventfd: {ERRNO}", "ERRNO",
+                   errno);
+        return;
+    }
+    notifyDescriptor.assign(fd);
+    readNotify();
+
+    worker = std::thread([this]() { run(); });
+}
+
+TableDecoder::~TableDecoder()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable())
+    {
+        worker.join();
+    }
+
+    boost::system::error_code ec;
+    notifyDescriptor.close(ec);
+}
+
+void TableDecoder::submit(std::span<const uint8_t> storage, uint64_t hash)
+{
+    auto copy = std::make_unique<std::vector<uint8_t>>(storage.begin(),
+                                                       storage.end());
+    if (!worker.joinable())
+    {
+        // No worker, decode inline rather than drop the table
+        DecodedTable result = decodeTable(*copy, metrics);
+        result.hash = hash;
+        onDecoded(result);
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        pending = std::move(copy);
+        pendingHash = hash;
+    }
+    wake.notify_one();
+}
+
+void TableDecoder::run()
+{
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        wake.wait(lock, [this]() { return stopping || pending != nullptr; });
+        if (stopping)
+        {
+            return;
+        }
+
+        auto table = std::move(pending);
+        uint64_t hash = pendingHash;
+        lock.unlock();
+
+        std::unique_ptr<DecodedTable> result;
+        try
+        {
+            result = std::make_unique<DecodedTable>(
+                decodeTable(*table, metrics));
+            result->hash = hash;
+        }
+        catch (const std::exception& e)
+        {
+            lg2::error("Failed to decode SMBIOS table: {ERR}", "ERR",
+                       e.what());
+        }
+
+        lock.lock();
+        if (result == nullptr)
+        {
+            continue;
+        }
+        decoded = std::move(result);
+
+        uint64_t one = 1;
+        if (write(notifyDescriptor.native_handle(), &one, sizeof(one)) < 0)
+        {
+            lg2::error("Failed to notify decoded table: {ERRNO}", "ERRNO",
+                       errno);
+        }
+    }
+}
+
+void TableDecoder::readNotify()
+{
+    notifyDescriptor.async_read_some(
+        boost::asio::buffer(&notifyValue, sizeof(notifyValue)),
+        [this](const boost::system::error_code& ec, size_t) {
+        if (ec)
+        {
+            if (ec != boost::asio::error::operation_aborted)
+            {
+                lg2::error("Table decoder read error: {ERR}", "ERR",
+                           ec.message());
+            }
+            return;
+        }
+
+        std::unique_ptr<DecodedTable> table;
+        {
+            std::lock_guard lock(mutex);
+            table = std::move(decoded);
+        }
+        if (table != nullptr)
+        {
+            onDecoded(*table);
+        }
+        readNotify();
+    });
+}
+
+} // namespace smbios
+} // namespace phosphor
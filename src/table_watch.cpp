@@ -0,0 +1,124 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "table_watch.hpp"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <phosphor-logging/lg2.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <utility>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+TableWatch::TableWatch(boost::asio::io_context& io, const std::string& path,
+                       std::function<void()> onChange) :
+    watchDescriptor(io), debounceTimer(io),
+    fileName(std::filesystem::path(path).filename().string()),
+    onChange(std::move(onChange))
+{
+    std::string dir = std::filesystem::path(path).parent_path().string();
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0)
+    {
+        lg2::error("Failed to initialize inotify: {ERRNO}", "ERRNO", errno);
+        return;
+    }
+
+    if (inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+    {
+        lg2::error("Failed to watch {DIR}: {ERRNO}", "DIR", dir, "ERRNO",
+                   errno);
+        close(fd);
+        return;
+    }
+
+    watchDescriptor.assign(fd);
+    readEvents();
+}
+
+TableWatch::~TableWatch()
+{
+    boost::system::error_code ec;
+    debounceTimer.cancel();
+    watchDescriptor.close(ec);
+}
+
+void TableWatch::readEvents()
+{
+    watchDescriptor.async_read_some(
+        boost::asio::buffer(eventBuffer),
+        [this](const boost::system::error_code& ec, size_t length) {
+        if (ec)
+        {
+            if (ec != boost::asio::error::operation_aborted)
+            {
+                lg2::error("Table watch read error: {ERR}", "ERR",
+                           ec.message());
+            }
+            return;
+        }
+        handleEvents(length);
+        readEvents();
+    });
+}
+
+void TableWatch::handleEvents(size_t length)
+{
+    bool changed = false;
+    size_t offset = 0;
+    while (offset + sizeof(inotify_event) <= length)
+    {
+        inotify_event event;
+        std::memcpy(&event, eventBuffer.data() + offset, sizeof(event));
+        if (event.len != 0 &&
+            fileName == std::string(eventBuffer.data() + offset +
+                                    sizeof(inotify_event)))
+        {
+            changed = true;
+        }
+        offset += sizeof(inotify_event) + event.len;
+    }
+
+    if (!changed)
+    {
+        return;
+    }
+
+    // Restarting the timer cancels the previous wait, so only the last event
+    // of a burst triggers a reload.
+    debounceTimer.expires_after(tableWatchDebounce);
+    debounceTimer.async_wait([this](const boost::system::error_code& ec) {
+        if (ec)
+        {
+            return;
+        }
+        onChange();
+    });
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -0,0 +1,351 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Publishes a table on two MDRV2 instances of one process, as on a
+ * multi-host system, and checks that both inventories appear on the bus and
+ * that the process survives it.
+ *
+ * Everything runs on a private dbus-daemon, given as the only argument, with
+ * a mock service answering the ObjectMapper calls and hosting the inventory
+ * anchor of each host.
+ */
+
+#include "mdrv2.hpp"
+
+#include "private_bus.hpp"
+#include "table_builder.hpp"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace phosphor::smbios;
+using namespace phosphor::smbios::test;
+
+static constexpr const char* mockServiceName =
+    "xyz.openbmc_project.Test.Inventory";
+static constexpr const char* mdrServiceName =
+    "xyz.openbmc_project.Smbios.MDR_V2";
+static constexpr const char* biosActivePath =
+    "/xyz/openbmc_project/software/bios_active";
+
+static const std::vector<std::string> hosts = {"system0", "system1"};
+
+static std::string inventoryPath(const std::string& host)
+{
+    return "/xyz/openbmc_project/inventory/" + host;
+}
+
+static std::vector<uint8_t> generateTable()
+{
+    TableBuilder builder;
+
+    std::vector<uint8_t> bios(0x18, 0);
+    bios[4] = 1; // vendor
+    bios[5] = 2; // version
+    builder.add(biosType, bios, {"Test", "1.0.0"});
+
+    std::vector<uint8_t> system(0x1b, 0);
+    builder.add(systemType, system, {});
+
+    std::vector<uint8_t> cpu(0x30, 0);
+    cpu[4] = 1;    // socket designation
+    cpu[5] = 3;    // central processor
+    cpu[7] = 2;    // manufacturer
+    cpu[0x10] = 3; // version
+    cpu[0x18] = 0x41;
+    builder.add(processorsType, cpu, {"CPU0", "Intel", "Xeon"});
+
+    std::vector<uint8_t> array(0x17, 0);
+    uint16_t arrayHandle = builder.add(physicalMemoryArrayType, array, {});
+
+    std::vector<uint8_t> dimm(0x28, 0);
+    std::memcpy(&dimm[4], &arrayHandle, sizeof(arrayHandle));
+    dimm[0x0d] = 0x40; // 16 GiB
+    dimm[0x10] = 1;    // device locator
+    dimm[0x12] = 0x22; // DDR5
+    builder.add(memoryDeviceType, dimm, {"DIMM_0"});
+
+    std::vector<uint8_t> slot(0x1c, 0);
+    slot[4] = 1;    // designation
+    slot[5] = 0xa5; // PCI Express
+    builder.add(systemSlots, slot, {"SLOT0"});
+
+    std::vector<uint8_t> firmware(0x18, 0);
+    firmware[4] = 1; // component name
+    firmware[5] = 2; // version
+    firmware[7] = 3; // id
+    builder.add(firmwareInventoryInformationType, firmware,
+                {"Component", "1.0", "fw0"});
+
+    return builder.finish();
+}
+
+using SubTree =
+    std::map<std::string, std::map<std::string, std::vector<std::string>>>;
+
+// Stands in for the ObjectMapper and the inventory anchor of every host
+static int runMockServices()
+{
+    boost::asio::io_context io;
+    auto connection = std::make_shared<sdbusplus::asio::connection>(io);
+    sdbusplus::asio::object_server server(connection);
+
+    auto mapper = server.add_interface(mapperPath, mapperInterface);
+    mapper->register_method("GetSubTree",
+                            [](const std::string& /* root */, int32_t,
+                               const std::vector<std::string>& interfaces) {
+        SubTree subtree;
+        for (const auto& interface : interfaces)
+        {
+            if (interface != systemInterface)
+            {
+                continue;
+            }
+            for (const auto& host : hosts)
+            {
+                subtree[inventoryPath(host)][mockServiceName] = {
+                    systemInterface};
+            }
+        }
+        return subtree;
+    });
+    mapper->register_method("GetSubTreePaths",
+                            [](const std::string&, int32_t,
+                               const std::vector<std::string>&) {
+        return std::vector<std::string>{};
+    });
+    mapper->register_method("GetObject",
+                            [](const std::string& path,
+                               const std::vector<std::string>&) {
+        std::map<std::string, std::vector<std::string>> object;
+        if (path == biosActivePath)
+        {
+            object[mockServiceName] = {versionInterface};
+        }
+        return object;
+    });
+    mapper->initialize();
+
+    std::vector<std::shared_ptr<sdbusplus::asio::dbus_interface>> anchors;
+    for (const auto& host : hosts)
+    {
+        anchors.push_back(
+            server.add_interface(inventoryPath(host), systemInterface));
+        anchors.back()->initialize();
+    }
+
+    auto biosActive = server.add_interface(biosActivePath, versionInterface);
+    biosActive->register_property(
+        "Version", std::string(),
+        sdbusplus::asio::PropertyPermission::readWrite);
+    biosActive->initialize();
+
+    connection->request_name(mockServiceName);
+    connection->request_name(mapperBusName);
+
+    io.run();
+    return 0;
+}
+
+// Serves both hosts from one process, as smbiosmdrv2app does
+static int runInstances(const std::filesystem::path& dir)
+{
+    std::vector<uint8_t> table = generateTable();
+
+    auto io = std::make_shared<boost::asio::io_context>();
+    auto connection = std::make_shared<sdbusplus::asio::connection>(*io);
+    auto objServer =
+        std::make_shared<sdbusplus::asio::object_server>(connection);
+    sdbusplus::server::manager_t objManager(*connection,
+                                            "/xyz/openbmc_project/inventory");
+
+    std::vector<std::shared_ptr<MDRV2>> instances;
+    for (const auto& host : hosts)
+    {
+        std::filesystem::path tablePath = dir / ("smbios2_" + host);
+        if (!writeMdrFile(tablePath, table))
+        {
+            std::fprintf(stderr, "Failed to write %s\n", tablePath.c_str());
+            return 1;
+        }
+        instances.push_back(std::make_shared<MDRV2>(
+            io, connection, objServer, tablePath.string(),
+            std::string(defaultObjectPath) + "_" + host, inventoryPath(host)));
+    }
+    connection->request_name(mdrServiceName);
+
+    io->run();
+    return 0;
+}
+
+// Every object a host should have, with one of its interfaces
+static std::vector<std::pair<std::string, std::string>>
+    expectedObjects(const std::string& host)
+{
+    std::string inventory = inventoryPath(host);
+    [[maybe_unused]] size_t rootLength = std::strlen(defaultInventoryPath);
+
+    std::vector<std::pair<std::string, std::string>> objects = {
+        {inventory + systemSuffix, "xyz.openbmc_project.Common.UUID"},
+        // The anchor is the motherboard of a customized instance
+        {inventory + "/pcieslot0",
+         "xyz.openbmc_project.Inventory.Item.PCIeSlot"},
+        {std::string(firmwarePath) + "/" + host + "_fw0",
+         "xyz.openbmc_project.Inventory.Item"},
+    };
+#ifdef CPU_DBUS
+    objects.emplace_back(inventory + std::string(cpuPath).substr(rootLength) +
+                             "0",
+                         "xyz.openbmc_project.Inventory.Item.Cpu");
+#endif
+#ifdef DIMM_DBUS
+    objects.emplace_back(
+        inventory + std::string(defaultMotherboardPath).substr(rootLength) +
+            "/Memory_0",
+        "xyz.openbmc_project.Inventory.Item.Dimm");
+#endif
+    return objects;
+}
+
+static bool hasInterface(sdbusplus::bus_t& bus, const std::string& path,
+                         const std::string& interface)
+{
+    try
+    {
+        auto method = bus.new_method_call(mdrServiceName, path.c_str(),
+                                          "org.freedesktop.DBus.Properties",
+                                          "GetAll");
+        method.append(interface);
+        bus.call(method);
+        return true;
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        return false;
+    }
+}
+
+// Wait up to 30 seconds for every object of both hosts
+static int checkInventories(pid_t instancesPid)
+{
+    boost::asio::io_context io;
+    sdbusplus::asio::connection connection(io);
+
+    std::vector<std::pair<std::string, std::string>> missing;
+    for (const auto& host : hosts)
+    {
+        auto objects = expectedObjects(host);
+        missing.insert(missing.end(), objects.begin(), objects.end());
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!missing.empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        int status = 0;
+        if (waitpid(instancesPid, &status, WNOHANG) == instancesPid)
+        {
+            std::fprintf(stderr, "The MDRV2 instances exited\n");
+            return 1;
+        }
+
+        std::erase_if(missing, [&connection](const auto& object) {
+            return hasInterface(connection, object.first, object.second);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    for (const auto& [path, interface] : missing)
+    {
+        std::fprintf(stderr, "Missing %s on %s\n", interface.c_str(),
+                     path.c_str());
+    }
+    return missing.empty() ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "Usage: %s <dbus-daemon>\n", argv[0]);
+        return 1;
+    }
+
+    char dirTemplate[] = "/tmp/mdrv2-instances-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr)
+    {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::filesystem::path dir(dirTemplate);
+
+    pid_t busPid = -1;
+    if (startBus(argv[1], dir, busPid).empty())
+    {
+        std::fprintf(stderr, "Failed to start %s\n", argv[1]);
+        return 1;
+    }
+
+    pid_t mockPid = fork();
+    if (mockPid == 0)
+    {
+        _exit(runMockServices());
+    }
+
+    int ret = 1;
+    pid_t instancesPid = -1;
+    if (waitForName(mapperBusName))
+    {
+        instancesPid = fork();
+        if (instancesPid == 0)
+        {
+            _exit(runInstances(dir));
+        }
+        ret = checkInventories(instancesPid);
+    }
+    else
+    {
+        std::fprintf(stderr, "The mock services did not start\n");
+    }
+
+    for (pid_t pid : {instancesPid, mockPid, busPid})
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+    std::filesystem::remove_all(dir);
+    return ret;
+}
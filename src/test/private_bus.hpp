@@ -0,0 +1,117 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+
+namespace phosphor
+{
+namespace smbios
+{
+namespace test
+{
+
+/**
+ * @brief Start a dbus-daemon listening in a directory and make it the system
+ * bus of this process and its children, which the daemon code connects to.
+ * @return the address of the new bus, empty on failure
+ */
+inline std::string startBus(const char* daemon, const std::filesystem::path& dir,
+                            pid_t& pid)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return {};
+    }
+
+    std::string address = "unix:path=" + (dir / "bus").string();
+    pid = fork();
+    if (pid == 0)
+    {
+        close(fds[0]);
+        std::string printAddress = "--print-address=" +
+                                   std::to_string(fds[1]);
+        std::string addressArg = "--address=" + address;
+        execl(daemon, daemon, "--session", "--nofork", addressArg.c_str(),
+              printAddress.c_str(), nullptr);
+        _exit(127);
+    }
+    close(fds[1]);
+
+    // The address is printed once the daemon accepts connections
+    char line[256] = {};
+    ssize_t length = read(fds[0], line, sizeof(line) - 1);
+    close(fds[0]);
+    if (pid < 0 || length <= 0)
+    {
+        return {};
+    }
+
+    setenv("DBUS_SYSTEM_BUS_ADDRESS", address.c_str(), 1);
+    setenv("DBUS_STARTER_BUS_TYPE", "system", 1);
+    return address;
+}
+
+/** @brief Wait up to 10 seconds for a service to own its name */
+inline bool waitForName(const char* name)
+{
+    boost::asio::io_context io;
+    sdbusplus::asio::connection connection(io);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        auto method = connection.new_method_call(
+            "org.freedesktop.DBus", "/org/freedesktop/DBus",
+            "org.freedesktop.DBus", "NameHasOwner");
+        method.append(name);
+        bool hasOwner = false;
+        auto reply = connection.call(method);
+        reply.read(hasOwner);
+        if (hasOwner)
+        {
+            return true;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return false;
+}
+
+/** @return the exit code of a child, 1 if it did not exit normally */
+inline int waitChild(pid_t pid)
+{
+    int status = 0;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status))
+    {
+        return 1;
+    }
+    return WEXITSTATUS(status);
+}
+
+} // namespace test
+} // namespace smbios
+} // namespace phosphor
@@ -0,0 +1,132 @@
+#include "smbios_history.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+class TableHistoryTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/smbios_history_XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        directory = tmpl;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    static MDRSMBIOSHeader header(uint32_t timestamp,
+                                  const std::vector<uint8_t>& data)
+    {
+        return MDRSMBIOSHeader{mdr2Version, mdrTypeII, timestamp,
+                               static_cast<uint32_t>(data.size())};
+    }
+
+    size_t fileCount() const
+    {
+        size_t count = 0;
+        for ([[maybe_unused]] const auto& file :
+             std::filesystem::directory_iterator(directory))
+        {
+            count++;
+        }
+        return count;
+    }
+
+    std::string directory;
+    std::vector<uint8_t> tableA = {1, 2, 3};
+    std::vector<uint8_t> tableB = {4, 5, 6};
+    std::vector<uint8_t> tableC = {7, 8, 9};
+};
+
+TEST_F(TableHistoryTest, RecordsGenerationsInOrder)
+{
+    TableHistory history(directory, 4);
+    ASSERT_TRUE(history.record(header(100, tableA), tableA));
+    ASSERT_TRUE(history.record(header(200, tableB), tableB));
+
+    const auto& generations = history.generations();
+    ASSERT_EQ(generations.size(), 2u);
+    EXPECT_EQ(generations[0].sequence, 1u);
+    EXPECT_EQ(generations[0].timestamp, 100u);
+    EXPECT_EQ(generations[0].hash, tableHash(tableA));
+    EXPECT_EQ(generations[1].sequence, 2u);
+
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(history.load(1, data));
+    EXPECT_EQ(data, tableA);
+    EXPECT_FALSE(history.load(3, data));
+}
+
+TEST_F(TableHistoryTest, SameNewestTableIsNotStoredAgain)
+{
+    TableHistory history(directory, 4);
+    ASSERT_TRUE(history.record(header(100, tableA), tableA));
+    ASSERT_TRUE(history.record(header(200, tableA), tableA));
+
+    ASSERT_EQ(history.generations().size(), 1u);
+    EXPECT_EQ(history.generations()[0].timestamp, 100u);
+    EXPECT_EQ(fileCount(), 1u);
+}
+
+TEST_F(TableHistoryTest, EvictsOldestBeyondDepth)
+{
+    TableHistory history(directory, 2);
+    ASSERT_TRUE(history.record(header(100, tableA), tableA));
+    ASSERT_TRUE(history.record(header(200, tableB), tableB));
+    ASSERT_TRUE(history.record(header(300, tableC), tableC));
+
+    const auto& generations = history.generations();
+    ASSERT_EQ(generations.size(), 2u);
+    EXPECT_EQ(generations[0].hash, tableHash(tableB));
+    EXPECT_EQ(generations[1].hash, tableHash(tableC));
+    EXPECT_EQ(fileCount(), 2u);
+
+    std::vector<uint8_t> data;
+    EXPECT_FALSE(history.load(1, data));
+}
+
+TEST_F(TableHistoryTest, OlderTableMovesToFront)
+{
+    {
+        TableHistory history(directory, 4);
+        ASSERT_TRUE(history.record(header(100, tableA), tableA));
+        ASSERT_TRUE(history.record(header(200, tableB), tableB));
+        ASSERT_TRUE(history.record(header(300, tableA), tableA));
+
+        const auto& generations = history.generations();
+        ASSERT_EQ(generations.size(), 2u);
+        EXPECT_EQ(generations[1].sequence, 3u);
+        EXPECT_EQ(generations[1].timestamp, 300u);
+        EXPECT_EQ(fileCount(), 2u);
+    }
+
+    // The moved generation keeps its new time after a restart
+    TableHistory history(directory, 4);
+    const auto& generations = history.generations();
+    ASSERT_EQ(generations.size(), 2u);
+    EXPECT_EQ(generations[0].hash, tableHash(tableB));
+    EXPECT_EQ(generations[1].sequence, 3u);
+    EXPECT_EQ(generations[1].timestamp, 300u);
+    EXPECT_EQ(generations[1].hash, tableHash(tableA));
+
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(history.load(3, data));
+    EXPECT_EQ(data, tableA);
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -0,0 +1,127 @@
+#include "smbios_index.hpp"
+
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+namespace phosphor
+{
+namespace smbios
+{
+
+// Append a structure with a formatted area of `length` bytes, filled with
+// `fill` after the header, and an empty string-set.
+static void addStructure(std::vector<uint8_t>& table, uint8_t type,
+                         uint16_t handle, uint8_t length = 8,
+                         uint8_t fill = 0)
+{
+    table.push_back(type);
+    table.push_back(length);
+    table.push_back(handle & 0xff);
+    table.push_back(handle >> 8);
+    table.insert(table.end(), length - 4, fill);
+    table.insert(table.end(), {0, 0});
+}
+
+static std::vector<uint8_t> makeTable(
+    std::initializer_list<std::pair<uint8_t, uint16_t>> structures)
+{
+    std::vector<uint8_t> table;
+    for (const auto& [type, handle] : structures)
+    {
+        addStructure(table, type, handle);
+    }
+    addStructure(table, 127, 0xfeff, 4);
+    return table;
+}
+
+TEST(StructureIndexTest, IndexesByHandleAndType)
+{
+    std::vector<uint8_t> table = makeTable({{4, 0x10}, {17, 0x20}, {17, 0x21}});
+    StructureIndex index(table);
+
+    ASSERT_EQ(index.entries().size(), 4u);
+    const StructureEntry* dimm = index.find(0x21);
+    ASSERT_NE(dimm, nullptr);
+    EXPECT_EQ(dimm->type, 17);
+    EXPECT_EQ(dimm->offset, 20u);
+    EXPECT_EQ(dimm->size, 10u);
+    EXPECT_EQ(index.find(0x30), nullptr);
+
+    auto dimms = index.ofType(17);
+    ASSERT_EQ(dimms.size(), 2u);
+    EXPECT_EQ(dimms[0]->handle, 0x20);
+    EXPECT_EQ(dimms[1]->handle, 0x21);
+}
+
+TEST(StructureIndexTest, StopsAtEndOfTable)
+{
+    std::vector<uint8_t> table = makeTable({{4, 0x10}});
+    addStructure(table, 17, 0x20);
+    StructureIndex index(table);
+
+    ASSERT_EQ(index.entries().size(), 2u);
+    EXPECT_EQ(index.find(0x20), nullptr);
+}
+
+TEST(StructureIndexTest, DropsTruncatedStructure)
+{
+    std::vector<uint8_t> table;
+    addStructure(table, 4, 0x10);
+    addStructure(table, 17, 0x20);
+    // Cut the string-set terminator of the second structure
+    table.pop_back();
+    StructureIndex index(table);
+
+    ASSERT_EQ(index.entries().size(), 1u);
+    EXPECT_EQ(index.entries()[0].handle, 0x10);
+}
+
+TEST(DiffTablesTest, ReportsChangesByHandle)
+{
+    std::vector<uint8_t> oldTable;
+    addStructure(oldTable, 4, 0x10);
+    addStructure(oldTable, 17, 0x20);
+    addStructure(oldTable, 17, 0x21);
+    addStructure(oldTable, 2, 0x30);
+    addStructure(oldTable, 127, 0xfeff, 4);
+
+    std::vector<uint8_t> newTable;
+    addStructure(newTable, 4, 0x10);
+    addStructure(newTable, 17, 0x20, 8, 0xaa);
+    // Handle reused for another type
+    addStructure(newTable, 9, 0x30);
+    addStructure(newTable, 17, 0x22);
+    addStructure(newTable, 127, 0xfeff, 4);
+
+    StructureIndex oldIndex(oldTable);
+    StructureIndex newIndex(newTable);
+    auto diff = diffTables(oldTable, oldIndex, newTable, newIndex);
+
+    ASSERT_EQ(diff.size(), 5u);
+    EXPECT_EQ(diff[0].handle, 0x20);
+    EXPECT_EQ(diff[0].change, StructureChange::modified);
+    EXPECT_EQ(diff[1].handle, 0x21);
+    EXPECT_EQ(diff[1].change, StructureChange::removed);
+    EXPECT_EQ(diff[2].handle, 0x22);
+    EXPECT_EQ(diff[2].change, StructureChange::added);
+    EXPECT_EQ(diff[3].handle, 0x30);
+    EXPECT_EQ(diff[3].change, StructureChange::removed);
+    EXPECT_EQ(diff[3].type, 2);
+    EXPECT_EQ(diff[4].handle, 0x30);
+    EXPECT_EQ(diff[4].change, StructureChange::added);
+    EXPECT_EQ(diff[4].type, 9);
+}
+
+TEST(DiffTablesTest, SameTableHasNoChanges)
+{
+    std::vector<uint8_t> table = makeTable({{4, 0x10}, {17, 0x20}});
+    StructureIndex index(table);
+
+    EXPECT_TRUE(diffTables(table, index, table, index).empty());
+}
+
+} // namespace smbios
+} // namespace phosphor
@@ -0,0 +1,360 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * Runs SST discovery of cpuinfoapp against simulated CPUs, and checks the
+ * published levels and that a host power cycle keeps the published objects.
+ *
+ * Everything runs on a private dbus-daemon, given as the only argument, with
+ * a mock service standing in for the host state.
+ */
+
+#include "cpuinfo.hpp"
+#include "cpuinfo_utils.hpp"
+#include "peci_metrics.hpp"
+#include "peci_sim.hpp"
+#include "speed_select.hpp"
+
+#include "private_bus.hpp"
+
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <boost/asio/io_context.hpp>
+#include <sdbusplus/asio/connection.hpp>
+#include <sdbusplus/asio/object_server.hpp>
+#include <sdbusplus/bus/match.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+
+using namespace cpu_info;
+using namespace phosphor::smbios::test;
+
+static constexpr const char* hostService = "xyz.openbmc_project.State.Host";
+static constexpr const char* hostPath = "/xyz/openbmc_project/state/host0";
+static constexpr const char* hostInterface = "xyz.openbmc_project.State.Host";
+static constexpr const char* hostOff =
+    "xyz.openbmc_project.State.Host.HostState.Off";
+static constexpr const char* hostRunning =
+    "xyz.openbmc_project.State.Host.HostState.Running";
+static constexpr const char* operatingConfigInterface =
+    "xyz.openbmc_project.Inventory.Item.Cpu.OperatingConfig";
+static constexpr const char* currentConfigInterface =
+    "xyz.openbmc_project.Control.Processor.CurrentOperatingConfig";
+
+static constexpr unsigned int sockets = 2;
+
+// Stands in for the host state of x86-power-control
+static int runHostState()
+{
+    boost::asio::io_context io;
+    auto connection = std::make_shared<sdbusplus::asio::connection>(io);
+    sdbusplus::asio::object_server server(connection);
+
+    auto host = server.add_interface(hostPath, hostInterface);
+    host->register_property("CurrentHostState", std::string(hostOff),
+                            sdbusplus::asio::PropertyPermission::readWrite);
+    host->initialize();
+    connection->request_name(hostService);
+
+    io.run();
+    return 0;
+}
+
+// The SST part of cpuinfoapp, talking to simulated CPUs
+static int runCpuInfo()
+{
+    auto config = peci::parseSimSpec("sockets=2");
+    if (!config)
+    {
+        return 1;
+    }
+    peci::setTransport(
+        std::make_unique<peci::SimulatedTransport>(std::move(*config)));
+
+    boost::asio::io_context& io = dbus::getIOContext();
+    std::shared_ptr<sdbusplus::asio::connection> conn = dbus::getConnection();
+    conn->request_name(cpuInfoObject);
+    sdbusplus::asio::object_server server(conn);
+    sdbusplus::server::manager_t objManager(*conn,
+                                            "/xyz/openbmc_project/inventory");
+
+    hostStateSetup(conn);
+    peci::registerMetrics(server);
+    sst::init(server);
+
+    io.run();
+    return 0;
+}
+
+template <typename T>
+static std::optional<T> getProperty(sdbusplus::bus_t& bus,
+                                    const std::string& path,
+                                    const char* interface, const char* name)
+{
+    try
+    {
+        auto method = bus.new_method_call(cpuInfoObject, path.c_str(),
+                                          "org.freedesktop.DBus.Properties",
+                                          "Get");
+        method.append(interface, name);
+        auto reply = bus.call(method);
+        std::variant<T> value;
+        reply.read(value);
+        return std::get<T>(value);
+    }
+    catch (const sdbusplus::exception_t&)
+    {
+        return std::nullopt;
+    }
+}
+
+static void setHostState(sdbusplus::bus_t& bus, const char* state)
+{
+    auto method = bus.new_method_call(hostService, hostPath,
+                                      "org.freedesktop.DBus.Properties", "Set");
+    method.append(hostInterface, "CurrentHostState",
+                  std::variant<std::string>(state));
+    bus.call(method);
+}
+
+static uint64_t discoveryPasses(sdbusplus::bus_t& bus)
+{
+    using TimeRow = std::tuple<std::string, uint64_t, uint64_t, uint64_t,
+                               std::vector<uint64_t>>;
+    try
+    {
+        auto method = bus.new_method_call(cpuInfoObject, cpuInfoPath,
+                                          peci::metricsInterface,
+                                          "GetDiscoveryTimes");
+        auto reply = bus.call(method);
+        std::vector<TimeRow> rows;
+        reply.read(rows);
+        for (const auto& row : rows)
+        {
+            if (std::get<0>(row) == "Pass")
+            {
+                return std::get<1>(row);
+            }
+        }
+    }
+    catch (const sdbusplus::exception_t&)
+    {}
+    return 0;
+}
+
+/** Run the event loop until a condition holds, up to 30 seconds */
+static bool waitUntil(boost::asio::io_context& io,
+                      const std::function<bool()>& condition)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+    while (!condition())
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+        {
+            return false;
+        }
+        io.run_for(std::chrono::milliseconds(50));
+    }
+    return true;
+}
+
+static std::string cpuObject(unsigned int index)
+{
+    return cpuPath + std::to_string(index);
+}
+
+// The levels of peci::makeSimSocket(), levels 1 and 2 are not supported
+static bool checkLevels(sdbusplus::bus_t& bus)
+{
+    bool ok = true;
+    auto expect = [&ok](bool condition, const std::string& what) {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Unexpected %s\n", what.c_str());
+            ok = false;
+        }
+    };
+
+    for (unsigned int index = 0; index < sockets; ++index)
+    {
+        std::string cpu = cpuObject(index);
+        expect(getProperty<uint32_t>(bus, cpu + "/config0",
+                                     operatingConfigInterface,
+                                     "BaseSpeed") == 2000u,
+               cpu + " level 0 base speed");
+        expect(getProperty<size_t>(bus, cpu + "/config3",
+                                   operatingConfigInterface,
+                                   "AvailableCoreCount") == 28u,
+               cpu + " level 3 core count");
+        expect(getProperty<uint32_t>(bus, cpu + "/config4",
+                                     operatingConfigInterface,
+                                     "PowerLimit") == 270u,
+               cpu + " level 4 power limit");
+        for (const char* missing : {"/config1", "/config2"})
+        {
+            expect(!getProperty<uint32_t>(bus, cpu + missing,
+                                          operatingConfigInterface,
+                                          "BaseSpeed"),
+                   cpu + missing);
+        }
+        auto applied = getProperty<sdbusplus::message::object_path>(
+            bus, cpu, currentConfigInterface, "AppliedConfig");
+        expect(applied && applied->str == cpu + "/config0",
+               cpu + " applied config");
+    }
+    return ok;
+}
+
+static int checkPowerCycle()
+{
+    boost::asio::io_context io;
+    sdbusplus::asio::connection connection(io);
+
+    unsigned int added = 0;
+    unsigned int removed = 0;
+    auto counter = [](unsigned int& count) {
+        return [&count](sdbusplus::message_t& message) {
+            sdbusplus::message::object_path path;
+            message.read(path);
+            if (path.str.starts_with(cpuPath))
+            {
+                ++count;
+            }
+        };
+    };
+    sdbusplus::bus::match_t addedMatch(
+        connection,
+        sdbusplus::bus::match::rules::sender(cpuInfoObject) +
+            sdbusplus::bus::match::rules::interfacesAdded(),
+        counter(added));
+    sdbusplus::bus::match_t removedMatch(
+        connection,
+        sdbusplus::bus::match::rules::sender(cpuInfoObject) +
+            sdbusplus::bus::match::rules::interfacesRemoved(),
+        counter(removed));
+
+    setHostState(connection, hostRunning);
+    if (!waitUntil(io, [&connection]() {
+        return discoveryPasses(connection) == 1;
+    }))
+    {
+        std::fprintf(stderr, "The first discovery did not finish\n");
+        return 1;
+    }
+    // Every CPU and its three levels
+    if (!waitUntil(io, [&added]() { return added == sockets * 4; }))
+    {
+        std::fprintf(stderr, "%u objects were added instead of %u\n", added,
+                     sockets * 4);
+        return 1;
+    }
+    if (!checkLevels(connection))
+    {
+        return 1;
+    }
+
+    setHostState(connection, hostOff);
+    io.run_for(std::chrono::milliseconds(200));
+    setHostState(connection, hostRunning);
+    if (!waitUntil(io, [&connection]() {
+        return discoveryPasses(connection) == 2;
+    }))
+    {
+        std::fprintf(stderr, "The discovery after power on did not finish\n");
+        return 1;
+    }
+    io.run_for(std::chrono::milliseconds(200));
+
+    if (added != sockets * 4 || removed != 0)
+    {
+        std::fprintf(stderr,
+                     "The power cycle added %u and removed %u objects\n",
+                     added - sockets * 4, removed);
+        return 1;
+    }
+    return checkLevels(connection) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::fprintf(stderr, "Usage: %s <dbus-daemon>\n", argv[0]);
+        return 1;
+    }
+
+    char dirTemplate[] = "/tmp/sst-power-cycle-XXXXXX";
+    if (mkdtemp(dirTemplate) == nullptr)
+    {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    std::filesystem::path dir(dirTemplate);
+
+    pid_t busPid = -1;
+    if (startBus(argv[1], dir, busPid).empty())
+    {
+        std::fprintf(stderr, "Failed to start %s\n", argv[1]);
+        return 1;
+    }
+
+    pid_t hostPid = fork();
+    if (hostPid == 0)
+    {
+        _exit(runHostState());
+    }
+
+    int ret = 1;
+    pid_t cpuInfoPid = -1;
+    if (waitForName(hostService))
+    {
+        cpuInfoPid = fork();
+        if (cpuInfoPid == 0)
+        {
+            _exit(runCpuInfo());
+        }
+        if (waitForName(cpuInfoObject))
+        {
+            ret = checkPowerCycle();
+        }
+    }
+    if (ret != 0)
+    {
+        std::fprintf(stderr, "SST power cycle test failed\n");
+    }
+
+    for (pid_t pid : {cpuInfoPid, hostPid, busPid})
+    {
+        if (pid > 0)
+        {
+            kill(pid, SIGTERM);
+            waitpid(pid, nullptr, 0);
+        }
+    }
+    std::filesystem::remove_all(dir);
+    return ret;
+}
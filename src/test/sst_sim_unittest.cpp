@@ -0,0 +1,197 @@
+#include "peci_sim.hpp"
+#include "speed_select.hpp"
+#include "sst_cache.hpp"
+#include "sst_discovery.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+namespace cpu_info
+{
+namespace sst
+{
+
+/** Times Wake-on-PECI was set and cleared */
+using Transitions = std::pair<uint64_t, uint64_t>;
+
+class SSTSimTest : public ::testing::Test
+{
+  protected:
+    void SetUp() override
+    {
+        char tmpl[] = "/tmp/sst_sim_XXXXXX";
+        ASSERT_NE(mkdtemp(tmpl), nullptr);
+        directory = tmpl;
+    }
+
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+
+    /** Route PECI to simulated CPUs, see parseSimSpec() */
+    void simulate(const char* spec)
+    {
+        auto config = peci::parseSimSpec(spec);
+        ASSERT_TRUE(config);
+        auto transport = std::make_unique<peci::SimulatedTransport>(*config);
+        sim = transport.get();
+        peci::setTransport(std::move(transport));
+    }
+
+    std::unique_ptr<SSTInterface> backend(WakePolicy policy)
+    {
+        CPUModel model{};
+        uint8_t stepping = 0;
+        uint8_t cc = 0;
+        EXPECT_EQ(peci::getTransport().getCPUID(address, &model, &stepping,
+                                                &cc),
+                  PECI_CC_SUCCESS);
+        return getInstance(address, model, policy);
+    }
+
+    /** A discovery pass over the CPU by the daemon, with an empty cache */
+    std::optional<DiscoveredCPU> discover(bool memoize = true)
+    {
+        ConfigCache cache(directory + "/sst-config-" +
+                          std::to_string(++passes) + ".json");
+        std::optional<DiscoveredCPU> found;
+        EXPECT_TRUE(discoverSocket(address, std::nullopt, cache, found,
+                                   memoize));
+        return found;
+    }
+
+    static constexpr uint8_t address = MIN_CLIENT_ADDR;
+    peci::SimulatedTransport* sim = nullptr;
+    std::string directory;
+    unsigned int passes = 0;
+};
+
+TEST_F(SSTSimTest, DiscoversSimulatedLevels)
+{
+    simulate("sockets=1");
+
+    std::optional<DiscoveredCPU> found = discover();
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->index, 0u);
+    EXPECT_EQ(found->currentLevel, 0u);
+    EXPECT_FALSE(found->bfEnabled);
+    EXPECT_FALSE(found->unchanged);
+    ASSERT_TRUE(found->identity);
+    EXPECT_NE(found->identity->ppin, 0u);
+    ASSERT_EQ(found->config.levels.size(), 3u);
+
+    const LevelConfig& base = found->config.levels[0];
+    EXPECT_EQ(base.level, 0u);
+    EXPECT_EQ(base.powerLimit, 350u);
+    EXPECT_EQ(base.coreCount, 32u);
+    EXPECT_EQ(base.baseSpeed, 2000u);
+    EXPECT_EQ(base.maxSpeed, 3800u);
+    EXPECT_EQ(base.maxJunctionTemperature, 100u);
+    ASSERT_EQ(base.baseSpeedPrioritySettings.size(), 2u);
+    EXPECT_EQ(std::get<0>(base.baseSpeedPrioritySettings[0]), 2700u);
+    EXPECT_EQ(std::get<1>(base.baseSpeedPrioritySettings[0]).size(), 8u);
+    EXPECT_EQ(std::get<0>(base.baseSpeedPrioritySettings[1]), 1800u);
+    EXPECT_EQ(std::get<1>(base.baseSpeedPrioritySettings[1]).size(), 24u);
+    EXPECT_FALSE(base.turboProfile.empty());
+
+    const LevelConfig& level3 = found->config.levels[1];
+    EXPECT_EQ(level3.level, 3u);
+    EXPECT_EQ(level3.coreCount, 28u);
+    EXPECT_EQ(level3.baseSpeed, 2300u);
+    EXPECT_TRUE(level3.baseSpeedPrioritySettings.empty());
+
+    const LevelConfig& level4 = found->config.levels[2];
+    EXPECT_EQ(level4.level, 4u);
+    EXPECT_EQ(level4.powerLimit, 270u);
+    EXPECT_EQ(level4.maxSpeed, 3600u);
+}
+
+TEST_F(SSTSimTest, MemoizedDiscoverySendsEachReadOnce)
+{
+    simulate("sockets=1");
+    uint64_t start = sim->transactions();
+    std::optional<DiscoveredCPU> expected = discover(false);
+    uint64_t plainCommands = sim->transactions() - start;
+    ASSERT_TRUE(expected);
+    EXPECT_EQ(expected->sst->transactionsSaved(), 0u);
+
+    start = sim->transactions();
+    std::optional<DiscoveredCPU> found = discover();
+    uint64_t memoizedCommands = sim->transactions() - start;
+    ASSERT_TRUE(found);
+
+    EXPECT_EQ(found->config, expected->config);
+    EXPECT_EQ(plainCommands, 240u);
+    EXPECT_EQ(memoizedCommands, 153u);
+    EXPECT_EQ(found->sst->transactionsSaved(),
+              plainCommands - memoizedCommands);
+
+    // Reads after the pass go to the CPU again
+    sim->update(address, [](peci::SimSocket& cpu) { cpu.currentLevel = 3; });
+    EXPECT_EQ(found->sst->currentLevel(), 3u);
+}
+
+TEST_F(SSTSimTest, DiscoveryWakesOnce)
+{
+    simulate("sockets=1,sleeping=1");
+
+    std::optional<DiscoveredCPU> found = discover();
+    ASSERT_TRUE(found);
+    EXPECT_EQ(found->config.levels.size(), 3u);
+    EXPECT_FALSE(sim->wakeOnPECI(address));
+    EXPECT_EQ(sim->wakeTransitions(address), Transitions(1, 1));
+}
+
+TEST_F(SSTSimTest, WakeHoldSetsAndClearsOnce)
+{
+    simulate("sockets=1,sleeping=1");
+    auto sst = backend(dontWake);
+    ASSERT_NE(sst, nullptr);
+
+    // A sleeping CPU only answers with Wake-on-PECI set
+    EXPECT_THROW(sst->currentLevel(), PECIError);
+    EXPECT_EQ(sim->wakeTransitions(address), Transitions(0, 0));
+
+    sst->holdWake();
+    EXPECT_EQ(sst->currentLevel(), 0u);
+    EXPECT_TRUE(sim->wakeOnPECI(address));
+
+    // A batch within the first one shares its wake
+    sst->holdWake();
+    EXPECT_EQ(sst->tdp(0), 350u);
+    sst->releaseWake();
+    EXPECT_TRUE(sim->wakeOnPECI(address));
+    sst->releaseWake();
+
+    EXPECT_FALSE(sim->wakeOnPECI(address));
+    EXPECT_EQ(sim->wakeTransitions(address), Transitions(1, 1));
+    WakeStats stats = sst->wakeStats();
+    EXPECT_EQ(stats.transitions, 2u);
+    EXPECT_EQ(stats.avoided, 2u);
+}
+
+TEST_F(SSTSimTest, WakeAllowedClearsWhenPolicyChanges)
+{
+    simulate("sockets=1,sleeping=1");
+    auto sst = backend(wakeAllowed);
+    ASSERT_NE(sst, nullptr);
+
+    EXPECT_EQ(sst->currentLevel(), 0u);
+    EXPECT_TRUE(sim->wakeOnPECI(address));
+    sst->setCurrentLevel(3);
+    EXPECT_EQ(sst->currentLevel(), 3u);
+
+    sst->setWakePolicy(dontWake);
+    EXPECT_FALSE(sim->wakeOnPECI(address));
+    EXPECT_EQ(sim->wakeTransitions(address), Transitions(1, 1));
+}
+
+} // namespace sst
+} // namespace cpu_info
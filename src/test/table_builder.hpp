@@ -0,0 +1,103 @@
+/*
+ * SPDX-FileCopyrightText: Copyright (c) 2024 NVIDIA CORPORATION &
+ * AFFILIATES. All rights reserved. SPDX-License-Identifier: Apache-2.0
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "smbios_mdrv2.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace phosphor
+{
+namespace smbios
+{
+namespace test
+{
+
+/** @brief Generates SMBIOS 3.2 tables structure by structure */
+class TableBuilder
+{
+  public:
+    TableBuilder() : table(entryPointSize, 0)
+    {
+        std::memcpy(table.data(), "_SM3_", 5);
+        table[6] = 0x18; // entry point length
+        table[7] = 3;    // major version
+        table[8] = 2;    // minor version
+        uint64_t tableAddress = entryPointSize;
+        std::memcpy(&table[16], &tableAddress, sizeof(tableAddress));
+    }
+
+    /** @return handle of the new structure */
+    uint16_t add(uint8_t type, std::vector<uint8_t> formatted,
+                 const std::vector<std::string>& strings)
+    {
+        uint16_t handle = nextHandle++;
+        formatted[0] = type;
+        formatted[1] = static_cast<uint8_t>(formatted.size());
+        std::memcpy(&formatted[2], &handle, sizeof(handle));
+
+        table.insert(table.end(), formatted.begin(), formatted.end());
+        for (const auto& string : strings)
+        {
+            table.insert(table.end(), string.begin(), string.end());
+            table.push_back(0);
+        }
+        if (strings.empty())
+        {
+            table.push_back(0);
+        }
+        table.push_back(0);
+        return handle;
+    }
+
+    std::vector<uint8_t> finish()
+    {
+        add(127, std::vector<uint8_t>(4, 0), {});
+        return std::move(table);
+    }
+
+  private:
+    static constexpr size_t entryPointSize = 0x20;
+
+    std::vector<uint8_t> table;
+    uint16_t nextHandle = 0;
+};
+
+/** @brief Write a table as the MDR file the daemon loads */
+inline bool writeMdrFile(const std::filesystem::path& path,
+                         const std::vector<uint8_t>& table)
+{
+    MDRSMBIOSHeader header{};
+    header.dirVer = 1;
+    header.mdrType = mdrTypeII;
+    header.dataSize = static_cast<uint32_t>(table.size());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(table.data()), table.size());
+    return file.good();
+}
+
+} // namespace test
+} // namespace smbios
+} // namespace phosphor
@@ -27,25 +27,34 @@ namespace phosphor
 namespace smbios
 {
 
-void Tpm::tpmInfoUpdate(void)
+std::optional<TpmRecord> Tpm::decode(uint8_t* smbiosTableStorage)
 {
-    uint8_t* dataIn = storage;
-    dataIn = getSMBIOSTypePtr(dataIn, tpmDeviceType);
+    uint8_t* dataIn = getSMBIOSTypePtr(smbiosTableStorage, tpmDeviceType);
     if (dataIn == nullptr)
     {
-        return;
+        return std::nullopt;
     }
 
     auto tpmInfo = reinterpret_cast<struct TPMInfo*>(dataIn);
 
-    present(true);
-    purpose(softwareversionIntf::VersionPurpose::Other);
-    tpmVendor(tpmInfo);
-    tpmFirmwareVersion(tpmInfo);
-    tpmDescription(tpmInfo->description, tpmInfo->length, dataIn);
+    TpmRecord record;
+    record.manufacturer = tpmVendor(tpmInfo);
+    record.version = tpmFirmwareVersion(tpmInfo);
+    record.prettyName = positionToString(tpmInfo->description,
+                                         tpmInfo->length, dataIn);
+    return record;
 }
 
-void Tpm::tpmVendor(const struct TPMInfo* tpmInfo)
+void Tpm::tpmInfoUpdate(const TpmRecord& record)
+{
+    present(true, true);
+    purpose(softwareversionIntf::VersionPurpose::Other, true);
+    manufacturer(record.manufacturer, true);
+    version(record.version, true);
+    prettyName(record.prettyName, true);
+}
+
+std::string Tpm::tpmVendor(const struct TPMInfo* tpmInfo)
 {
     // Specified as four ASCII characters, as defined by TCG Vendor ID
     char vendorId[5];
@@ -63,10 +72,10 @@ void Tpm::tpmVendor(const struct TPMInfo* tpmInfo)
         }
     }
     vendorId[i] = '\0';
-    manufacturer(vendorId);
+    return vendorId;
 }
 
-void Tpm::tpmFirmwareVersion(const struct TPMInfo* tpmInfo)
+std::string Tpm::tpmFirmwareVersion(const struct TPMInfo* tpmInfo)
 {
     std::stringstream stream;
     if (tpmInfo->specMajor == 0x01)
@@ -81,14 +90,7 @@ void Tpm::tpmFirmwareVersion(const struct TPMInfo* tpmInfo)
             &tpmInfo->firmwareVersion1);
         stream << ver->revMajor << "." << ver->revMinor;
     }
-    version(stream.str());
-}
-
-void Tpm::tpmDescription(const uint8_t positionNum, const uint8_t structLen,
-                         uint8_t* dataIn)
-{
-    std::string result = positionToString(positionNum, structLen, dataIn);
-    prettyName(result);
+    return stream.str();
 }
 } // namespace smbios
 } // namespace phosphor